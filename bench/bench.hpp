@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <common/image.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+namespace bench {
+  constexpr int DEFAULT_ITERATIONS = 5;
+  constexpr double MILLIS_PER_SEC  = 1000.0;
+  constexpr double PIXELS_PER_MP   = 1e6;
+  constexpr int NAME_COLUMN        = 40;
+  constexpr int VALUE_COLUMN       = 10;
+  constexpr int PRECISION          = 2;
+
+  // Mejor tiempo (en milisegundos) de varias ejecuciones de `function`
+  template <typename Function>
+  double bestOf(int const iterations, Function && function) {
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+      auto const start = std::chrono::steady_clock::now();
+      function();
+      std::chrono::duration<double, std::milli> const elapsed =
+          std::chrono::steady_clock::now() - start;
+      if (i == 0 || elapsed.count() < best) { best = elapsed.count(); }
+    }
+    return best;
+  }
+
+  inline void report(std::string const & name, double const millis, double const megaPixels) {
+    std::cout << std::left << std::setw(NAME_COLUMN) << name << std::right << std::fixed
+              << std::setprecision(PRECISION) << std::setw(VALUE_COLUMN) << millis << " ms"
+              << std::setw(VALUE_COLUMN) << megaPixels / (millis / MILLIS_PER_SEC) << " MP/s\n";
+  }
+
+  // Memoria residente máxima del proceso hasta ahora, en MiB (ru_maxrss viene en KiB en Linux)
+  inline double peakResidentMebibytes() {
+    constexpr double KIBIBYTES_PER_MEBIBYTE = 1024.0;
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / KIBIBYTES_PER_MEBIBYTE;
+  }
+
+  inline double megaPixels(unsigned long const width, unsigned long const height) {
+    return static_cast<double>(width * height) / PIXELS_PER_MP;
+  }
+
+  // Genera un PPM sintético con ruido pseudoaleatorio reproducible
+  inline std::filesystem::path writeSyntheticPpm(std::string const & name, unsigned long width,
+                                                 unsigned long height,
+                                                 unsigned short maxColorValue) {
+    constexpr std::uint32_t SEED       = 2463534242U;
+    constexpr unsigned XORSHIFT_LEFT_1 = 13;
+    constexpr unsigned XORSHIFT_RIGHT  = 17;
+    constexpr unsigned XORSHIFT_LEFT_2 = 5;
+    constexpr unsigned char BYTE_SHIFT = 8;
+    constexpr unsigned BYTE_MASK       = 0xFFU;
+
+    auto const path = std::filesystem::temp_directory_path() / name;
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << width << " " << height << "\n" << maxColorValue << "\n";
+
+    bool const wide = maxColorValue > image::MAX_COLOR_VALUE_8BIT;
+    std::vector<char> row(width * 3 * (wide ? 2 : 1));
+    std::uint32_t state = SEED;
+    for (unsigned long yPos = 0; yPos < height; ++yPos) {
+      std::size_t offset = 0;
+      for (std::size_t sample = 0; sample < width * 3; ++sample) {
+        state ^= state << XORSHIFT_LEFT_1;
+        state ^= state >> XORSHIFT_RIGHT;
+        state ^= state << XORSHIFT_LEFT_2;
+        auto const value = static_cast<unsigned short>(state % (maxColorValue + 1U));
+        if (wide) { row[offset++] = static_cast<char>(value >> BYTE_SHIFT); }
+        row[offset++] = static_cast<char>(value & BYTE_MASK);
+      }
+      out.write(row.data(), static_cast<std::streamsize>(row.size()));
+    }
+    return path;
+  }
+}  // namespace bench
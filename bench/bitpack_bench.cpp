@@ -0,0 +1,101 @@
+#include <array>
+#include <bench/bench.hpp>
+#include <common/bitpack.hpp>
+#include <common/threadpool.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr std::size_t INDEX_COUNT                  = std::size_t{1} << 22;
+  constexpr std::array<std::size_t, 6> PALETTE_SIZES = {2, 16, 300, 5000, 70000, 1000000};
+  constexpr std::uint32_t SEED                       = 12345;
+  constexpr std::uint32_t LCG_MULTIPLIER             = 1664525U;
+  constexpr std::uint32_t LCG_INCREMENT              = 1013904223U;
+  constexpr unsigned BYTE_BITS                       = 8;
+  constexpr std::uint32_t BYTE_MASK                  = 0xFF;
+  constexpr std::size_t ONE_BYTE_MAX                 = std::size_t{1} << BYTE_BITS;
+  constexpr std::size_t TWO_BYTES_MAX                = std::size_t{1} << (2 * BYTE_BITS);
+  constexpr std::size_t FOUR_BYTES                   = 4;
+  constexpr double BYTES_PER_MEBIBYTE                = 1024.0 * 1024.0;
+
+  std::vector<std::uint32_t> randomIndices(std::size_t const paletteSize) {
+    std::uint32_t seed = SEED;
+    std::vector<std::uint32_t> indices(INDEX_COUNT);
+    for (std::uint32_t & index : indices) {
+      seed  = (seed * LCG_MULTIPLIER) + LCG_INCREMENT;
+      index = static_cast<std::uint32_t>(seed % paletteSize);
+    }
+    return indices;
+  }
+
+  // Mismo ancho de índice que el formato C6
+  std::size_t byteSize(std::size_t const paletteSize) {
+    if (paletteSize <= ONE_BYTE_MAX) { return 1; }
+    if (paletteSize <= TWO_BYTES_MAX) { return 2; }
+    return FOUR_BYTES;
+  }
+
+  void benchPalette(std::size_t const paletteSize) {
+    std::vector<std::uint32_t> const indices = randomIndices(paletteSize);
+    std::size_t const bytes                  = byteSize(paletteSize);
+    unsigned const bits                      = image::indexBitWidth(paletteSize);
+    double const megaIndices                 = bench::megaPixels(INDEX_COUNT, 1);
+    std::string const suffix                 = " palette " + std::to_string(paletteSize);
+
+    std::vector<char> aligned(INDEX_COUNT * bytes);
+    bench::report("byte-aligned encode" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    for (std::size_t i = 0; i < INDEX_COUNT; ++i) {
+                      for (std::size_t byte = 0; byte < bytes; ++byte) {
+                        aligned[(i * bytes) + byte] =
+                            static_cast<char>((indices[i] >> (byte * BYTE_BITS)) & BYTE_MASK);
+                      }
+                    }
+                  }),
+                  megaIndices);
+    std::vector<std::uint32_t> decoded(INDEX_COUNT);
+    bench::report("byte-aligned decode" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    for (std::size_t i = 0; i < INDEX_COUNT; ++i) {
+                      std::uint32_t value = 0;
+                      for (std::size_t byte = 0; byte < bytes; ++byte) {
+                        value |= std::uint32_t{static_cast<unsigned char>(
+                                     aligned[(i * bytes) + byte])}
+                                 << (byte * BYTE_BITS);
+                      }
+                      decoded[i] = value;
+                    }
+                  }),
+                  megaIndices);
+
+    std::vector<char> packed;
+    bench::report("packed encode" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    packed = image::packIndices(
+                        INDEX_COUNT, bits,
+                        [&](std::size_t const first, std::span<std::uint32_t> block) {
+                          for (std::size_t i = 0; i < block.size(); ++i) {
+                            block[i] = indices[first + i];
+                          }
+                        });
+                  }),
+                  megaIndices);
+    bench::report("packed decode" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    image::unpackIndices(packed, bits, decoded);
+                  }),
+                  megaIndices);
+    std::cout << "  index stream " << static_cast<double>(aligned.size()) / BYTES_PER_MEBIBYTE
+              << " MiB byte-aligned (" << bytes * BYTE_BITS << " bits), "
+              << static_cast<double>(packed.size()) / BYTES_PER_MEBIBYTE << " MiB packed ("
+              << bits << " bits)\n";
+  }
+}  // namespace
+
+// Codificación y decodificación de 4 Mi índices de C6 (bytes enteros) frente a C6v2 (bits
+// empaquetados) con paletas de distintos tamaños. Todo en un hilo para comparar los núcleos y no
+// el reparto; la columna de tasa indica millones de índices por segundo.
+int main() {
+  threadpool::setThreadCount(1);
+  for (std::size_t const paletteSize : PALETTE_SIZES) { benchPalette(paletteSize); }
+  return EXIT_SUCCESS;
+}
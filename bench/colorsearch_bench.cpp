@@ -0,0 +1,72 @@
+#include <array>
+#include <bench/bench.hpp>
+#include <common/colorsearch.hpp>
+#include <cstdlib>
+#include <imgaos/imageaos.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr std::size_t QUERY_COUNT                  = 20000;
+  constexpr std::array<std::size_t, 7> PALETTE_SIZES = {16, 64, 256, 1024, 4096, 16384, 65536};
+  constexpr std::uint32_t PALETTE_SEED               = 12345;
+  constexpr std::uint32_t QUERY_SEED                 = 67890;
+  constexpr std::uint32_t LCG_MULTIPLIER             = 1664525U;
+  constexpr std::uint32_t LCG_INCREMENT              = 1013904223U;
+  constexpr unsigned LCG_DISCARD_BITS                = 8;
+
+  std::vector<image::ColorTuple> randomColors(std::size_t const count, int const maxColorValue,
+                                              std::uint32_t seed) {
+    auto const levels = static_cast<std::uint32_t>(maxColorValue + 1);
+    auto const next   = [&seed, levels] {
+      seed = (seed * LCG_MULTIPLIER) + LCG_INCREMENT;
+      return static_cast<std::uint16_t>((seed >> LCG_DISCARD_BITS) % levels);
+    };
+    std::vector<image::ColorTuple> colors;
+    for (std::size_t i = 0; i < count; ++i) {
+      std::uint16_t const red   = next();
+      std::uint16_t const green = next();
+      std::uint16_t const blue  = next();
+      colors.emplace_back(red, green, blue);
+    }
+    return colors;
+  }
+
+  // Todas las búsquedas en el hilo actual, para comparar los algoritmos y no el reparto
+  void benchPalette(std::size_t const size, int const maxColorValue) {
+    auto const palette = randomColors(size, maxColorValue, PALETTE_SEED);
+    auto const queries = randomColors(QUERY_COUNT, maxColorValue, QUERY_SEED);
+    std::vector<std::uint32_t> indices(queries.size());
+    double const megaQueries = static_cast<double>(queries.size()) / bench::PIXELS_PER_MP;
+    std::string const suffix =
+        " " + std::to_string(maxColorValue) + " palette " + std::to_string(size);
+
+    bench::report("scalar" + suffix, bench::bestOf(1, [&] {
+                    for (auto const & query : queries) {
+                      static_cast<void>(imageaos::Image::findClosestColor(query, palette));
+                    }
+                  }),
+                  megaQueries);
+    bench::report("tree" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    image::ColorTree const tree(palette);
+                    for (std::size_t i = 0; i < queries.size(); ++i) {
+                      indices[i] = tree.nearest(queries[i]);
+                    }
+                  }),
+                  megaQueries);
+    bench::report("planar" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    image::PlanarPalette const planar(palette);
+                    planar.nearest(queries, indices);
+                  }),
+                  megaQueries);
+  }
+}  // namespace
+
+// Búsqueda del color más cercano para 20000 consultas con paletas de distintos tamaños. La
+// columna de tasa indica millones de consultas por segundo.
+int main() {
+  for (int const maxColorValue : {image::MAX_COLOR_VALUE_8BIT, image::MAX_COLOR_VALUE_16BIT}) {
+    for (std::size_t const size : PALETTE_SIZES) { benchPalette(size, maxColorValue); }
+  }
+  return EXIT_SUCCESS;
+}
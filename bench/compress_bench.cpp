@@ -0,0 +1,71 @@
+#include <bench/bench.hpp>
+#include <common/image.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <imgaos/imageaos.hpp>
+#include <imgsoa/imagesoa.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr unsigned long DEFAULT_WIDTH  = 2000;
+  constexpr unsigned long DEFAULT_HEIGHT = 2000;
+
+  struct BenchCase {
+      std::filesystem::path input;
+      std::filesystem::path output;
+      std::string name;
+      std::string decompressName;
+      double megaPixels;
+  };
+
+  template <typename ImageType>
+  void benchmarkCompress(BenchCase const & benchCase) {
+    ImageType image;
+    image.loadFromFile(benchCase.input.string());
+    double const loaded = bench::peakResidentMebibytes();
+    bench::report(benchCase.name, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    static_cast<void>(image.saveToFileCompress(benchCase.output.string()));
+                  }),
+                  benchCase.megaPixels);
+    std::cout << "  peak RSS " << loaded << " MiB after load, " << bench::peakResidentMebibytes()
+              << " MiB after compress\n";
+
+    ImageType expanded;
+    bench::report(benchCase.decompressName, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                    static_cast<void>(expanded.loadFromFileCompress(benchCase.output.string()));
+                  }),
+                  benchCase.megaPixels);
+  }
+}  // namespace
+
+// Coste de compress (y de volver a cargar el resultado con decompress) sobre ruido, que maximiza
+// el número de colores distintos. La memoria pico es la de todo el proceso, así que cada ejecución
+// mide una sola disposición:
+//   compress-bench [ancho alto maxval aos|soa]
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  unsigned long const width  = args.size() > 1 ? std::stoul(args[1]) : DEFAULT_WIDTH;
+  unsigned long const height = args.size() > 2 ? std::stoul(args[2]) : DEFAULT_HEIGHT;
+  auto const maxColorValue   = static_cast<unsigned short>(
+      args.size() > 3 ? std::stoul(args[3]) : image::MAX_COLOR_VALUE_8BIT);
+  std::string const layout = args.size() > 4 ? args[4] : "aos";
+
+  auto const input =
+      bench::writeSyntheticPpm("imtool-compress-bench.ppm", width, height, maxColorValue);
+  BenchCase const benchCase{
+    .input          = input,
+    .output         = std::filesystem::temp_directory_path() / "imtool-compress-bench.cppm",
+    .name           = layout + " compress maxval " + std::to_string(maxColorValue),
+    .decompressName = layout + " decompress maxval " + std::to_string(maxColorValue),
+    .megaPixels     = bench::megaPixels(width, height)};
+  if (layout == "soa") {
+    benchmarkCompress<imagesoa::Image>(benchCase);
+  } else {
+    benchmarkCompress<imageaos::Image>(benchCase);
+  }
+  std::filesystem::remove(benchCase.input);
+  std::filesystem::remove(benchCase.output);
+  return EXIT_SUCCESS;
+}
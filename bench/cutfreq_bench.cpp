@@ -0,0 +1,96 @@
+#include <array>
+#include <bench/bench.hpp>
+#include <common/histogram.hpp>
+#include <cstdlib>
+#include <imgaos/imageaos.hpp>
+#include <imgsoa/imagesoa.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+  // 2M píxeles de ruido: unos 1,9M colores distintos
+  constexpr unsigned long DEFAULT_WIDTH  = 2000;
+  constexpr unsigned long DEFAULT_HEIGHT = 1000;
+  constexpr std::uint32_t DEFAULT_CUT    = 100000;
+  // Cortes de la selección, en porcentaje del número de colores distintos
+  constexpr std::array<std::size_t, 3> SELECTION_PERCENTS = {1, 50, 99};
+  constexpr std::size_t PERCENT                           = 100;
+  // Imagen de 16 bits del modo aproximado: 200K colores distintos, de los que se elimina la mitad
+  constexpr unsigned long WIDE_WIDTH  = 500;
+  constexpr unsigned long WIDE_HEIGHT = 400;
+  constexpr std::uint32_t WIDE_CUT    = 100000;
+
+  // Cada iteración parte de una copia de la imagen cargada; la copia entra en el tiempo medido
+  template <typename ImageType>
+  double timeCutfreq(ImageType const & source, std::uint32_t const cut) {
+    return bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+      ImageType copy = source;
+      copy.cutfreq(cut);
+    });
+  }
+
+  template <typename ImageType>
+  double timeCutfreqApproximate(ImageType const & source, std::uint32_t const cut) {
+    return bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+      ImageType copy = source;
+      static_cast<void>(copy.cutfreqApproximate(cut));
+    });
+  }
+
+  // cutfreq exacto frente al aproximado sobre ruido de 16 bits
+  void reportApproximate() {
+    auto const path = bench::writeSyntheticPpm("imtool-cutfreq-bench-16.ppm", WIDE_WIDTH,
+                                               WIDE_HEIGHT, image::MAX_COLOR_VALUE_16BIT);
+    imagesoa::Image soa;
+    soa.loadFromFile(path.string());
+    std::filesystem::remove(path);
+    double const megaPixels  = bench::megaPixels(WIDE_WIDTH, WIDE_HEIGHT);
+    std::string const suffix = " 16-bit " + std::to_string(WIDE_CUT);
+    bench::report("soa cutfreq" + suffix, timeCutfreq(soa, WIDE_CUT), megaPixels);
+    bench::report("soa cutfreq approx" + suffix, timeCutfreqApproximate(soa, WIDE_CUT), megaPixels);
+  }
+
+  // Selección de los colores a eliminar: ordenación completa (sortColorsByFrequency y
+  // splitColors) frente a splitLeastFrequent
+  void reportSelection(imageaos::Image const & source, double const megaPixels) {
+    auto const histogram   = image::countColors(source.getChannels(), source.getMaxColorValue());
+    auto const frequencies = image::unpackFrequencies(histogram);
+    for (std::size_t const percent : SELECTION_PERCENTS) {
+      auto const cut           = static_cast<std::uint32_t>(histogram.size() * percent / PERCENT);
+      std::string const suffix = " " + std::to_string(cut) + "/" + std::to_string(histogram.size());
+      bench::report("sort+split" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                      auto const sorted = imageaos::Image::sortColorsByFrequency(frequencies);
+                      auto const split  = imageaos::Image::splitColors(sorted, cut);
+                    }),
+                    megaPixels);
+      bench::report("splitLeastFrequent" + suffix, bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+                      auto const split = image::splitLeastFrequent(histogram, cut);
+                    }),
+                    megaPixels);
+    }
+  }
+}  // namespace
+
+// Coste de cutfreq sobre una imagen de 8 bits con ruido, en la que casi todos los píxeles tienen
+// un color distinto
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  unsigned long const width  = args.size() > 1 ? std::stoul(args[1]) : DEFAULT_WIDTH;
+  unsigned long const height = args.size() > 2 ? std::stoul(args[2]) : DEFAULT_HEIGHT;
+  auto const cut = args.size() > 3 ? static_cast<std::uint32_t>(std::stoul(args[3])) : DEFAULT_CUT;
+
+  auto const path = bench::writeSyntheticPpm("imtool-cutfreq-bench.ppm", width, height,
+                                             image::MAX_COLOR_VALUE_8BIT);
+  imageaos::Image aos;
+  imagesoa::Image soa;
+  aos.loadFromFile(path.string());
+  soa.loadFromFile(path.string());
+  std::filesystem::remove(path);
+
+  double const megaPixels = bench::megaPixels(width, height);
+  bench::report("aos cutfreq " + std::to_string(cut), timeCutfreq(aos, cut), megaPixels);
+  bench::report("soa cutfreq " + std::to_string(cut), timeCutfreq(soa, cut), megaPixels);
+  reportSelection(aos, megaPixels);
+  reportApproximate();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,70 @@
+#include <bench/bench.hpp>
+#include <common/image.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <imgaos/imageaos.hpp>
+#include <imgsoa/imagesoa.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr unsigned long DEFAULT_WIDTH  = 4000;
+  constexpr unsigned long DEFAULT_HEIGHT = 3000;
+
+  // Lector original byte a byte con std::ifstream::get(), como referencia
+  bool loadPerByte(std::string const & filePath, std::vector<imageaos::Pixel> & pixels) {
+    std::ifstream file(filePath, std::ios::binary);
+    image::Image header;
+    if (!header.readHeader(file)) { return false; }
+
+    pixels.resize(header.getWidth() * header.getHeight());
+    bool const wide = header.getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT;
+    auto const sample = [&file, wide] {
+      return wide ? static_cast<unsigned short>(file.get() << imageaos::BYTE_SHIFT | file.get())
+                  : static_cast<unsigned short>(file.get());
+    };
+    for (auto & pixel : pixels) {
+      pixel.red   = sample();
+      pixel.green = sample();
+      pixel.blue  = sample();
+    }
+    return !file.eof();
+  }
+
+  void benchmarkLoad(unsigned long width, unsigned long height, unsigned short maxColorValue) {
+    std::string const suffix = maxColorValue > image::MAX_COLOR_VALUE_8BIT ? "16" : "8";
+    auto const path = bench::writeSyntheticPpm("imtool-load-bench-" + suffix + ".ppm", width,
+                                               height, maxColorValue);
+    double const megaPixels = bench::megaPixels(width, height);
+
+    std::vector<imageaos::Pixel> reference;
+    bench::report("per-byte get() " + suffix + "-bit",
+                  bench::bestOf(bench::DEFAULT_ITERATIONS,
+                                [&] { loadPerByte(path.string(), reference); }),
+                  megaPixels);
+
+    imageaos::Image aos;
+    bench::report("aos loadFromFile " + suffix + "-bit",
+                  bench::bestOf(bench::DEFAULT_ITERATIONS,
+                                [&] { aos.loadFromFile(path.string()); }),
+                  megaPixels);
+
+    imagesoa::Image soa;
+    bench::report("soa loadFromFile " + suffix + "-bit",
+                  bench::bestOf(bench::DEFAULT_ITERATIONS,
+                                [&] { soa.loadFromFile(path.string()); }),
+                  megaPixels);
+
+    std::filesystem::remove(path);
+  }
+}  // namespace
+
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  unsigned long const width  = args.size() > 1 ? std::stoul(args[1]) : DEFAULT_WIDTH;
+  unsigned long const height = args.size() > 2 ? std::stoul(args[2]) : DEFAULT_HEIGHT;
+
+  benchmarkLoad(width, height, image::MAX_COLOR_VALUE_8BIT);
+  benchmarkLoad(width, height, image::MAX_COLOR_VALUE_16BIT);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,41 @@
+#include <bench/bench.hpp>
+#include <cstdlib>
+#include <imgaos/imageaos.hpp>
+#include <imgsoa/imagesoa.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr unsigned long DEFAULT_WIDTH  = 7680;
+  constexpr unsigned long DEFAULT_HEIGHT = 4320;
+  constexpr unsigned short TARGET_LEVEL  = 1023;
+
+  template <typename ImageType>
+  double timeMaxLevel(ImageType const & source) {
+    ImageType copy = source;
+    return bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+      copy.setMaxColorValue(source.getMaxColorValue());
+      copy.modifyMaxLevel(TARGET_LEVEL);
+    });
+  }
+}  // namespace
+
+// Coste de maxlevel sobre una imagen de 16 bits ya cargada (sin lectura ni escritura)
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  unsigned long const width  = args.size() > 1 ? std::stoul(args[1]) : DEFAULT_WIDTH;
+  unsigned long const height = args.size() > 2 ? std::stoul(args[2]) : DEFAULT_HEIGHT;
+
+  auto const path = bench::writeSyntheticPpm("imtool-maxlevel-bench.ppm", width, height,
+                                             image::MAX_COLOR_VALUE_16BIT);
+  imageaos::Image aos;
+  imagesoa::Image soa;
+  aos.loadFromFile(path.string());
+  soa.loadFromFile(path.string());
+  std::filesystem::remove(path);
+
+  double const megaPixels = bench::megaPixels(width, height);
+  bench::report("aos maxlevel", timeMaxLevel(aos), megaPixels);
+  bench::report("soa maxlevel", timeMaxLevel(soa), megaPixels);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <array>
+#include <bench/bench.hpp>
+#include <common/threadpool.hpp>
+#include <cstdlib>
+#include <imgaos/imageaos.hpp>
+#include <imgsoa/imagesoa.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+  constexpr unsigned long DEFAULT_WIDTH  = 7680;
+  constexpr unsigned long DEFAULT_HEIGHT = 4320;
+
+  struct NamedFilter {
+      char const * name;
+      image::ResampleFilter filter;
+  };
+
+  constexpr std::array<NamedFilter, 4> FILTERS{
+    NamedFilter{.name = "box", .filter = image::ResampleFilter::Box},
+    NamedFilter{.name = "bilinear", .filter = image::ResampleFilter::Bilinear},
+    NamedFilter{.name = "bicubic", .filter = image::ResampleFilter::Bicubic},
+    NamedFilter{.name = "lanczos3", .filter = image::ResampleFilter::Lanczos3}};
+
+  template <typename ImageType>
+  double timeResize(ImageType const & source, unsigned long width, unsigned long height) {
+    return bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+      ImageType copy = source;
+      copy.resize(width, height);
+    });
+  }
+
+  template <typename ImageType>
+  double timeResample(ImageType const & source, unsigned long width, unsigned long height,
+                      image::ResampleFilter filter) {
+    return bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+      ImageType copy = source;
+      copy.resample(width, height, filter);
+    });
+  }
+
+  template <typename ImageType>
+  double timeResizeFixed(ImageType const & source, unsigned long width, unsigned long height) {
+    return bench::bestOf(bench::DEFAULT_ITERATIONS, [&] {
+      ImageType copy = source;
+      copy.resizeFixed(width, height);
+    });
+  }
+}  // namespace
+
+// Escalabilidad del redimensionado por filas: tiempo y aceleración frente a un hilo, coste de
+// la interpolación en punto fijo frente a la de coma flotante con un hilo, y coste de cada filtro
+// del remuestreador separable con todos los hilos
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  unsigned long const width  = args.size() > 1 ? std::stoul(args[1]) : DEFAULT_WIDTH;
+  unsigned long const height = args.size() > 2 ? std::stoul(args[2]) : DEFAULT_HEIGHT;
+
+  auto const path = bench::writeSyntheticPpm("imtool-resize-bench.ppm", width, height,
+                                             image::MAX_COLOR_VALUE_16BIT);
+  imageaos::Image aos;
+  imagesoa::Image soa;
+  aos.loadFromFile(path.string());
+  soa.loadFromFile(path.string());
+  std::filesystem::remove(path);
+
+  double const megaPixels = bench::megaPixels(width / 2, height / 2);
+  double aosSerial        = 0.0;
+  double soaSerial        = 0.0;
+  unsigned const maxThreads = std::max(1U, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    threadpool::setThreadCount(threads);
+    double const aosTime = timeResize(aos, width / 2, height / 2);
+    double const soaTime = timeResize(soa, width / 2, height / 2);
+    if (threads == 1) {
+      aosSerial = aosTime;
+      soaSerial = soaTime;
+    }
+
+    bench::report("aos resize x" + std::to_string(threads) + " (speedup " +
+                      std::to_string(aosSerial / aosTime) + ")",
+                  aosTime, megaPixels);
+    bench::report("soa resize x" + std::to_string(threads) + " (speedup " +
+                      std::to_string(soaSerial / soaTime) + ")",
+                  soaTime, megaPixels);
+  }
+
+  threadpool::setThreadCount(1);
+  bench::report("aos resize fixed x1", timeResizeFixed(aos, width / 2, height / 2), megaPixels);
+  bench::report("soa resize fixed x1", timeResizeFixed(soa, width / 2, height / 2), megaPixels);
+
+  threadpool::setThreadCount(0);
+  for (auto const & [name, filter] : FILTERS) {
+    bench::report(std::string("aos resample ") + name,
+                  timeResample(aos, width / 2, height / 2, filter), megaPixels);
+    bench::report(std::string("soa resample ") + name,
+                  timeResample(soa, width / 2, height / 2, filter), megaPixels);
+  }
+  return EXIT_SUCCESS;
+}
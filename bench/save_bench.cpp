@@ -0,0 +1,70 @@
+#include <bench/bench.hpp>
+#include <common/image.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <imgaos/imageaos.hpp>
+#include <imgsoa/imagesoa.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr unsigned long DEFAULT_WIDTH  = 4000;
+  constexpr unsigned long DEFAULT_HEIGHT = 3000;
+
+  // Escritor original con una llamada a std::ofstream::put() por byte, como referencia
+  void savePerByte(imageaos::Image const & image, std::string const & filePath) {
+    std::ofstream file(filePath, std::ios::binary);
+    image.writeHeader(file);
+    bool const wide = image.getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT;
+    for (unsigned long yPos = 0; yPos < image.getHeight(); ++yPos) {
+      for (unsigned long xPos = 0; xPos < image.getWidth(); ++xPos) {
+        for (unsigned short const value : {image.getPixel(xPos, yPos).red,
+                                           image.getPixel(xPos, yPos).green,
+                                           image.getPixel(xPos, yPos).blue}) {
+          if (wide) { file.put(static_cast<char>(value >> imageaos::BYTE_SHIFT)); }
+          file.put(static_cast<char>(value & imageaos::BYTE_MASK));
+        }
+      }
+    }
+  }
+
+  void benchmarkSave(unsigned long width, unsigned long height, unsigned short maxColorValue) {
+    std::string const suffix = maxColorValue > image::MAX_COLOR_VALUE_8BIT ? "16" : "8";
+    auto const input  = bench::writeSyntheticPpm("imtool-save-bench-in.ppm", width, height,
+                                                 maxColorValue);
+    auto const output = std::filesystem::temp_directory_path() / "imtool-save-bench-out.ppm";
+    double const megaPixels = bench::megaPixels(width, height);
+
+    imageaos::Image aos;
+    imagesoa::Image soa;
+    aos.loadFromFile(input.string());
+    soa.loadFromFile(input.string());
+
+    bench::report("per-byte put() " + suffix + "-bit",
+                  bench::bestOf(bench::DEFAULT_ITERATIONS,
+                                [&] { savePerByte(aos, output.string()); }),
+                  megaPixels);
+    bench::report("aos saveToFile " + suffix + "-bit",
+                  bench::bestOf(bench::DEFAULT_ITERATIONS,
+                                [&] { static_cast<void>(aos.saveToFile(output.string())); }),
+                  megaPixels);
+    bench::report("soa saveToFile " + suffix + "-bit",
+                  bench::bestOf(bench::DEFAULT_ITERATIONS,
+                                [&] { static_cast<void>(soa.saveToFile(output.string())); }),
+                  megaPixels);
+
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+  }
+}  // namespace
+
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  unsigned long const width  = args.size() > 1 ? std::stoul(args[1]) : DEFAULT_WIDTH;
+  unsigned long const height = args.size() > 2 ? std::stoul(args[2]) : DEFAULT_HEIGHT;
+
+  benchmarkSave(width, height, image::MAX_COLOR_VALUE_8BIT);
+  benchmarkSave(width, height, image::MAX_COLOR_VALUE_16BIT);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <common/batch.hpp>
+#include <common/threadpool.hpp>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+
+namespace image {
+  namespace {
+    constexpr char COMMENT_PREFIX       = '#';
+    constexpr char const * PROGRAM_NAME = "imtool";
+    constexpr double MILLISECONDS       = 1000.0;
+    constexpr double BYTES_PER_MEBIBYTE = 1024.0 * 1024.0;
+    constexpr double MIN_SECONDS        = 1e-9;
+    constexpr int STATUS_WIDTH          = 8;
+
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point const start) {
+      return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // info escribe en la salida estándar y --threads y --json solo tienen sentido para el proceso
+    std::string jobRestriction(progargs::ParsedOperationArgs const & args) {
+      if (args.operation == progargs::Info || args.operation == progargs::Batch ||
+          args.operation == progargs::Serve) {
+        return "Operation not allowed in a job";
+      }
+      if (args.options.threads != 0 || args.options.json) {
+        return "Only --labels, --packed and --memory-limit are allowed in a job";
+      }
+      return {};
+    }
+
+    std::uintmax_t inputSize(BatchJob const & job) {
+      if (!job.error.empty()) { return 0; }
+      std::error_code error;
+      std::uintmax_t const size = std::filesystem::file_size(job.args.inputFilePath, error);
+      return error ? 0 : size;
+    }
+
+    // Las líneas de estado de varios hilos no se mezclan
+    class StatusWriter {
+      public:
+        explicit StatusWriter(std::ostream & out) : out_(out) { }
+
+        void write(std::string const & status, BatchJob const & job, std::string const & detail) {
+          std::ostringstream line;
+          line << std::left << std::setw(STATUS_WIDTH) << status << "line " << job.line << "  "
+               << detail << '\n';
+          std::scoped_lock const lock(mutex_);
+          out_ << line.str() << std::flush;
+        }
+
+      private:
+        std::ostream & out_;
+        std::mutex mutex_;
+    };
+
+    // Dos rutas escritas de forma distinta al mismo fichero tienen la misma clave
+    std::filesystem::path pathKey(std::string const & path) {
+      std::error_code error;
+      std::filesystem::path const absolute = std::filesystem::absolute(path, error);
+      if (error) { return std::filesystem::path(path).lexically_normal(); }
+      std::filesystem::path key = std::filesystem::weakly_canonical(absolute, error);
+      return error ? absolute.lexically_normal() : key;
+    }
+
+    // Los trabajos de un lote se ejecutan a la vez y en cualquier orden, así que un fichero que
+    // escribe un trabajo no puede ser la salida ni la entrada de otro
+    void rejectOverlaps(std::vector<BatchJob> & jobs) {
+      std::map<std::filesystem::path, std::size_t> writers;  // salida -> línea que la escribe
+      for (BatchJob & job : jobs) {
+        if (!job.error.empty()) { continue; }
+        auto const [writer, inserted] =
+            writers.try_emplace(pathKey(job.args.outputFilePath), job.line);
+        if (!inserted) {
+          job.error = "Output already written by line " + std::to_string(writer->second);
+        }
+      }
+      for (BatchJob & job : jobs) {
+        if (!job.error.empty()) { continue; }
+        auto const writer = writers.find(pathKey(job.args.inputFilePath));
+        if (writer != writers.end() && writer->second != job.line) {
+          job.error = "Input is written by line " + std::to_string(writer->second);
+        }
+      }
+    }
+
+    std::string describe(BatchJob const & job, double const seconds) {
+      std::ostringstream detail;
+      detail << std::fixed << std::setprecision(2) << seconds * MILLISECONDS << " ms  "
+             << job.args.inputFilePath << " -> " << job.args.outputFilePath;
+      return detail.str();
+    }
+  }  // namespace
+
+  BatchJob parseJobLine(std::size_t const line, std::string const & text) {
+    std::istringstream tokens(text);
+    std::vector<std::string> args{PROGRAM_NAME};
+    args.insert(args.end(), std::istream_iterator<std::string>(tokens),
+                std::istream_iterator<std::string>());
+
+    BatchJob job;
+    job.line = line;
+    try {
+      job.args  = progargs::parseJob(args);
+      job.error = jobRestriction(job.args);
+    } catch (progargs::ArgumentError const & error) {
+      job.error = error.what();
+    }
+    return job;
+  }
+
+  std::vector<BatchJob> readManifest(std::istream & manifest) {
+    std::vector<BatchJob> jobs;
+    std::string text;
+    for (std::size_t line = 1; std::getline(manifest, text); ++line) {
+      auto const first = text.find_first_not_of(" \t\r");
+      if (first == std::string::npos || text[first] == COMMENT_PREFIX) { continue; }
+      jobs.push_back(parseJobLine(line, text));
+    }
+    rejectOverlaps(jobs);
+    return jobs;
+  }
+
+  BatchSummary runBatch(std::vector<BatchJob> const & jobs, JobRunner const & run,
+                        std::ostream & out) {
+    Clock::time_point const start = Clock::now();
+    StatusWriter writer(out);
+    BatchSummary summary;
+
+    std::vector<std::uintmax_t> sizes(jobs.size());
+    std::ranges::transform(jobs, sizes.begin(), inputSize);
+    std::vector<std::size_t> order(jobs.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::ranges::stable_sort(order, [&sizes](std::size_t const left, std::size_t const right) {
+      return sizes[left] > sizes[right];
+    });
+
+    std::vector<char> succeeded(jobs.size(), 0);
+    threadpool::parallelForEach(0, order.size(), [&](std::size_t const position) {
+      BatchJob const & job = jobs[order[position]];
+      if (!job.error.empty()) {
+        writer.write("invalid", job, job.error);
+        return;
+      }
+      Clock::time_point const jobStart = Clock::now();
+      bool ok                          = false;
+      std::string failure;
+      try {
+        ok = run(job.args);
+      } catch (std::exception const & error) {
+        failure = std::string("  (") + error.what() + ")";
+      }
+      writer.write(ok ? "ok" : "failed", job, describe(job, secondsSince(jobStart)) + failure);
+      succeeded[order[position]] = ok ? 1 : 0;
+    });
+
+    summary.succeeded  = static_cast<std::size_t>(std::ranges::count(succeeded, 1));
+    summary.failed     = jobs.size() - summary.succeeded;
+    summary.inputBytes = std::accumulate(sizes.begin(), sizes.end(), std::uintmax_t{0});
+    summary.seconds    = secondsSince(start);
+
+    double const seconds = std::max(summary.seconds, MIN_SECONDS);
+    out << "Batch: " << summary.succeeded << " ok, " << summary.failed << " failed, "
+        << std::fixed << std::setprecision(3) << summary.seconds << " s, "
+        << std::setprecision(1) << static_cast<double>(jobs.size()) / seconds << " jobs/s, "
+        << static_cast<double>(summary.inputBytes) / BYTES_PER_MEBIBYTE / seconds
+        << " MiB/s read\n";
+    return summary;
+  }
+
+  bool runManifest(std::string const & manifestPath, JobRunner const & run, std::ostream & out) {
+    std::ifstream manifest(manifestPath);
+    if (!manifest.is_open()) {
+      std::cerr << "Failed to open file: " << manifestPath << '\n';
+      return false;
+    }
+    return runBatch(readManifest(manifest), run, out).failed == 0;
+  }
+}  // namespace image
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <common/progargs.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace image {
+  // Trabajo de un manifiesto de lote: una línea "entrada salida operación args..." con la misma
+  // sintaxis que la línea de órdenes, incluidas las cadenas con "+" y las opciones --labels,
+  // --packed y --memory-limit. Las rutas no pueden contener espacios.
+  struct BatchJob {
+      std::size_t line = 0;
+      progargs::ParsedOperationArgs args;
+      std::string error;  // vacío si la línea es válida
+  };
+
+  // Analiza una línea de trabajo; --serve recibe los trabajos con esta misma sintaxis
+  [[nodiscard]] BatchJob parseJobLine(std::size_t line, std::string const & text);
+
+  // Las líneas vacías y las que empiezan por '#' se ignoran. Una línea no válida no detiene la
+  // lectura: se devuelve con su error para informar de ella junto a los demás trabajos.
+  // runBatch no ordena los trabajos por sus ficheros, así que también son no válidos los que
+  // escriben la salida de una línea anterior y los que leen la salida de otra línea. Un trabajo
+  // sí puede escribir sobre su propia entrada.
+  [[nodiscard]] std::vector<BatchJob> readManifest(std::istream & manifest);
+
+  // Ejecuta un trabajo válido; devuelve false si falla
+  using JobRunner = std::function<bool(progargs::ParsedOperationArgs const &)>;
+
+  // Memoria de píxeles que cada hilo conserva como mucho entre trabajos de un lote o del servidor.
+  // Por encima, el JobRunner la libera al terminar: una imagen enorme no deja su memoria retenida
+  // en el hilo hasta el final del proceso.
+  inline constexpr std::size_t RECYCLED_BUFFER_BYTES = std::size_t{128} << 20;
+
+  struct BatchSummary {
+      std::size_t succeeded     = 0;
+      std::size_t failed        = 0;  // incluye las líneas no válidas
+      std::uintmax_t inputBytes = 0;
+      double seconds            = 0.0;
+  };
+
+  // Reparte los trabajos entre los hilos del pool compartido de uno en uno, empezando por las
+  // entradas más grandes para que al final queden los trabajos cortos. Cada operación sigue
+  // repartiendo sus filas con parallelFor, así que los hilos que se quedan sin trabajos ayudan
+  // con los grandes. Escribe en `out` una línea por trabajo según terminan y el resumen final.
+  BatchSummary runBatch(std::vector<BatchJob> const & jobs, JobRunner const & run,
+                        std::ostream & out);
+
+  // Lee el manifiesto de `manifestPath` y lo ejecuta con runBatch; devuelve false si algún
+  // trabajo falla
+  [[nodiscard]] bool runManifest(std::string const & manifestPath, JobRunner const & run,
+                                 std::ostream & out);
+}  // namespace image
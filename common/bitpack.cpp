@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <common/bitpack.hpp>
+#include <common/threadpool.hpp>
+#include <utility>
+
+namespace image {
+  namespace {
+    // Índices por grupo: 8 índices de b bits ocupan b bytes completos
+    constexpr std::size_t GROUP = 8;
+    // Índices por bloque de trabajo (múltiplo de GROUP, así que cada bloque empieza en un byte)
+    constexpr std::size_t PACK_BLOCK = std::size_t{1} << 14;
+
+    constexpr unsigned BYTE_BITS        = 8;
+    constexpr std::uint64_t BYTE_MASK   = 0xFF;
+    constexpr unsigned MAX_INDEX_BITS   = 32;
+    constexpr std::size_t ONE_BYTE_MAX  = std::size_t{1} << BYTE_BITS;
+    constexpr std::size_t TWO_BYTES_MAX = std::size_t{1} << (2 * BYTE_BITS);
+    constexpr std::size_t FOUR_BYTES    = 4;
+
+    using Group       = std::array<std::uint32_t, GROUP>;
+    using PackedGroup = std::array<char, MAX_INDEX_BITS>;
+
+    template <unsigned Bits>
+    void packGroup(std::span<std::uint32_t const, GROUP> indices, std::span<char> out) {
+      std::uint64_t buffer = 0;
+      unsigned filled      = 0;
+      std::size_t byte     = 0;
+      for (std::size_t i = 0; i < GROUP; ++i) {
+        buffer |= std::uint64_t{indices[i]} << filled;
+        filled += Bits;
+        while (filled >= BYTE_BITS) {
+          out[byte++] = static_cast<char>(buffer & BYTE_MASK);
+          buffer >>= BYTE_BITS;
+          filled -= BYTE_BITS;
+        }
+      }
+    }
+
+    template <unsigned Bits>
+    void unpackGroup(std::span<char const> in, std::span<std::uint32_t, GROUP> indices) {
+      constexpr std::uint64_t mask = (std::uint64_t{1} << Bits) - 1;
+      std::uint64_t buffer         = 0;
+      unsigned filled              = 0;
+      std::size_t byte             = 0;
+      for (std::size_t i = 0; i < GROUP; ++i) {
+        while (filled < Bits) {
+          buffer |= std::uint64_t{static_cast<unsigned char>(in[byte++])} << filled;
+          filled += BYTE_BITS;
+        }
+        indices[i] = static_cast<std::uint32_t>(buffer & mask);
+        buffer >>= Bits;
+        filled -= Bits;
+      }
+    }
+
+    // Grupos completos de un bloque; el ancho fijo permite al compilador desenrollar cada grupo
+    template <unsigned Bits>
+    void packGroups(std::span<std::uint32_t const> indices, std::span<char> out) {
+      for (std::size_t group = 0; group < indices.size() / GROUP; ++group) {
+        packGroup<Bits>(indices.subspan(group * GROUP).first<GROUP>(), out.subspan(group * Bits));
+      }
+    }
+
+    template <unsigned Bits>
+    void unpackGroups(std::span<char const> in, std::span<std::uint32_t> indices) {
+      for (std::size_t group = 0; group < indices.size() / GROUP; ++group) {
+        unpackGroup<Bits>(in.subspan(group * Bits), indices.subspan(group * GROUP).first<GROUP>());
+      }
+    }
+
+    using GroupsPacker   = void (*)(std::span<std::uint32_t const>, std::span<char>);
+    using GroupsUnpacker = void (*)(std::span<char const>, std::span<std::uint32_t>);
+
+    template <std::size_t... Bits>
+    constexpr std::array<GroupsPacker, sizeof...(Bits)> makePackers(
+        std::index_sequence<Bits...> /*bits*/) {
+      return {&packGroups<Bits>...};
+    }
+
+    template <std::size_t... Bits>
+    constexpr std::array<GroupsUnpacker, sizeof...(Bits)> makeUnpackers(
+        std::index_sequence<Bits...> /*bits*/) {
+      return {&unpackGroups<Bits>...};
+    }
+
+    constexpr auto PACKERS   = makePackers(std::make_index_sequence<MAX_INDEX_BITS + 1>{});
+    constexpr auto UNPACKERS = makeUnpackers(std::make_index_sequence<MAX_INDEX_BITS + 1>{});
+
+    // Los últimos índices que no completan un grupo se empaquetan rellenados con ceros
+    void packBlock(std::span<std::uint32_t const> indices, unsigned const bits,
+                   std::span<char> out) {
+      std::size_t const full = indices.size() - (indices.size() % GROUP);
+      PACKERS[bits](indices.first(full), out);
+      if (full == indices.size()) { return; }
+
+      Group tail{};
+      std::ranges::copy(indices.subspan(full), tail.begin());
+      PackedGroup packed{};
+      PACKERS[bits](tail, packed);
+      std::size_t const offset = full / GROUP * bits;
+      std::copy_n(packed.begin(), packedByteSize(indices.size() - full, bits),
+                  out.subspan(offset).begin());
+    }
+
+    void unpackBlock(std::span<char const> in, unsigned const bits,
+                     std::span<std::uint32_t> indices) {
+      std::size_t const full = indices.size() - (indices.size() % GROUP);
+      UNPACKERS[bits](in, indices.first(full));
+      if (full == indices.size()) { return; }
+
+      std::size_t const offset = full / GROUP * bits;
+      PackedGroup packed{};
+      std::copy_n(in.subspan(offset).begin(), packedByteSize(indices.size() - full, bits),
+                  packed.begin());
+      Group tail{};
+      UNPACKERS[bits](packed, tail);
+      std::copy_n(tail.begin(), indices.size() - full, indices.subspan(full).begin());
+    }
+  }  // namespace
+
+  std::size_t indexByteSize(std::size_t const colorTableSize) {
+    if (colorTableSize <= ONE_BYTE_MAX) { return 1; }
+    if (colorTableSize <= TWO_BYTES_MAX) { return 2; }
+    return FOUR_BYTES;
+  }
+
+  unsigned indexBitWidth(std::size_t const colorTableSize) {
+    if (colorTableSize <= 1) { return 0; }
+    return static_cast<unsigned>(std::bit_width(colorTableSize - 1));
+  }
+
+  std::size_t packedByteSize(std::size_t const count, unsigned const bits) {
+    return ((count * bits) + BYTE_BITS - 1) / BYTE_BITS;
+  }
+
+  std::vector<char> packIndices(std::size_t const count, unsigned const bits,
+                                IndexSource const & source) {
+    std::vector<char> packed(packedByteSize(count, bits));
+    std::size_t const blocks = (count + PACK_BLOCK - 1) / PACK_BLOCK;
+    threadpool::parallelFor(0, blocks, [&](std::size_t const first, std::size_t const last) {
+      std::vector<std::uint32_t> indices(PACK_BLOCK);
+      for (std::size_t block = first; block < last; ++block) {
+        std::size_t const begin = block * PACK_BLOCK;
+        std::span const blockIndices =
+            std::span(indices).first(std::min(PACK_BLOCK, count - begin));
+        source(begin, blockIndices);
+        packBlock(blockIndices, bits, std::span(packed).subspan(begin / GROUP * bits));
+      }
+    });
+    return packed;
+  }
+
+  void unpackIndices(std::span<char const> packed, unsigned const bits,
+                     std::span<std::uint32_t> indices) {
+    std::size_t const blocks = (indices.size() + PACK_BLOCK - 1) / PACK_BLOCK;
+    threadpool::parallelFor(0, blocks, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t block = first; block < last; ++block) {
+        std::size_t const begin = block * PACK_BLOCK;
+        unpackIndexRange(packed, bits, begin,
+                         indices.subspan(begin, std::min(PACK_BLOCK, indices.size() - begin)));
+      }
+    });
+  }
+
+  void unpackIndexRange(std::span<char const> packed, unsigned const bits, std::size_t const first,
+                        std::span<std::uint32_t> indices) {
+    unpackBlock(packed.subspan(first / GROUP * bits), bits, indices);
+  }
+}  // namespace image
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Bytes por índice de la variante C6: 1, 2 o 4 según el número de colores
+  [[nodiscard]] std::size_t indexByteSize(std::size_t colorTableSize);
+
+  // Bits por índice de la variante empaquetada: ceil(log2(colores)), 0 si solo hay un color
+  [[nodiscard]] unsigned indexBitWidth(std::size_t colorTableSize);
+
+  // Bytes que ocupan `count` índices de `bits` bits, con el último byte completado con ceros
+  [[nodiscard]] std::size_t packedByteSize(std::size_t count, unsigned bits);
+
+  // Rellena `indices` con los índices de los píxeles [first, first + indices.size())
+  using IndexSource = std::function<void(std::size_t first, std::span<std::uint32_t> indices)>;
+
+  // Flujo de bits little endian: el índice i ocupa los bits [i * bits, (i + 1) * bits). Cada
+  // grupo de 8 índices ocupa exactamente `bits` bytes, así que los bloques de píxeles se
+  // empaquetan en paralelo y cada ancho tiene su propio núcleo con desplazamientos constantes.
+  [[nodiscard]] std::vector<char> packIndices(std::size_t count, unsigned bits,
+                                              IndexSource const & source);
+
+  // Inversa de packIndices: `packed` tiene que ocupar al menos packedByteSize(indices.size(), bits)
+  void unpackIndices(std::span<char const> packed, unsigned bits,
+                     std::span<std::uint32_t> indices);
+
+  // Desempaqueta en el hilo actual los índices [first, first + indices.size()) del flujo
+  // completo `packed`; `first` tiene que ser múltiplo de 8 para empezar en un byte
+  void unpackIndexRange(std::span<char const> packed, unsigned bits, std::size_t first,
+                        std::span<std::uint32_t> indices);
+}  // namespace image
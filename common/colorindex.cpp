@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <common/colorindex.hpp>
+#include <common/image.hpp>
+#include <common/threadpool.hpp>
+
+namespace image {
+  namespace {
+    constexpr std::size_t SAMPLE_PIXELS = std::size_t{1} << 16;
+    // Píxeles por franja en el descubrimiento de colores
+    constexpr std::size_t DISCOVERY_PIXELS_PER_PART = std::size_t{1} << 16;
+
+    constexpr unsigned DIRECT_CHANNEL_BITS = 8;
+    constexpr std::size_t DIRECT_SIZE      = std::size_t{1} << (3 * DIRECT_CHANNEL_BITS);
+    constexpr std::size_t DIRECT_MASK      = (std::size_t{1} << DIRECT_CHANNEL_BITS) - 1;
+    // Por debajo de este número de píxeles no compensa reservar y poner a cero los 64 MiB del array
+    constexpr std::size_t DIRECT_MIN_PIXELS = std::size_t{1} << 20;
+
+    constexpr unsigned BYTE_BITS      = 8;
+    constexpr std::uint16_t BYTE_MASK = 0xFF;
+
+    // Posición de un color en el array directo, o DIRECT_SIZE si alguna muestra no cabe en 8 bits
+    std::size_t directIndex(PackedColor const color) {
+      auto const [red, green, blue] = unpackColor(color);
+      if ((red | green | blue) > DIRECT_MASK) { return DIRECT_SIZE; }
+      return (((std::size_t{red} << DIRECT_CHANNEL_BITS) | green) << DIRECT_CHANNEL_BITS) | blue;
+    }
+
+    // Colores de una franja por orden de primera aparición dentro de la franja
+    std::vector<PackedColor> discoverPart(PixelChannels const & pixels, PixelRange const range,
+                                          std::size_t const expected) {
+      FlatColorMap<std::uint8_t> seen(std::min(expected, range.last - range.first));
+      std::vector<PackedColor> colors;
+      for (std::size_t pixel = range.first; pixel < range.last; ++pixel) {
+        PackedColor const color = pixels.colorAt(pixel);
+        std::uint8_t & known    = seen[color];
+        if (known == 0) {
+          known = 1;
+          colors.push_back(color);
+        }
+      }
+      return colors;
+    }
+  }  // namespace
+
+  std::size_t estimateUniqueColors(PixelChannels const & pixels) {
+    if (pixels.count <= SAMPLE_PIXELS) { return pixels.count; }
+    std::size_t const step = pixels.count / SAMPLE_PIXELS;
+    FlatColorMap<std::uint32_t> sample(SAMPLE_PIXELS);
+    for (std::size_t pixel = 0; pixel < pixels.count; pixel += step) {
+      ++sample[pixels.colorAt(pixel)];
+    }
+    std::size_t sampled = 0;
+    std::size_t seen    = 0;
+    std::size_t once    = 0;
+    sample.forEach([&](PackedColor, std::uint32_t const count) {
+      sampled += count;
+      ++seen;
+      if (count == 1) { ++once; }
+    });
+    std::size_t const unsampled = pixels.count - sampled;
+    return std::min(pixels.count, seen + (once * unsampled / sampled));
+  }
+
+  // Cada hilo descubre los colores de sus franjas. Al recorrer después las franjas en orden de
+  // píxel, el primer color nuevo de cada una es también nuevo en el recorrido secuencial, así que
+  // los índices quedan en el mismo orden de primera aparición que con un solo hilo.
+  ColorIndexTable::ColorIndexTable(PixelChannels const & pixels,
+                                   unsigned short const maxColorValue) {
+    std::size_t const expected  = estimateUniqueColors(pixels);
+    std::size_t const partTotal = partCount(pixels.count, DISCOVERY_PIXELS_PER_PART);
+    std::vector<std::vector<PackedColor>> parts(partTotal);
+    threadpool::parallelFor(0, partTotal, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t part = first; part < last; ++part) {
+        parts[part] = discoverPart(pixels, partRange(pixels.count, partTotal, part), expected);
+      }
+    });
+
+    if (maxColorValue <= MAX_COLOR_VALUE_8BIT && pixels.count >= DIRECT_MIN_PIXELS &&
+        mergeDirect(parts)) {
+      return;
+    }
+    mergeHashed(parts, expected);
+  }
+
+  // Devuelve false (y deja la tabla vacía) si alguna muestra no cabe en 8 bits
+  bool ColorIndexTable::mergeDirect(std::vector<std::vector<PackedColor>> const & parts) {
+    direct_.assign(DIRECT_SIZE, 0);
+    for (auto const & part : parts) {
+      for (PackedColor const color : part) {
+        std::size_t const index = directIndex(color);
+        if (index == DIRECT_SIZE) {
+          direct_ = {};
+          colors_.clear();
+          return false;
+        }
+        if (direct_[index] == 0) {
+          colors_.push_back(color);
+          direct_[index] = static_cast<std::uint32_t>(colors_.size());
+        }
+      }
+    }
+    return true;
+  }
+
+  void ColorIndexTable::mergeHashed(std::vector<std::vector<PackedColor>> const & parts,
+                                    std::size_t const expected) {
+    hashed_ = FlatColorMap<std::uint32_t>(expected);
+    for (auto const & part : parts) {
+      for (PackedColor const color : part) {
+        std::uint32_t & index = hashed_[color];
+        if (index == 0) {
+          colors_.push_back(color);
+          index = static_cast<std::uint32_t>(colors_.size());
+        }
+      }
+    }
+  }
+
+  std::uint32_t ColorIndexTable::indexAt(PixelChannels const & pixels,
+                                         std::size_t const pixel) const {
+    if (!direct_.empty()) { return direct_[directIndex(pixels.colorAt(pixel))] - 1; }
+    return *hashed_.get(pixels.colorAt(pixel)) - 1;
+  }
+
+  bool writeCompressColorTable(std::ofstream & file, std::span<PackedColor const> colors,
+                               unsigned short const maxColorValue) {
+    std::size_t const sampleBytes = maxColorValue > MAX_COLOR_VALUE_8BIT ? 2 : 1;
+    std::vector<char> table;
+    table.reserve(colors.size() * 3 * sampleBytes);
+    for (PackedColor const color : colors) {
+      auto const [red, green, blue] = unpackColor(color);
+      for (std::uint16_t const sample : {red, green, blue}) {
+        if (sampleBytes == 2) { table.push_back(static_cast<char>(sample >> BYTE_BITS)); }
+        table.push_back(static_cast<char>(sample & BYTE_MASK));
+      }
+    }
+    file.write(table.data(), static_cast<std::streamsize>(table.size()));
+    return file.good();
+  }
+}  // namespace image
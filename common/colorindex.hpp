@@ -0,0 +1,53 @@
+#pragma once
+
+#include <common/colormap.hpp>
+#include <common/histogram.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace image {
+  // ColorIndexTable y labelColors guardan índice + 1 en un uint32_t (0 es "sin color"), así que
+  // una tabla de colores tiene como mucho 2^32 - 1 colores
+  inline constexpr std::size_t MAX_INDEXED_COLORS = std::numeric_limits<std::uint32_t>::max();
+
+  // Estimación del número de colores distintos a partir de una muestra repartida por la imagen:
+  // los colores vistos y, por cada píxel sin muestrear, la proporción de colores que solo han
+  // aparecido una vez en la muestra
+  [[nodiscard]] std::size_t estimateUniqueColors(PixelChannels const & pixels);
+
+  // Tabla de colores de compress: asigna a cada color un índice por orden de primera aparición.
+  // Con imágenes de 8 bits grandes indexa un array directo de 2^24 posiciones; en otro caso usa una
+  // tabla hash plana dimensionada con estimateUniqueColors en lugar de con el número de píxeles.
+  // Los colores se descubren en paralelo por franjas de píxeles y se fusionan en orden.
+  class ColorIndexTable {
+    public:
+      ColorIndexTable(PixelChannels const & pixels, unsigned short maxColorValue);
+
+      [[nodiscard]] std::size_t size() const { return colors_.size(); }
+
+      // Colores en orden de índice
+      [[nodiscard]] std::vector<PackedColor> const & colors() const { return colors_; }
+
+      // Índice del color del píxel `pixel`, que tiene que estar en la tabla
+      [[nodiscard]] std::uint32_t indexAt(PixelChannels const & pixels, std::size_t pixel) const;
+
+    private:
+      bool mergeDirect(std::vector<std::vector<PackedColor>> const & parts);
+      void mergeHashed(std::vector<std::vector<PackedColor>> const & parts, std::size_t expected);
+
+      // Índice + 1 de cada color de 8 bits (0 si no aparece)
+      std::vector<std::uint32_t> direct_;
+      FlatColorMap<std::uint32_t> hashed_;
+      std::vector<PackedColor> colors_;
+  };
+
+  // Tabla de colores de un fichero comprimido: tres muestras por color, de 2 bytes en big endian
+  // si `maxColorValue` no cabe en 8 bits
+  [[nodiscard]] bool writeCompressColorTable(std::ofstream & file,
+                                             std::span<PackedColor const> colors,
+                                             unsigned short maxColorValue);
+}  // namespace image
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <vector>
+
+namespace image {
+  // Color RGB de 16 bits por canal empaquetado en 48 bits: rojo, verde y azul de mayor a menor
+  // peso. El orden de los enteros coincide con el orden lexicográfico de las tuplas (r, g, b).
+  using PackedColor = std::uint64_t;
+  using ColorTuple  = std::tuple<std::uint16_t, std::uint16_t, std::uint16_t>;
+
+  constexpr unsigned RED_SHIFT            = 32;
+  constexpr unsigned GREEN_SHIFT          = 16;
+  constexpr PackedColor CHANNEL_MASK      = 0xFFFF;
+  constexpr PackedColor EMPTY_PACKED_SLOT = ~PackedColor{0};
+
+  constexpr PackedColor packColor(unsigned short const red, unsigned short const green,
+                                  unsigned short const blue) {
+    return (PackedColor{red} << RED_SHIFT) | (PackedColor{green} << GREEN_SHIFT) | blue;
+  }
+
+  constexpr ColorTuple unpackColor(PackedColor const color) {
+    return {static_cast<std::uint16_t>((color >> RED_SHIFT) & CHANNEL_MASK),
+            static_cast<std::uint16_t>((color >> GREEN_SHIFT) & CHANNEL_MASK),
+            static_cast<std::uint16_t>(color & CHANNEL_MASK)};
+  }
+
+  // Mezcla de bits (finalizador de MurmurHash3) para repartir colores parecidos por la tabla
+  constexpr std::uint64_t mixColor(PackedColor color) {
+    constexpr unsigned MIX_SHIFT         = 33;
+    constexpr std::uint64_t MIX_FACTOR_1 = 0xFF51AFD7ED558CCDULL;
+    constexpr std::uint64_t MIX_FACTOR_2 = 0xC4CEB9FE1A85EC53ULL;
+    color ^= color >> MIX_SHIFT;
+    color *= MIX_FACTOR_1;
+    color ^= color >> MIX_SHIFT;
+    color *= MIX_FACTOR_2;
+    color ^= color >> MIX_SHIFT;
+    return color;
+  }
+
+  // Tabla hash de direccionamiento abierto (sondeo lineal) con claves PackedColor. Claves y
+  // valores se guardan en vectores contiguos, sin un nodo por elemento.
+  template <typename Value>
+  class FlatColorMap {
+    public:
+      explicit FlatColorMap(std::size_t const expected = 0) { rehash(capacityFor(expected)); }
+
+      // Devuelve el valor de `color`, insertándolo con Value{} si no existía
+      Value & operator[](PackedColor const color) {
+        std::size_t slot = find(color);
+        if (keys_[slot] == EMPTY_PACKED_SLOT) {
+          if ((size_ + 1) * 2 > keys_.size()) {
+            rehash(keys_.size() * 2);
+            slot = find(color);
+          }
+          keys_[slot] = color;
+          ++size_;
+        }
+        return values_[slot];
+      }
+
+      [[nodiscard]] Value const * get(PackedColor const color) const {
+        std::size_t const slot = find(color);
+        return keys_[slot] == EMPTY_PACKED_SLOT ? nullptr : &values_[slot];
+      }
+
+      [[nodiscard]] std::size_t size() const { return size_; }
+
+      // Recorre los elementos en el orden interno de la tabla
+      template <typename Visit>
+      void forEach(Visit && visit) const {
+        for (std::size_t slot = 0; slot < keys_.size(); ++slot) {
+          if (keys_[slot] != EMPTY_PACKED_SLOT) { visit(keys_[slot], values_[slot]); }
+        }
+      }
+
+    private:
+      static constexpr std::size_t MIN_CAPACITY = 64;
+
+      static std::size_t capacityFor(std::size_t const expected) {
+        std::size_t capacity = MIN_CAPACITY;
+        while (capacity < expected * 2) { capacity *= 2; }
+        return capacity;
+      }
+
+      [[nodiscard]] std::size_t find(PackedColor const color) const {
+        std::size_t const mask = keys_.size() - 1;
+        std::size_t slot       = mixColor(color) & mask;
+        while (keys_[slot] != EMPTY_PACKED_SLOT && keys_[slot] != color) {
+          slot = (slot + 1) & mask;
+        }
+        return slot;
+      }
+
+      void rehash(std::size_t const capacity) {
+        std::vector<PackedColor> oldKeys = std::move(keys_);
+        std::vector<Value> oldValues     = std::move(values_);
+        keys_.assign(capacity, EMPTY_PACKED_SLOT);
+        values_.assign(capacity, Value{});
+        for (std::size_t slot = 0; slot < oldKeys.size(); ++slot) {
+          if (oldKeys[slot] == EMPTY_PACKED_SLOT) { continue; }
+          std::size_t const target = find(oldKeys[slot]);
+          keys_[target]            = oldKeys[slot];
+          values_[target]          = std::move(oldValues[slot]);
+        }
+      }
+
+      std::vector<PackedColor> keys_;
+      std::vector<Value> values_;
+      std::size_t size_ = 0;
+  };
+}  // namespace image
@@ -0,0 +1,599 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <common/colorsearch.hpp>
+#include <common/cpu.hpp>
+#include <common/threadpool.hpp>
+#include <limits>
+#include <numbers>
+#include <numeric>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace image {
+  namespace {
+    // Por debajo de este tamaño un nodo se recorre entero en lugar de seguir dividiendo
+    constexpr std::size_t LEAF_SIZE = 8;
+    // Consultas por bloque de trabajo en paralelo
+    constexpr std::size_t QUERY_GRAIN = 256;
+    // Consultas que comparten cada lectura de la paleta en la búsqueda exhaustiva
+    constexpr std::size_t QUERY_BLOCK = 4;
+    // Hasta este tamaño de paleta el recorrido exhaustivo vectorizado gana al árbol (medido con
+    // colorsearch-bench: el punto de cruce está hacia 1024 colores con 8 bits y 256 con 16)
+    constexpr std::size_t LINEAR_SEARCH_MAX = 512;
+    // Colores por celda que se buscan en ColorGrid y bits por eje de la rejilla (hasta 2^21 celdas)
+    constexpr std::size_t COLORS_PER_CELL = 2;
+    constexpr unsigned MIN_CELL_BITS      = 1;
+    constexpr unsigned MAX_CELL_BITS      = 7;
+
+    using Channels   = std::array<std::int32_t, 3>;
+    using QueryBlock = std::array<Channels, QUERY_BLOCK>;
+
+    struct Candidate {
+        std::int64_t distance;
+        std::uint32_t index;
+    };
+
+    constexpr Candidate NO_CANDIDATE{.distance = std::numeric_limits<std::int64_t>::max(),
+                                     .index    = std::numeric_limits<std::uint32_t>::max()};
+
+    using BlockResult = std::array<Candidate, QUERY_BLOCK>;
+
+    struct PalettePlanes {
+        std::span<std::int32_t const> red;
+        std::span<std::int32_t const> green;
+        std::span<std::int32_t const> blue;
+    };
+
+    Channels channelsOf(ColorTuple const & color) {
+      auto const [red, green, blue] = color;
+      return {red, green, blue};
+    }
+
+    std::int64_t distanceSquared(Channels const & first, Channels const & second) {
+      std::int64_t distance = 0;
+      for (std::size_t channel = 0; channel < first.size(); ++channel) {
+        std::int64_t const delta = first[channel] - second[channel];
+        distance                += delta * delta;
+      }
+      return distance;
+    }
+
+    // Menor distancia y, a igualdad, menor posición en la paleta
+    void keepCloser(Candidate & best, Candidate const candidate) {
+      if (candidate.distance < best.distance ||
+          (candidate.distance == best.distance && candidate.index < best.index)) {
+        best = candidate;
+      }
+    }
+
+    // Sigue el recorrido lineal desde la posición `first`
+    void scanScalar(PalettePlanes const & palette, std::size_t const first, Channels const & query,
+                    Candidate & best) {
+      for (std::size_t index = first; index < palette.red.size(); ++index) {
+        Channels const color{palette.red[index], palette.green[index], palette.blue[index]};
+        keepCloser(best, {.distance = distanceSquared(color, query),
+                          .index    = static_cast<std::uint32_t>(index)});
+      }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Con canales hasta este valor la suma de los tres cuadrados cabe en un int32
+    constexpr std::int32_t NARROW_CHANNEL_MAX = 0x3FFF;
+
+    struct LaneColors {
+        __m256i red;
+        __m256i green;
+        __m256i blue;
+    };
+
+    // Mejor candidato de cada carril para una consulta
+    struct LaneBest {
+        __m256i distance;
+        __m256i index;
+    };
+
+    // Carriles de 32 bits: ocho distancias por instrucción, válidas para canales pequeños
+    struct NarrowLanes {
+        using Value                        = std::int32_t;
+        static constexpr std::size_t COUNT = 8;
+
+        [[gnu::target("avx2")]] static __m256i load(std::span<std::int32_t const> plane,
+                                                    std::size_t const first) {
+          return _mm256_loadu_si256(
+              reinterpret_cast<__m256i const *>(plane.subspan(first).data()));  // NOLINT
+        }
+
+        [[gnu::target("avx2")]] static __m256i square(__m256i const plane,
+                                                      std::int32_t const value) {
+          __m256i const delta = _mm256_sub_epi32(plane, _mm256_set1_epi32(value));
+          return _mm256_mullo_epi32(delta, delta);
+        }
+
+        [[gnu::target("avx2")]] static __m256i distance(LaneColors const & colors,
+                                                        Channels const & query) {
+          return _mm256_add_epi32(_mm256_add_epi32(square(colors.red, query[0]),
+                                                   square(colors.green, query[1])),
+                                  square(colors.blue, query[2]));
+        }
+
+        [[gnu::target("avx2")]] static __m256i closer(__m256i const best, __m256i const distance) {
+          return _mm256_cmpgt_epi32(best, distance);
+        }
+
+        [[gnu::target("avx2")]] static __m256i firstIndices() {
+          return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);  // NOLINT
+        }
+
+        [[gnu::target("avx2")]] static __m256i farthest() {
+          return _mm256_set1_epi32(std::numeric_limits<Value>::max());
+        }
+
+        [[gnu::target("avx2")]] static __m256i next(__m256i const indices) {
+          return _mm256_add_epi32(indices, _mm256_set1_epi32(static_cast<int>(COUNT)));
+        }
+    };
+
+    // Carriles de 64 bits: cuatro distancias por instrucción, para cualquier profundidad
+    struct WideLanes {
+        using Value                        = std::int64_t;
+        static constexpr std::size_t COUNT = 4;
+
+        [[gnu::target("avx2")]] static __m256i load(std::span<std::int32_t const> plane,
+                                                    std::size_t const first) {
+          std::int32_t const * samples = plane.subspan(first).data();
+          return _mm256_cvtepi32_epi64(
+              _mm_loadu_si128(reinterpret_cast<__m128i const *>(samples)));  // NOLINT
+        }
+
+        // mul_epi32 multiplica la mitad baja de cada carril, donde cabe la diferencia con signo
+        [[gnu::target("avx2")]] static __m256i square(__m256i const plane,
+                                                      std::int32_t const value) {
+          __m256i const delta = _mm256_sub_epi64(plane, _mm256_set1_epi64x(value));
+          return _mm256_mul_epi32(delta, delta);
+        }
+
+        [[gnu::target("avx2")]] static __m256i distance(LaneColors const & colors,
+                                                        Channels const & query) {
+          return _mm256_add_epi64(_mm256_add_epi64(square(colors.red, query[0]),
+                                                   square(colors.green, query[1])),
+                                  square(colors.blue, query[2]));
+        }
+
+        [[gnu::target("avx2")]] static __m256i closer(__m256i const best, __m256i const distance) {
+          return _mm256_cmpgt_epi64(best, distance);
+        }
+
+        [[gnu::target("avx2")]] static __m256i firstIndices() {
+          return _mm256_setr_epi64x(0, 1, 2, 3);  // NOLINT
+        }
+
+        [[gnu::target("avx2")]] static __m256i farthest() {
+          return _mm256_set1_epi64x(std::numeric_limits<Value>::max());
+        }
+
+        [[gnu::target("avx2")]] static __m256i next(__m256i const indices) {
+          return _mm256_add_epi64(indices, _mm256_set1_epi64x(static_cast<long long>(COUNT)));
+        }
+    };
+
+    template <typename Lanes>
+    [[gnu::target("avx2")]] Candidate reduceLanes(__m256i const distances, __m256i const indices) {
+      std::array<typename Lanes::Value, Lanes::COUNT> distanceLanes{};
+      std::array<typename Lanes::Value, Lanes::COUNT> indexLanes{};
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(distanceLanes.data()), distances);  // NOLINT
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(indexLanes.data()), indices);       // NOLINT
+      Candidate best = NO_CANDIDATE;
+      for (std::size_t lane = 0; lane < Lanes::COUNT; ++lane) {
+        keepCloser(best, {.distance = distanceLanes[lane],
+                          .index    = static_cast<std::uint32_t>(indexLanes[lane])});
+      }
+      return best;
+    }
+
+    // Recorre la paleta en bloques de Lanes::COUNT colores comparando cada bloque con todas las
+    // consultas. Cada carril se queda con su primer mínimo; devuelve la primera posición sin
+    // recorrer.
+    template <typename Lanes>
+    [[gnu::target("avx2")]] std::size_t scanAvx2(PalettePlanes const & palette,
+                                                 QueryBlock const & queries, BlockResult & best) {
+      std::array<LaneBest, QUERY_BLOCK> lanes{};
+      for (LaneBest & lane : lanes) { lane.distance = Lanes::farthest(); }
+      __m256i index     = Lanes::firstIndices();
+      std::size_t first = 0;
+      for (; first + Lanes::COUNT <= palette.red.size(); first += Lanes::COUNT) {
+        LaneColors const colors{.red   = Lanes::load(palette.red, first),
+                                .green = Lanes::load(palette.green, first),
+                                .blue  = Lanes::load(palette.blue, first)};
+        for (std::size_t query = 0; query < QUERY_BLOCK; ++query) {
+          __m256i const distance = Lanes::distance(colors, queries[query]);
+          __m256i const closer   = Lanes::closer(lanes[query].distance, distance);
+          lanes[query].distance  = _mm256_blendv_epi8(lanes[query].distance, distance, closer);
+          lanes[query].index     = _mm256_blendv_epi8(lanes[query].index, index, closer);
+        }
+        index = Lanes::next(index);
+      }
+      if (first == 0) { return 0; }
+      for (std::size_t query = 0; query < QUERY_BLOCK; ++query) {
+        best[query] = reduceLanes<Lanes>(lanes[query].distance, lanes[query].index);
+      }
+      return first;
+    }
+#endif
+
+    BlockResult nearestBlock(PalettePlanes const & palette, QueryBlock const & queries,
+                             std::int32_t const maxChannel) {
+      BlockResult best{};
+      best.fill(NO_CANDIDATE);
+      std::size_t scanned = 0;
+#if defined(__x86_64__) || defined(__i386__)
+      if (cpuHasAvx2()) {
+        scanned = maxChannel <= NARROW_CHANNEL_MAX
+                      ? scanAvx2<NarrowLanes>(palette, queries, best)
+                      : scanAvx2<WideLanes>(palette, queries, best);
+      }
+#endif
+      for (std::size_t query = 0; query < QUERY_BLOCK; ++query) {
+        scanScalar(palette, scanned, queries[query], best[query]);
+      }
+      return best;
+    }
+
+    unsigned gridCellBits(std::size_t const paletteSize) {
+      unsigned bits = MIN_CELL_BITS;
+      while (bits < MAX_CELL_BITS &&
+             (std::size_t{1} << (3 * bits)) * COLORS_PER_CELL < paletteSize) {
+        ++bits;
+      }
+      return bits;
+    }
+
+    // Celdas de 3x3x3 alrededor de la de `query` en una rejilla de celdas de ancho 1 << shift. Las
+    // consultas fuera de la rejilla se acercan a la última celda de cada eje.
+    struct CellBox {
+        Channels low;
+        Channels high;
+        unsigned shift;
+        std::int32_t cellsPerAxis;
+    };
+
+    CellBox cellBox(Channels const & query, unsigned const shift, std::int32_t const cellsPerAxis) {
+      CellBox box{.low = {}, .high = {}, .shift = shift, .cellsPerAxis = cellsPerAxis};
+      for (std::size_t axis = 0; axis < query.size(); ++axis) {
+        std::int32_t const cell = std::min(query[axis] >> shift, cellsPerAxis - 1);
+        box.low[axis]           = std::max(cell - 1, 0);
+        box.high[axis]          = std::min(cell + 1, cellsPerAxis - 1);
+      }
+      return box;
+    }
+
+    std::size_t cellIndex(Channels const & cell, std::int32_t const cellsPerAxis) {
+      auto const axis  = static_cast<std::size_t>(cellsPerAxis);
+      auto const red   = static_cast<std::size_t>(cell[0]);
+      auto const green = static_cast<std::size_t>(cell[1]);
+      auto const blue  = static_cast<std::size_t>(cell[2]);
+      return (((red * axis) + green) * axis) + blue;
+    }
+
+    template <typename Visit>
+    void forEachCell(CellBox const & box, Visit && visit) {
+      for (std::int32_t red = box.low[0]; red <= box.high[0]; ++red) {
+        for (std::int32_t green = box.low[1]; green <= box.high[1]; ++green) {
+          for (std::int32_t blue = box.low[2]; blue <= box.high[2]; ++blue) {
+            visit(cellIndex({red, green, blue}, box.cellsPerAxis));
+          }
+        }
+      }
+    }
+
+    // Cota inferior de la distancia entre `query` y cualquier color fuera de `box`; las caras en
+    // el borde de la rejilla no tienen nada detrás
+    std::int64_t distanceOutside(Channels const & query, CellBox const & box) {
+      std::int64_t nearest = std::numeric_limits<std::int64_t>::max();
+      for (std::size_t axis = 0; axis < query.size(); ++axis) {
+        if (box.low[axis] > 0) {
+          nearest = std::min<std::int64_t>(nearest, query[axis] - (box.low[axis] << box.shift) + 1);
+        }
+        if (box.high[axis] < box.cellsPerAxis - 1) {
+          nearest = std::min<std::int64_t>(nearest,
+                                           ((box.high[axis] + 1) << box.shift) - query[axis]);
+        }
+      }
+      return nearest;
+    }
+
+    // Exceso de distancia al cuadrado del candidato a `distance` frente al color más cercano, que
+    // está fuera de la caja (a `outside` como poco) o dentro, a no más de `spread` del
+    // representante de su celda (0 si se han mirado todos los colores de la caja)
+    std::int64_t excessBound(std::int64_t const distance, std::int64_t const outside,
+                             double const spread) {
+      auto const nearestInside = static_cast<std::int64_t>(
+          std::max(0.0, std::floor(std::sqrt(static_cast<double>(distance)) - spread)));
+      std::int64_t const nearest = spread == 0.0 ? distance : nearestInside * nearestInside;
+      if (outside == std::numeric_limits<std::int64_t>::max()) { return distance - nearest; }
+      return distance - std::min(nearest, outside * outside);
+    }
+
+    // Guarda en `best` el mayor de los dos valores sin bloquear
+    void storeMax(std::atomic<std::int64_t> & best, std::int64_t const value) {
+      std::int64_t current = best.load();
+      while (value > current && !best.compare_exchange_weak(current, value)) { }
+    }
+
+    bool preferLinearSearch(std::size_t const paletteSize) {
+#if defined(__x86_64__) || defined(__i386__)
+      return paletteSize <= LINEAR_SEARCH_MAX && cpuHasAvx2();
+#else
+      return false;
+#endif
+    }
+  }  // namespace
+
+  ColorTree::ColorTree(std::span<ColorTuple const> palette)
+    : points_(palette.size()), axes_(palette.size()) {
+    for (std::size_t index = 0; index < palette.size(); ++index) {
+      points_[index] = {.channels = channelsOf(palette[index]),
+                        .index    = static_cast<std::uint32_t>(index)};
+    }
+    build({.first = 0, .last = points_.size()});
+  }
+
+  // Cada nodo parte por la mediana del canal con más rango; la mediana queda en el centro del
+  // intervalo y su eje se guarda en la misma posición de `axes_`
+  void ColorTree::build(Range const range) {
+    if (range.last - range.first <= LEAF_SIZE) { return; }
+    auto const first = points_.begin() + static_cast<std::ptrdiff_t>(range.first);
+    auto const last  = points_.begin() + static_cast<std::ptrdiff_t>(range.last);
+
+    auto const byChannel = [](std::uint8_t const channel) {
+      return [channel](Point const & lhs, Point const & rhs) {
+        return lhs.channels[channel] < rhs.channels[channel];
+      };
+    };
+
+    std::uint8_t axis  = 0;
+    std::int32_t width = -1;
+    for (std::uint8_t channel = 0; channel < 3; ++channel) {
+      auto const [low, high] = std::minmax_element(first, last, byChannel(channel));
+      if (high->channels[channel] - low->channels[channel] > width) {
+        width = high->channels[channel] - low->channels[channel];
+        axis  = channel;
+      }
+    }
+
+    std::size_t const middle = range.first + ((range.last - range.first) / 2);
+    std::nth_element(first, points_.begin() + static_cast<std::ptrdiff_t>(middle), last,
+                     byChannel(axis));
+    axes_[middle] = axis;
+    build({.first = range.first, .last = middle});
+    build({.first = middle + 1, .last = range.last});
+  }
+
+  void ColorTree::search(Range const range, std::array<std::int32_t, 3> const & query,
+                         Best & best) const {
+    auto const visit = [&](Point const & point) {
+      std::int64_t const distance = distanceSquared(point.channels, query);
+      if (distance < best.distance || (distance == best.distance && point.index < best.index)) {
+        best = {.distance = distance, .index = point.index};
+      }
+    };
+    if (range.last - range.first <= LEAF_SIZE) {
+      for (std::size_t position = range.first; position < range.last; ++position) {
+        visit(points_[position]);
+      }
+      return;
+    }
+
+    std::size_t const middle = range.first + ((range.last - range.first) / 2);
+    visit(points_[middle]);
+    std::int64_t const delta = query[axes_[middle]] - points_[middle].channels[axes_[middle]];
+    Range const lower{.first = range.first, .last = middle};
+    Range const upper{.first = middle + 1, .last = range.last};
+    search(delta < 0 ? lower : upper, query, best);
+    // Con distancia igual puede haber un empate con menor posición, así que no se poda
+    if (delta * delta <= best.distance) { search(delta < 0 ? upper : lower, query, best); }
+  }
+
+  std::uint32_t ColorTree::nearest(ColorTuple const & color) const {
+    Best best{.distance = std::numeric_limits<std::int64_t>::max(),
+              .index    = std::numeric_limits<std::uint32_t>::max()};
+    search({.first = 0, .last = points_.size()}, channelsOf(color), best);
+    return best.index;
+  }
+
+  PlanarPalette::PlanarPalette(std::span<ColorTuple const> palette)
+    : red_(palette.size()), green_(palette.size()), blue_(palette.size()) {
+    for (std::size_t index = 0; index < palette.size(); ++index) {
+      Channels const color = channelsOf(palette[index]);
+      red_[index]          = color[0];
+      green_[index]        = color[1];
+      blue_[index]         = color[2];
+      maxChannel_          = std::max({maxChannel_, color[0], color[1], color[2]});
+    }
+  }
+
+  ColorGrid::ColorGrid(std::span<ColorTuple const> palette) {
+    std::int32_t maxChannel = 0;
+    for (auto const & color : palette) {
+      Channels const channels = channelsOf(color);
+      maxChannel              = std::max({maxChannel, channels[0], channels[1], channels[2]});
+    }
+    auto const channelBits =
+        static_cast<unsigned>(std::bit_width(static_cast<unsigned>(maxChannel)));
+    unsigned const cellBits = gridCellBits(palette.size());
+    unsigned const shift    = channelBits > cellBits ? channelBits - cellBits : 0;
+    Level fine{.shift = shift, .cellsPerAxis = (maxChannel >> shift) + 1, .representatives = {}};
+
+    // Ordenación por cuentas: cada color va a su celda manteniendo el orden de la paleta
+    auto const axis = static_cast<std::size_t>(fine.cellsPerAxis);
+    offsets_.assign((axis * axis * axis) + 1, 0);
+    std::vector<std::size_t> cellOfColor(palette.size());
+    for (std::size_t index = 0; index < palette.size(); ++index) {
+      Channels cell = channelsOf(palette[index]);
+      for (auto & channel : cell) { channel >>= fine.shift; }
+      cellOfColor[index] = cellIndex(cell, fine.cellsPerAxis);
+      ++offsets_[cellOfColor[index] + 1];
+    }
+    std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+    entries_.resize(palette.size());
+    std::vector<std::uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (std::size_t index = 0; index < palette.size(); ++index) {
+      entries_[next[cellOfColor[index]]++] = {.channels = channelsOf(palette[index]),
+                                              .index    = static_cast<std::uint32_t>(index)};
+    }
+    levels_.push_back(std::move(fine));
+    buildCoarseLevels();
+  }
+
+  // Cada nivel dobla el ancho de celda del anterior hasta que la vecindad de cualquier celda
+  // cubre la rejilla entera (dos celdas por eje), así que el último nivel siempre encuentra color
+  void ColorGrid::buildCoarseLevels() {
+    while (levels_.back().cellsPerAxis > 2) {
+      Level const & finer = levels_.back();
+      Level coarse{.shift           = finer.shift + 1,
+                   .cellsPerAxis    = ((finer.cellsPerAxis - 1) >> 1) + 1,
+                   .representatives = {}};
+      auto const axis = static_cast<std::size_t>(coarse.cellsPerAxis);
+      coarse.representatives.assign(axis * axis * axis, NO_CANDIDATE.index);
+      CellBox const all{.low          = {0, 0, 0},
+                        .high         = {finer.cellsPerAxis - 1, finer.cellsPerAxis - 1,
+                                         finer.cellsPerAxis - 1},
+                        .shift        = finer.shift,
+                        .cellsPerAxis = finer.cellsPerAxis};
+      // forEachCell recorre las celdas en orden (rojo, verde, azul), así que la posición de cada
+      // una en la rejilla sale de su índice
+      forEachCell(all, [&](std::size_t const cell) {
+        std::uint32_t const entry = firstEntry(finer, cell);
+        if (entry == NO_CANDIDATE.index) { return; }
+        auto const finerAxis = static_cast<std::size_t>(finer.cellsPerAxis);
+        Channels const parent{static_cast<std::int32_t>(cell / (finerAxis * finerAxis)) >> 1,
+                              static_cast<std::int32_t>((cell / finerAxis) % finerAxis) >> 1,
+                              static_cast<std::int32_t>(cell % finerAxis) >> 1};
+        std::uint32_t & slot = coarse.representatives[cellIndex(parent, coarse.cellsPerAxis)];
+        if (slot == NO_CANDIDATE.index || entries_[entry].index < entries_[slot].index) {
+          slot = entry;
+        }
+      });
+      levels_.push_back(std::move(coarse));
+    }
+  }
+
+  std::uint32_t ColorGrid::firstEntry(Level const & level, std::size_t const cell) const {
+    if (!level.representatives.empty()) { return level.representatives[cell]; }
+    return offsets_[cell] < offsets_[cell + 1] ? offsets_[cell] : NO_CANDIDATE.index;
+  }
+
+  // Un color de la vecindad está, como mucho, a la diagonal de su celda del representante
+  std::optional<GridMatch> ColorGrid::searchCoarse(Level const & level,
+                                                   Channels const & query) const {
+    CellBox const box = cellBox(query, level.shift, level.cellsPerAxis);
+    Candidate best    = NO_CANDIDATE;
+    forEachCell(box, [&](std::size_t const cell) {
+      std::uint32_t const entry = level.representatives[cell];
+      if (entry == NO_CANDIDATE.index) { return; }
+      keepCloser(best, {.distance = distanceSquared(entries_[entry].channels, query),
+                        .index    = entries_[entry].index});
+    });
+    if (best.index == NO_CANDIDATE.index) { return std::nullopt; }
+    double const spread =
+        std::ceil(std::numbers::sqrt3 * static_cast<double>(std::int64_t{1} << level.shift));
+    return GridMatch{.index = best.index,
+                     .error = excessBound(best.distance, distanceOutside(query, box), spread)};
+  }
+
+  GridMatch ColorGrid::nearest(ColorTuple const & color) const {
+    Channels const query = channelsOf(color);
+    Level const & fine   = levels_.front();
+    CellBox const box    = cellBox(query, fine.shift, fine.cellsPerAxis);
+    Candidate best       = NO_CANDIDATE;
+    forEachCell(box, [&](std::size_t const cell) {
+      for (std::size_t entry = offsets_[cell]; entry < offsets_[cell + 1]; ++entry) {
+        keepCloser(best, {.distance = distanceSquared(entries_[entry].channels, query),
+                          .index    = entries_[entry].index});
+      }
+    });
+    if (best.index != NO_CANDIDATE.index) {
+      return {.index = best.index,
+              .error = excessBound(best.distance, distanceOutside(query, box), 0.0)};
+    }
+    for (auto level = std::next(levels_.begin()); level != levels_.end(); ++level) {
+      if (auto const match = searchCoarse(*level, query)) { return *match; }
+    }
+    return {.index = NO_CANDIDATE.index, .error = 0};
+  }
+
+  // Las consultas se agrupan de QUERY_BLOCK en QUERY_BLOCK; el último bloque se completa
+  // repitiendo su última consulta y esos resultados se descartan
+  void PlanarPalette::nearest(std::span<ColorTuple const> queries,
+                              std::span<std::uint32_t> indices) const {
+    PalettePlanes const palette{.red = red_, .green = green_, .blue = blue_};
+    for (std::size_t first = 0; first < queries.size(); first += QUERY_BLOCK) {
+      QueryBlock block{};
+      std::int32_t maxChannel = maxChannel_;
+      for (std::size_t query = 0; query < QUERY_BLOCK; ++query) {
+        block[query] = channelsOf(queries[std::min(first + query, queries.size() - 1)]);
+        maxChannel   = std::max({maxChannel, block[query][0], block[query][1], block[query][2]});
+      }
+      BlockResult const best = nearestBlock(palette, block, maxChannel);
+      for (std::size_t query = 0; query < QUERY_BLOCK && first + query < queries.size(); ++query) {
+        indices[first + query] = best[query].index;
+      }
+    }
+  }
+
+  ApproximateColors approximateNearestColors(std::span<ColorTuple const> palette,
+                                             std::span<ColorTuple const> queries) {
+    ApproximateColors result{.colors = std::vector<ColorTuple>(queries.size()), .maxError = 0};
+    if (palette.empty()) { return result; }
+    ColorGrid const grid(palette);
+    std::atomic<std::int64_t> maxError{0};
+    threadpool::parallelFor(
+        0, queries.size(),
+        [&](std::size_t const first, std::size_t const last) {
+          std::int64_t error = 0;
+          for (std::size_t query = first; query < last; ++query) {
+            GridMatch const match = grid.nearest(queries[query]);
+            result.colors[query]  = palette[match.index];
+            error                 = std::max(error, match.error);
+          }
+          storeMax(maxError, error);
+        },
+        QUERY_GRAIN);
+    result.maxError = maxError;
+    return result;
+  }
+
+  std::vector<ColorTuple> nearestColors(std::span<ColorTuple const> palette,
+                                        std::span<ColorTuple const> queries) {
+    std::vector<ColorTuple> nearest(queries.size());
+    if (palette.empty()) { return nearest; }
+    std::vector<std::uint32_t> indices(queries.size());
+    if (preferLinearSearch(palette.size())) {
+      PlanarPalette const planar(palette);
+      threadpool::parallelFor(
+          0, queries.size(),
+          [&](std::size_t const first, std::size_t const last) {
+            planar.nearest(queries.subspan(first, last - first),
+                           std::span(indices).subspan(first, last - first));
+          },
+          QUERY_GRAIN);
+    } else {
+      ColorTree const tree(palette);
+      threadpool::parallelFor(
+          0, queries.size(),
+          [&](std::size_t const first, std::size_t const last) {
+            for (std::size_t query = first; query < last; ++query) {
+              indices[query] = tree.nearest(queries[query]);
+            }
+          },
+          QUERY_GRAIN);
+    }
+    for (std::size_t query = 0; query < queries.size(); ++query) {
+      nearest[query] = palette[indices[query]];
+    }
+    return nearest;
+  }
+}  // namespace image
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <common/colormap.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Índice estático (árbol k-d implícito) sobre una paleta de colores. Las búsquedas son exactas
+  // por distancia euclídea al cuadrado y, en caso de empate, devuelven la menor posición de la
+  // paleta, igual que un recorrido lineal que solo se queda con distancias estrictamente menores.
+  class ColorTree {
+    public:
+      explicit ColorTree(std::span<ColorTuple const> palette);
+
+      // Posición en la paleta del color más cercano; la paleta no puede estar vacía
+      [[nodiscard]] std::uint32_t nearest(ColorTuple const & color) const;
+
+    private:
+      struct Point {
+          std::array<std::int32_t, 3> channels;
+          std::uint32_t index;
+      };
+
+      struct Range {
+          std::size_t first;
+          std::size_t last;
+      };
+
+      struct Best {
+          std::int64_t distance;
+          std::uint32_t index;
+      };
+
+      void build(Range range);
+      void search(Range range, std::array<std::int32_t, 3> const & query, Best & best) const;
+
+      std::vector<Point> points_;
+      std::vector<std::uint8_t> axes_;
+  };
+
+  // Paleta en tres planos de enteros para búsquedas exhaustivas. Con AVX2 compara cada bloque de
+  // la paleta con varias consultas a la vez, de modo que la paleta se lee una vez por bloque de
+  // consultas. Resuelve los empates igual que ColorTree.
+  class PlanarPalette {
+    public:
+      explicit PlanarPalette(std::span<ColorTuple const> palette);
+
+      // Escribe en `indices` la posición del color más cercano a cada consulta; la paleta no
+      // puede estar vacía
+      void nearest(std::span<ColorTuple const> queries, std::span<std::uint32_t> indices) const;
+
+    private:
+      std::vector<std::int32_t> red_;
+      std::vector<std::int32_t> green_;
+      std::vector<std::int32_t> blue_;
+      std::int32_t maxChannel_ = 0;
+  };
+
+  // Resultado de buscar en ColorGrid: posición en la paleta del color elegido y cota del exceso de
+  // distancia al cuadrado frente al color más cercano (0 si la búsqueda es exacta)
+  struct GridMatch {
+      std::uint32_t index;
+      std::int64_t error;
+  };
+
+  // Rejilla RGB gruesa sobre una paleta para búsquedas aproximadas: cada consulta mira su celda y
+  // las 26 vecinas. Si están vacías, repite la búsqueda en niveles de celdas cada vez más grandes
+  // en los que cada celda guarda un solo color representativo. La paleta no puede estar vacía.
+  class ColorGrid {
+    public:
+      explicit ColorGrid(std::span<ColorTuple const> palette);
+
+      [[nodiscard]] GridMatch nearest(ColorTuple const & color) const;
+
+    private:
+      struct Entry {
+          std::array<std::int32_t, 3> channels;
+          std::uint32_t index;
+      };
+
+      // Nivel de la rejilla: ancho de celda (1 << shift) y, en los niveles gruesos, la posición en
+      // `entries_` del representante de cada celda (el de menor posición en la paleta)
+      struct Level {
+          unsigned shift;
+          std::int32_t cellsPerAxis;
+          std::vector<std::uint32_t> representatives;
+      };
+
+      void buildCoarseLevels();
+      // Primer color de una celda del nivel, o la marca de celda vacía
+      [[nodiscard]] std::uint32_t firstEntry(Level const & level, std::size_t cell) const;
+      [[nodiscard]] std::optional<GridMatch>
+          searchCoarse(Level const & level, std::array<std::int32_t, 3> const & query) const;
+
+      // Colores ordenados por celda del nivel fino; los de la celda c están en
+      // [offsets_[c], offsets_[c + 1])
+      std::vector<std::uint32_t> offsets_;
+      std::vector<Entry> entries_;
+      std::vector<Level> levels_;
+  };
+
+  struct ApproximateColors {
+      std::vector<ColorTuple> colors;
+      std::int64_t maxError = 0;
+  };
+
+  // Versión aproximada de nearestColors con ColorGrid; `maxError` es la mayor cota de exceso de
+  // distancia al cuadrado entre todas las consultas. Con la paleta vacía devuelve el negro.
+  [[nodiscard]] ApproximateColors approximateNearestColors(std::span<ColorTuple const> palette,
+                                                           std::span<ColorTuple const> queries);
+
+  // Color de la paleta más cercano a cada consulta, buscando en paralelo. Las paletas pequeñas se
+  // recorren enteras con PlanarPalette si la CPU tiene AVX2; las grandes se indexan con ColorTree.
+  // Con la paleta vacía todas las consultas devuelven el negro.
+  [[nodiscard]] std::vector<ColorTuple> nearestColors(std::span<ColorTuple const> palette,
+                                                      std::span<ColorTuple const> queries);
+}  // namespace image
@@ -0,0 +1,431 @@
+#include <algorithm>
+#include <common/bitpack.hpp>
+#include <common/colorindex.hpp>
+#include <common/colorsearch.hpp>
+#include <common/colorstream.hpp>
+#include <common/histogram.hpp>
+#include <common/pixelio.hpp>
+#include <common/replacement.hpp>
+#include <common/rowstream.hpp>
+#include <common/spill.hpp>
+#include <common/threadpool.hpp>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace image {
+  namespace {
+    // Las bandas no pasan de este número de píxeles para que countColors y ColorIndexTable usen
+    // sus tablas hash, que crecen con los colores de la banda, y no los arrays de 2^24 entradas
+    constexpr std::size_t MAX_BAND_PIXELS = std::size_t{1} << 19;
+    // Cota por píxel de las tablas con que se cuentan los colores de una banda y de sus registros
+    constexpr std::size_t COLOR_BYTES_PER_PIXEL = 64;
+    // Cotas por color: búsqueda y sustitución de un color eliminado, paleta de búsqueda de un
+    // color conservado y tabla hash de índices de compress
+    constexpr std::size_t REMOVED_BYTES_PER_COLOR = 96;
+    constexpr std::size_t KEPT_BYTES_PER_COLOR    = 48;
+    constexpr std::size_t INDEX_BYTES_PER_COLOR   = 48;
+    // Bytes de índices por píxel en la segunda pasada de compress
+    constexpr std::size_t ENCODE_BYTES_PER_PIXEL = 4;
+
+    constexpr std::size_t MAX_COLOR_TABLE_SIZE = std::size_t{1} << 32;
+    // Índices de C6v2 que ocupan un número entero de bytes
+    constexpr std::size_t PACK_GROUP  = 8;
+    constexpr unsigned BYTE_BITS      = 8;
+    constexpr std::uint32_t BYTE_MASK = 0xFF;
+    constexpr std::size_t ENCODE_GRAIN = std::size_t{1} << 16;
+
+    PixelChannels bandChannels(std::span<unsigned short const> rows) {
+      return {.channels = {rows, rows.subspan(1), rows.subspan(2)},
+              .stride   = CHANNELS,
+              .count    = rows.size() / CHANNELS};
+    }
+
+    WritablePixelChannels writableBandChannels(std::span<unsigned short> rows) {
+      return {.channels = {rows, rows.subspan(1), rows.subspan(2)},
+              .stride   = CHANNELS,
+              .count    = rows.size() / CHANNELS};
+    }
+
+    void reportTableLimit(std::size_t const memoryLimit, std::size_t const tableBytes) {
+      std::cerr << "Memory limit too small: " << memoryLimit << " bytes, the color tables need "
+                << tableBytes << " bytes\n";
+    }
+
+    // Filas por banda con `pixelCost` bytes por píxel además de las muestras y los bytes leídos
+    std::size_t bandRows(RowReader const & reader, std::size_t const pixelCost,
+                         std::size_t const memoryLimit) {
+      std::size_t const width   = reader.header().getWidth();
+      std::size_t const rowCost = (width * CHANNELS * sizeof(unsigned short)) + reader.rowBytes() +
+                                  (width * pixelCost);
+      std::size_t const rows = bandRowCount(reader.header(), rowCost, memoryLimit);
+      return std::min(rows, std::max<std::size_t>(1, MAX_BAND_PIXELS / std::max<std::size_t>(
+                                                                            1, width)));
+    }
+
+    // Lee la imagen en bandas de `rows` filas entrelazadas; `visit` recibe también la posición
+    // del primer píxel de la banda
+    using BandVisitor = std::function<bool(std::span<unsigned short> band, std::size_t firstPixel)>;
+
+    bool forEachBand(RowReader & reader, std::size_t const rows, BandVisitor const & visit) {
+      Image const & header      = reader.header();
+      std::size_t const samples = header.getWidth() * CHANNELS;
+      std::vector<unsigned short> band(rows * samples);
+      for (std::size_t first = 0; first < header.getHeight(); first += rows) {
+        std::size_t const count               = std::min(rows, header.getHeight() - first);
+        std::span<unsigned short> const slice = std::span(band).first(count * samples);
+        if (!reader.readRows(slice, RowLayout::Interleaved) ||
+            !visit(slice, first * header.getWidth())) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Registros de una banda ordenados por color
+    using BandRecords = std::function<std::vector<ColorRecord>(
+        PixelChannels const & pixels, std::size_t firstPixel, unsigned short maxColorValue)>;
+
+    // Primera pasada: añade a `runs` los registros de cada banda
+    bool collectRuns(std::string const & inputPath, std::size_t const memoryLimit,
+                     BandRecords const & bandRecords, SpilledColorRuns & runs, Image & header) {
+      RowReader reader;
+      if (!reader.open(inputPath)) { return false; }
+      header                 = reader.header();
+      std::size_t const rows = bandRows(reader, COLOR_BYTES_PER_PIXEL, memoryLimit);
+      if (rows == 0 && header.getHeight() > 0) { return false; }
+      return forEachBand(reader, rows,
+                         [&](std::span<unsigned short> band, std::size_t const firstPixel) {
+                           return runs.add(bandRecords(bandChannels(band), firstPixel,
+                                                       header.getMaxColorValue()));
+                         });
+    }
+
+    std::vector<ColorRecord> bandFrequencies(PixelChannels const & pixels,
+                                             std::size_t const /*firstPixel*/,
+                                             unsigned short const maxColorValue) {
+      std::vector<ColorFrequency> const histogram = countColors(pixels, maxColorValue);
+      std::vector<ColorRecord> records(histogram.size());
+      std::ranges::transform(histogram, records.begin(), [](ColorFrequency const & frequency) {
+        return ColorRecord{.color = frequency.color, .value = frequency.count};
+      });
+      return records;
+    }
+
+    // Clave de primera aparición de cada color de la banda: `firstPixel` más el índice del color en
+    // ColorIndexTable, que sigue el orden de primera aparición dentro de la banda. No es la
+    // posición del píxel, pero el índice es menor que el número de píxeles de la banda, así que
+    // las claves ordenan los colores de todas las bandas igual que sus primeras posiciones
+    std::vector<ColorRecord> bandFirstPixels(PixelChannels const & pixels,
+                                             std::size_t const firstPixel,
+                                             unsigned short const maxColorValue) {
+      ColorIndexTable const table(pixels, maxColorValue);
+      std::vector<ColorRecord> records(table.size());
+      for (std::size_t index = 0; index < records.size(); ++index) {
+        records[index] = {.color = table.colors()[index], .value = firstPixel + index};
+      }
+      std::ranges::sort(records, {}, &ColorRecord::color);
+      return records;
+    }
+
+    // Frecuencia del n-ésimo color menos frecuente y cuántos colores con esa frecuencia se
+    // eliminan, como en splitLeastFrequent
+    struct CutThreshold {
+        std::uint64_t count;
+        std::size_t ties;
+    };
+
+    // El umbral sale del número de colores de cada frecuencia, que tiene pocas entradas: como
+    // mucho unas sqrt(2 * píxeles) frecuencias distintas. Reduce `n` al número de colores.
+    bool cutThreshold(SpilledColorRuns & runs, std::size_t & n, CutThreshold & threshold) {
+      std::map<std::uint64_t, std::size_t> colorsByCount;
+      std::size_t colors = 0;
+      if (!runs.merge([&](ColorRecord const & record) {
+            ++colorsByCount[record.value];
+            ++colors;
+          })) {
+        return false;
+      }
+      n         = std::min(n, colors);
+      threshold = {.count = 0, .ties = 0};
+      std::size_t below = 0;
+      for (auto const & [count, number] : colorsByCount) {
+        if (n == 0) { break; }
+        if (below + number >= n) {
+          threshold = {.count = count, .ties = n - below};
+          break;
+        }
+        below += number;
+      }
+      return true;
+    }
+
+    // Los colores llegan en orden de color, así que los empates se eliminan del menor al mayor
+    bool removes(ColorRecord const & record, CutThreshold const & threshold, std::size_t & ties) {
+      if (record.value == threshold.count) { return ties++ < threshold.ties; }
+      return record.value < threshold.count;
+    }
+
+    std::int64_t squaredDistance(ColorTuple const & first, ColorTuple const & second) {
+      auto const [red1, green1, blue1] = first;
+      auto const [red2, green2, blue2] = second;
+      std::int64_t const deltaRed      = std::int64_t{red1} - red2;
+      std::int64_t const deltaGreen    = std::int64_t{green1} - green2;
+      std::int64_t const deltaBlue     = std::int64_t{blue1} - blue2;
+      return (deltaRed * deltaRed) + (deltaGreen * deltaGreen) + (deltaBlue * deltaBlue);
+    }
+
+    // Sustituto de cada color eliminado. Los conservados se recorren por bloques de
+    // `chunkColors` en orden de color y un bloque posterior solo gana con una distancia
+    // estrictamente menor, así que los empates se resuelven por el menor color igual que
+    // nearestColors con la paleta completa.
+    bool nearestKept(SpilledColorRuns & runs, CutThreshold const & threshold,
+                     std::size_t const chunkColors, std::span<ColorTuple const> removed,
+                     std::vector<ColorTuple> & nearest) {
+      nearest.assign(removed.size(), ColorTuple{});
+      std::vector<std::int64_t> distances(removed.size(), std::numeric_limits<std::int64_t>::max());
+      std::vector<ColorTuple> chunk;
+      chunk.reserve(chunkColors);
+      auto const search = [&] {
+        std::vector<ColorTuple> const found = nearestColors(chunk, removed);
+        for (std::size_t query = 0; query < removed.size(); ++query) {
+          std::int64_t const distance = squaredDistance(found[query], removed[query]);
+          if (distance < distances[query]) {
+            distances[query] = distance;
+            nearest[query]   = found[query];
+          }
+        }
+        chunk.clear();
+      };
+
+      std::size_t ties = 0;
+      bool const merged = runs.merge([&](ColorRecord const & record) {
+        if (removes(record, threshold, ties)) { return; }
+        chunk.push_back(unpackColor(record.color));
+        if (chunk.size() == chunkColors) { search(); }
+      });
+      if (!chunk.empty()) { search(); }
+      return merged;
+    }
+
+    // Colores en orden de primera aparición: un segundo histograma externo con la clave de
+    // bandFirstPixels como clave y el color como valor, al que los colores llegan en lotes
+    // ordenados
+    bool sortByFirstPixel(SpilledColorRuns & runs, std::size_t const batchRecords,
+                          SpilledColorRuns & byFirst) {
+      std::vector<ColorRecord> batch;
+      batch.reserve(batchRecords);
+      bool added       = true;
+      auto const flush = [&] {
+        std::ranges::sort(batch, {}, &ColorRecord::color);
+        added = byFirst.add(batch) && added;
+        batch.clear();
+      };
+      bool const merged = runs.merge([&](ColorRecord const & record) {
+        batch.push_back({.color = record.value, .value = record.color});
+        if (batch.size() == batchRecords) { flush(); }
+      });
+      flush();
+      return merged && added;
+    }
+
+    // Los índices de C6 (en little endian) y los de C6v2 son campos de bits consecutivos, así que
+    // los dos formatos se escriben con un OR de cada índice sobre bytes a cero
+    void orIndex(std::span<unsigned char> bytes, std::size_t const bitOffset,
+                 std::uint32_t const index) {
+      std::uint64_t value = std::uint64_t{index} << (bitOffset % BYTE_BITS);
+      for (std::size_t byte = bitOffset / BYTE_BITS; value != 0; ++byte) {
+        bytes[byte] |= static_cast<unsigned char>(value & BYTE_MASK);
+        value >>= BYTE_BITS;
+      }
+    }
+
+    // Flujo de índices del fichero de salida, que empieza en `start`
+    struct IndexStream {
+        std::fstream & file;
+        std::streamoff start;
+        unsigned bitsPerIndex;
+    };
+
+    // Segunda pasada para una parte de la tabla: lee los bytes de índices de cada banda, añade
+    // los de los píxeles cuyo color está en `indices` y los vuelve a escribir. Cada grupo de 8
+    // píxeles de la imagen ocupa bytes completos, así que los hilos reparten grupos.
+    bool writeIndexPart(std::string const & inputPath, IndexStream const & stream,
+                        FlatColorMap<std::uint32_t> const & indices, std::size_t const bandLimit) {
+      RowReader reader;
+      if (!reader.open(inputPath)) { return false; }
+      std::size_t const rows = bandRows(reader, ENCODE_BYTES_PER_PIXEL, bandLimit);
+      if (rows == 0 && reader.header().getHeight() > 0) { return false; }
+
+      unsigned const bits = stream.bitsPerIndex;
+      std::vector<unsigned char> bytes;
+      return forEachBand(reader, rows, [&](std::span<unsigned short> band,
+                                           std::size_t const firstPixel) {
+        PixelChannels const pixels = bandChannels(band);
+        std::size_t const end       = firstPixel + pixels.count;
+        std::size_t const firstByte = firstPixel * bits / BYTE_BITS;
+        bytes.resize(packedByteSize(end, bits) - firstByte);
+        auto const offset = stream.start + static_cast<std::streamoff>(firstByte);
+        stream.file.seekg(offset);
+        stream.file.read(reinterpret_cast<char *>(bytes.data()),  // NOLINT
+                         static_cast<std::streamsize>(bytes.size()));
+
+        std::span<unsigned char> const region(bytes);
+        threadpool::parallelFor(
+            firstPixel / PACK_GROUP, (end + PACK_GROUP - 1) / PACK_GROUP,
+            [&](std::size_t const firstGroup, std::size_t const lastGroup) {
+              std::size_t const begin = std::max(firstPixel, firstGroup * PACK_GROUP);
+              std::size_t const stop  = std::min(end, lastGroup * PACK_GROUP);
+              for (std::size_t pixel = begin; pixel < stop; ++pixel) {
+                if (auto const * index = indices.get(pixels.colorAt(pixel - firstPixel))) {
+                  orIndex(region, (pixel * bits) - (firstByte * BYTE_BITS), *index);
+                }
+              }
+            },
+            ENCODE_GRAIN / PACK_GROUP);
+        stream.file.seekp(offset);
+        stream.file.write(reinterpret_cast<char const *>(bytes.data()),  // NOLINT
+                          static_cast<std::streamsize>(bytes.size()));
+        return stream.file.good();
+      });
+    }
+  }  // namespace
+
+  bool streamCutFreq(std::string const & inputPath, std::string const & outputPath, std::size_t n,
+                     std::size_t const memoryLimit) {
+    std::size_t const halfLimit = memoryLimit / 2;
+    SpilledColorRuns runs(memoryLimit - halfLimit, RecordCombine::Sum);
+    Image header;
+    if (!collectRuns(inputPath, halfLimit, bandFrequencies, runs, header)) { return false; }
+
+    CutThreshold threshold{};
+    if (!cutThreshold(runs, n, threshold)) { return false; }
+    std::size_t const removedBytes = n * REMOVED_BYTES_PER_COLOR;
+    if (removedBytes > halfLimit) {
+      reportTableLimit(memoryLimit, removedBytes);
+      return false;
+    }
+
+    std::vector<ColorTuple> removed;
+    removed.reserve(n);
+    std::size_t ties = 0;
+    if (!runs.merge([&](ColorRecord const & record) {
+          if (removes(record, threshold, ties)) { removed.push_back(unpackColor(record.color)); }
+        })) {
+      return false;
+    }
+    std::vector<ColorTuple> nearest;
+    std::size_t const chunkColors =
+        std::max<std::size_t>(1, (halfLimit - removedBytes) / KEPT_BYTES_PER_COLOR);
+    if (!removed.empty() && !nearestKept(runs, threshold, chunkColors, removed, nearest)) {
+      return false;
+    }
+    ReplacementTable const replacements = replacementTable(removed, nearest);
+    removed = {};
+    nearest = {};
+
+    // Segunda pasada: cada banda se sustituye y se escribe
+    RowReader reader;
+    if (!reader.open(inputPath)) { return false; }
+    std::size_t const rows = bandRows(
+        reader, CHANNELS * bytesPerSample(header.getMaxColorValue()), halfLimit);
+    if (rows == 0 && header.getHeight() > 0) { return false; }
+    RowWriter writer;
+    if (!writer.open(outputPath, header)) { return false; }
+    return forEachBand(reader, rows, [&](std::span<unsigned short> band, std::size_t) {
+      replacements.apply(writableBandChannels(band));
+      return writer.writeRows(band, RowLayout::Interleaved);
+    });
+  }
+
+  bool streamCompress(std::string const & inputPath, std::string const & outputPath,
+                      CompressFormat const format, std::size_t const memoryLimit) {
+    // La mitad del límite es para las bandas; cada histograma externo y cada parte de la tabla de
+    // índices se queda con una cuarta parte
+    std::size_t const bandLimit = memoryLimit / 2;
+    std::size_t const runLimit  = memoryLimit / 4;
+    SpilledColorRuns runs(runLimit, RecordCombine::Min);
+    Image header;
+    if (!collectRuns(inputPath, bandLimit, bandFirstPixels, runs, header)) { return false; }
+
+    std::size_t colors = 0;
+    if (!runs.merge([&colors](ColorRecord const &) { ++colors; })) { return false; }
+    if (colors > MAX_COLOR_TABLE_SIZE) {
+      std::cerr << "Color table exceeds 2^32 unique colors.\n";
+      return false;
+    }
+    SpilledColorRuns byFirst(runLimit, RecordCombine::Min);
+    std::size_t const batchRecords = std::max<std::size_t>(1, runLimit / (2 * sizeof(ColorRecord)));
+    if (!sortByFirstPixel(runs, batchRecords, byFirst)) { return false; }
+
+    // Cabecera y tabla de colores, escrita por bloques en orden de primera aparición
+    std::streamoff indexStart = 0;
+    {
+      std::ofstream file(outputPath, std::ios::binary);
+      if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << outputPath << '\n';
+        return false;
+      }
+      if (!header.writeHeaderCompress(file, colors, format)) { return false; }
+      std::vector<PackedColor> table;
+      table.reserve(batchRecords);
+      bool written     = true;
+      auto const flush = [&] {
+        written = writeCompressColorTable(file, table, header.getMaxColorValue()) && written;
+        table.clear();
+      };
+      if (!byFirst.merge([&](ColorRecord const & record) {
+            table.push_back(record.value);
+            if (table.size() == batchRecords) { flush(); }
+          })) {
+        return false;
+      }
+      flush();
+      if (!written) { return false; }
+      indexStart = file.tellp();
+    }
+
+    // Flujo de índices a cero, que cada parte de la tabla completa con OR
+    std::size_t const pixelCount = header.getWidth() * header.getHeight();
+    unsigned const bitsPerIndex  = format == CompressFormat::BitPacked
+                                       ? indexBitWidth(colors)
+                                       : static_cast<unsigned>(indexByteSize(colors) * BYTE_BITS);
+    std::size_t const indexBytes = packedByteSize(pixelCount, bitsPerIndex);
+    std::error_code error;
+    std::filesystem::resize_file(outputPath, static_cast<std::size_t>(indexStart) + indexBytes,
+                                 error);
+    if (error) {
+      std::cerr << "Failed to write file: " << outputPath << '\n';
+      return false;
+    }
+    if (indexBytes == 0) { return true; }
+
+    std::fstream file(outputPath, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open file: " << outputPath << '\n';
+      return false;
+    }
+    std::size_t const partColors = std::max<std::size_t>(1, runLimit / INDEX_BYTES_PER_COLOR);
+    for (std::size_t first = 0; first < colors; first += partColors) {
+      std::size_t const last = std::min(colors, first + partColors);
+      FlatColorMap<std::uint32_t> indices(last - first);
+      std::size_t index = 0;
+      if (!byFirst.merge([&](ColorRecord const & record) {
+            if (index >= first && index < last) {
+              indices[record.value] = static_cast<std::uint32_t>(index);
+            }
+            ++index;
+          })) {
+        return false;
+      }
+      IndexStream const stream{.file = file, .start = indexStart, .bitsPerIndex = bitsPerIndex};
+      if (!writeIndexPart(inputPath, stream, indices, bandLimit)) { return false; }
+    }
+    return true;
+  }
+}  // namespace image
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <common/image.hpp>
+#include <cstddef>
+#include <string>
+
+namespace image {
+  // cutfreq y compress fuera de memoria para imágenes cuyo histograma no cabe en RAM. Una primera
+  // pasada por bandas de filas cuenta (o descubre) los colores de cada banda y los acumula en
+  // runs ordenados por color que se vuelcan a ficheros temporales (SpilledColorRuns). Los runs se
+  // fusionan y una segunda pasada por bandas aplica las sustituciones o escribe el flujo de
+  // índices. La mitad de `memoryLimit` es para las bandas; el resultado es el mismo fichero que
+  // escribe la versión en memoria.
+
+  // La búsqueda de sustitutos recorre los colores conservados por bloques que caben en el límite;
+  // los `n` colores eliminados y sus sustitutos sí tienen que caber en memoria.
+  [[nodiscard]] bool streamCutFreq(std::string const & inputPath, std::string const & outputPath,
+                                   std::size_t n, std::size_t memoryLimit);
+
+  // La tabla de colores se ordena por primera aparición con otro histograma externo. Si la tabla
+  // hash de índices no cabe en el límite, la segunda pasada se repite por partes de la tabla y
+  // cada una completa con OR los índices de sus colores en el fichero de salida.
+  [[nodiscard]] bool streamCompress(std::string const & inputPath, std::string const & outputPath,
+                                    CompressFormat format, std::size_t memoryLimit);
+}  // namespace image
@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <common/bitpack.hpp>
+#include <common/colorindex.hpp>
+#include <common/compressed.hpp>
+#include <common/cpu.hpp>
+#include <common/histogram.hpp>
+#include <common/pixelio.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace image {
+  namespace {
+    // Píxeles por bloque de trabajo; múltiplo de 8 para que los bloques empaquetados empiecen en
+    // un byte
+    constexpr std::size_t DECODE_BLOCK = std::size_t{1} << 14;
+
+    constexpr unsigned BYTE_BITS                 = 8;
+    constexpr std::uint64_t MAX_COLOR_TABLE_SIZE = std::uint64_t{1} << 32;
+
+    // a * b, o nullopt si el producto no cabe en std::size_t
+    std::optional<std::size_t> checkedProduct(std::size_t const a, std::size_t const b) {
+      if (b != 0 && a > SIZE_MAX / b) { return std::nullopt; }
+      return a * b;
+    }
+
+    // Muestras por entrada de la tabla entrelazada: la cuarta es relleno para copiar 8 bytes
+    constexpr std::size_t INTERLEAVED_SAMPLES = 4;
+    using InterleavedColor                    = std::array<unsigned short, INTERLEAVED_SAMPLES>;
+
+    // Tabla de colores en la forma que necesita cada disposición: un plano por canal, con una
+    // entrada de relleno al final para las lecturas vectoriales de 32 bits (SOA), o una entrada de
+    // 8 bytes por color (AOS)
+    struct PaletteTables {
+        std::array<std::vector<unsigned short>, CHANNELS> planes;
+        std::vector<InterleavedColor> interleaved;
+
+        PaletteTables(std::vector<PackedColor> const & colors, std::size_t const stride) {
+          if (stride == 1) {
+            for (auto & plane : planes) { plane.resize(colors.size() + 1); }
+          } else {
+            interleaved.resize(colors.size());
+          }
+          for (std::size_t index = 0; index < colors.size(); ++index) {
+            auto const [red, green, blue] = unpackColor(colors[index]);
+            if (stride == 1) {
+              planes[0][index] = red;
+              planes[1][index] = green;
+              planes[2][index] = blue;
+            } else {
+              interleaved[index] = {red, green, blue, 0};
+            }
+          }
+        }
+    };
+
+    template <std::size_t Bytes>
+    void decodeAligned(std::span<char const> data, std::span<std::uint32_t> indices) {
+      for (std::size_t i = 0; i < indices.size(); ++i) {
+        std::uint32_t value = 0;
+        for (std::size_t byte = 0; byte < Bytes; ++byte) {
+          value |= std::uint32_t{static_cast<unsigned char>(data[(i * Bytes) + byte])}
+                   << (byte * BYTE_BITS);
+        }
+        indices[i] = value;
+      }
+    }
+
+    void gatherPlanesScalar(PaletteTables const & palette, std::span<std::uint32_t const> indices,
+                            WritablePixelChannels const & pixels, std::size_t const first) {
+      for (std::size_t i = 0; i < indices.size(); ++i) {
+        for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+          pixels.channels[channel][first + i] = palette.planes[channel][indices[i]];
+        }
+      }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    constexpr std::size_t AVX2_PIXELS = 16;
+    constexpr std::size_t AVX2_LANES  = 8;
+    constexpr int SAMPLE_LOW_BITS     = 0xFFFF;
+
+    // Ocho muestras con un gather de 32 bits sobre el plano de 16 bits; la entrada de relleno
+    // permite leer la palabra siguiente a la última
+    [[gnu::target("avx2")]] __m256i gatherLanes(std::vector<unsigned short> const & plane,
+                                                __m256i const indices) {
+      auto const * base   = reinterpret_cast<int const *>(plane.data());  // NOLINT
+      __m256i const words = _mm256_i32gather_epi32(base, indices, 2);
+      return _mm256_and_si256(words, _mm256_set1_epi32(SAMPLE_LOW_BITS));
+    }
+
+    [[gnu::target("avx2")]] __m256i loadIndices(std::span<std::uint32_t const> indices,
+                                                std::size_t const offset) {
+      return _mm256_loadu_si256(
+          reinterpret_cast<__m256i const *>(indices.subspan(offset).data()));  // NOLINT
+    }
+
+    [[gnu::target("avx2")]] std::size_t gatherPlanesAvx2(PaletteTables const & palette,
+                                                         std::span<std::uint32_t const> indices,
+                                                         WritablePixelChannels const & pixels,
+                                                         std::size_t const first) {
+      std::size_t index = 0;
+      for (; index + AVX2_PIXELS <= indices.size(); index += AVX2_PIXELS) {
+        __m256i const low  = loadIndices(indices, index);
+        __m256i const high = loadIndices(indices, index + AVX2_LANES);
+        for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+          std::vector<unsigned short> const & plane = palette.planes[channel];
+          // packus mezcla las mitades de 128 bits; el permute devuelve el orden original
+          __m256i const samples = _mm256_permute4x64_epi64(
+              _mm256_packus_epi32(gatherLanes(plane, low), gatherLanes(plane, high)),
+              _MM_SHUFFLE(3, 1, 2, 0));
+          _mm256_storeu_si256(reinterpret_cast<__m256i *>(  // NOLINT
+                                  pixels.channels[channel].subspan(first + index).data()),
+                              samples);
+        }
+      }
+      return index;
+    }
+#endif
+
+    void gatherPlanes(PaletteTables const & palette, std::span<std::uint32_t const> indices,
+                      WritablePixelChannels const & pixels, std::size_t const first) {
+      std::size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+      if (cpuHasAvx2()) { done = gatherPlanesAvx2(palette, indices, pixels, first); }
+#endif
+      gatherPlanesScalar(palette, indices.subspan(done), pixels, first + done);
+    }
+
+    // Muestras entrelazadas: cada píxel se copia con 8 bytes y el cuarto valor lo sobrescribe el
+    // píxel siguiente. El último píxel del bloque se escribe muestra a muestra para no pisar el
+    // primero del bloque de otro hilo.
+    void gatherInterleaved(PaletteTables const & palette, std::span<std::uint32_t const> indices,
+                           WritablePixelChannels const & pixels, std::size_t const first) {
+      std::span<unsigned short> const samples = pixels.channels[0];
+      for (std::size_t i = 0; i + 1 < indices.size(); ++i) {
+        std::memcpy(samples.subspan((first + i) * CHANNELS, INTERLEAVED_SAMPLES).data(),
+                    palette.interleaved[indices[i]].data(), sizeof(InterleavedColor));
+      }
+      std::size_t const last       = indices.size() - 1;
+      InterleavedColor const color = palette.interleaved[indices[last]];
+      for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+        samples[((first + last) * CHANNELS) + channel] = color[channel];
+      }
+    }
+  }  // namespace
+
+  std::optional<CompressedPayload> compressedPayload(Image const & header,
+                                                     CompressFormat const format,
+                                                     std::size_t const colorTableSize) {
+    std::optional<std::size_t> const pixels = checkedProduct(header.getWidth(), header.getHeight());
+    std::optional<std::size_t> const tableBytes =
+        checkedProduct(colorTableSize, CHANNELS * bytesPerSample(header.getMaxColorValue()));
+    if (!pixels || !tableBytes) { return std::nullopt; }
+
+    std::optional<std::size_t> indexBytes;
+    if (format == CompressFormat::BitPacked) {
+      // packedByteSize redondea los bits a bytes completos; la suma del redondeo también cabe
+      std::optional<std::size_t> const bits =
+          checkedProduct(*pixels, indexBitWidth(colorTableSize));
+      if (bits && *bits <= SIZE_MAX - BYTE_BITS) {
+        indexBytes = packedByteSize(*pixels, indexBitWidth(colorTableSize));
+      }
+    } else {
+      indexBytes = checkedProduct(*pixels, indexByteSize(colorTableSize));
+    }
+    if (!indexBytes || *indexBytes > SIZE_MAX - *tableBytes) { return std::nullopt; }
+    return CompressedPayload{.tableBytes = *tableBytes, .indexBytes = *indexBytes};
+  }
+
+  bool isCompressedFile(std::string const & filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    std::array<char, 2> magic{};
+    file.read(magic.data(), magic.size());
+    return file.good() && magic[0] == 'C' && magic[1] == '6';
+  }
+
+  bool readCompressed(std::string const & filePath, CompressedImage & compressed) {
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open file: " << filePath << '\n';
+      return false;
+    }
+
+    unsigned long colorTableSize = 0;
+    if (!compressed.header.readHeaderCompress(file, compressed.format, colorTableSize)) {
+      return false;
+    }
+    // Unas dimensiones cuyo tamaño no cabe en std::size_t darían la vuelta y pasarían la
+    // comprobación del tamaño del fichero
+    std::optional<CompressedPayload> const payload =
+        compressedPayload(compressed.header, compressed.format, colorTableSize);
+    if (!payload) {
+      std::cerr << "Invalid compressed dimensions: " << compressed.header.getWidth() << 'x'
+                << compressed.header.getHeight() << '\n';
+      return false;
+    }
+    std::size_t const pixels = compressed.pixelCount();
+    if (colorTableSize > MAX_COLOR_TABLE_SIZE || (colorTableSize == 0 && pixels > 0)) {
+      std::cerr << "Invalid color table size: " << colorTableSize << '\n';
+      return false;
+    }
+
+    std::size_t const sampleBytes       = bytesPerSample(compressed.header.getMaxColorValue());
+    auto const [tableBytes, indexBytes] = *payload;
+    std::error_code error;
+    std::uintmax_t const fileSize = std::filesystem::file_size(filePath, error);
+    auto const dataStart          = static_cast<std::uintmax_t>(file.tellg());
+    if (error || fileSize < dataStart || fileSize - dataStart < tableBytes + indexBytes) {
+      std::cerr << "Truncated compressed data: " << filePath << '\n';
+      return false;
+    }
+
+    std::vector<char> table(tableBytes);
+    file.read(table.data(), static_cast<std::streamsize>(table.size()));
+    compressed.colors.resize(colorTableSize);
+    for (std::size_t index = 0; index < colorTableSize; ++index) {
+      std::span<char const> const entry = std::span<char const>(table).subspan(
+          index * CHANNELS * sampleBytes, CHANNELS * sampleBytes);
+      // Muestras en big endian, como en los datos de un PPM
+      auto const sample = [entry, sampleBytes](std::size_t const channel) {
+        std::span<char const> const bytes = entry.subspan(channel * sampleBytes, sampleBytes);
+        unsigned value                    = static_cast<unsigned char>(bytes[0]);
+        if (sampleBytes == 2) {
+          value = (value << SAMPLE_SHIFT) | static_cast<unsigned char>(bytes[1]);
+        }
+        return static_cast<unsigned short>(value);
+      };
+      compressed.colors[index] = packColor(sample(0), sample(1), sample(2));
+    }
+
+    compressed.indexData.resize(indexBytes);
+    file.read(compressed.indexData.data(), static_cast<std::streamsize>(indexBytes));
+    return file.good();
+  }
+
+  bool expandCompressed(CompressedImage const & compressed, WritablePixelChannels const & pixels) {
+    PaletteTables const palette(compressed.colors, pixels.stride);
+    std::size_t const blocks = (pixels.count + DECODE_BLOCK - 1) / DECODE_BLOCK;
+    std::atomic<bool> valid{true};
+    threadpool::parallelFor(0, blocks, [&](std::size_t const first, std::size_t const last) {
+      std::vector<std::uint32_t> indices(DECODE_BLOCK);
+      for (std::size_t block = first; block < last; ++block) {
+        std::size_t const begin = block * DECODE_BLOCK;
+        std::span const blockIndices =
+            std::span(indices).first(std::min(DECODE_BLOCK, pixels.count - begin));
+        decodeIndices(compressed, begin, blockIndices);
+        if (std::ranges::max(blockIndices) >= compressed.colors.size()) {
+          valid = false;
+          continue;
+        }
+        if (pixels.stride == 1) {
+          gatherPlanes(palette, blockIndices, pixels, begin);
+        } else {
+          gatherInterleaved(palette, blockIndices, pixels, begin);
+        }
+      }
+    });
+    if (!valid) { std::cerr << "Color index out of range in compressed data\n"; }
+    return valid;
+  }
+
+  bool writeCompressed(std::string const & filePath, CompressedImage const & compressed) {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open file for writing: " << filePath << '\n';
+      return false;
+    }
+    if (!compressed.header.writeHeaderCompress(file, compressed.colors.size(),
+                                               compressed.format) ||
+        !writeCompressColorTable(file, compressed.colors,
+                                 compressed.header.getMaxColorValue())) {
+      return false;
+    }
+    file.write(compressed.indexData.data(),
+               static_cast<std::streamsize>(compressed.indexData.size()));
+    return file.good();
+  }
+
+  void decodeIndices(CompressedImage const & compressed, std::size_t const first,
+                     std::span<std::uint32_t> indices) {
+    std::span<char const> const data(compressed.indexData);
+    if (compressed.format == CompressFormat::BitPacked) {
+      unpackIndexRange(data, indexBitWidth(compressed.colors.size()), first, indices);
+      return;
+    }
+    std::size_t const bytes = indexByteSize(compressed.colors.size());
+    switch (bytes) {
+      case 1:
+        decodeAligned<1>(data.subspan(first), indices);
+        break;
+      case 2:
+        decodeAligned<2>(data.subspan(first * 2), indices);
+        break;
+      default:
+        decodeAligned<sizeof(std::uint32_t)>(data.subspan(first * sizeof(std::uint32_t)),
+                                             indices);
+        break;
+    }
+  }
+
+  bool countIndices(CompressedImage const & compressed, std::vector<std::uint32_t> & counts) {
+    std::size_t const pixels = compressed.pixelCount();
+    std::size_t const blocks = (pixels + DECODE_BLOCK - 1) / DECODE_BLOCK;
+    // Una parte por hilo como mucho: cada parte tiene un histograma del tamaño de la tabla
+    std::size_t const parts = partCount(blocks, 1);
+    std::vector<std::vector<std::uint32_t>> partCounts(parts);
+    std::atomic<bool> valid{true};
+    threadpool::parallelFor(0, parts, [&](std::size_t const first, std::size_t const last) {
+      std::vector<std::uint32_t> indices(DECODE_BLOCK);
+      for (std::size_t part = first; part < last; ++part) {
+        std::vector<std::uint32_t> & local = partCounts[part];
+        local.assign(compressed.colors.size(), 0);
+        PixelRange const range = partRange(blocks, parts, part);
+        for (std::size_t block = range.first; block < range.last; ++block) {
+          std::size_t const begin = block * DECODE_BLOCK;
+          std::span const blockIndices =
+              std::span(indices).first(std::min(DECODE_BLOCK, pixels - begin));
+          decodeIndices(compressed, begin, blockIndices);
+          for (std::uint32_t const index : blockIndices) {
+            if (index >= local.size()) {
+              valid = false;
+              break;
+            }
+            ++local[index];
+          }
+        }
+      }
+    });
+    if (!valid) {
+      std::cerr << "Color index out of range in compressed data\n";
+      return false;
+    }
+
+    counts.assign(compressed.colors.size(), 0);
+    for (auto const & local : partCounts) {
+      for (std::size_t index = 0; index < local.size(); ++index) { counts[index] += local[index]; }
+    }
+    return true;
+  }
+}  // namespace image
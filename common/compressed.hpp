@@ -0,0 +1,64 @@
+#pragma once
+
+#include <common/colormap.hpp>
+#include <common/image.hpp>
+#include <common/replacement.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace image {
+  // Fichero comprimido (C6 o C6v2) sin expandir: cabecera, tabla de colores y flujo de índices
+  // tal como aparece en el fichero
+  struct CompressedImage {
+      Image header;
+      CompressFormat format = CompressFormat::ByteAligned;
+      std::vector<PackedColor> colors;
+      std::vector<char> indexData;
+
+      [[nodiscard]] std::size_t pixelCount() const {
+        return header.getWidth() * header.getHeight();
+      }
+  };
+
+  // Bytes de la tabla de colores y del flujo de índices que siguen a la cabecera
+  struct CompressedPayload {
+      std::size_t tableBytes;
+      std::size_t indexBytes;
+  };
+
+  // nullopt si los tamaños no caben en std::size_t, lo que solo ocurre con cabeceras corruptas
+  [[nodiscard]] std::optional<CompressedPayload>
+      compressedPayload(Image const & header, CompressFormat format, std::size_t colorTableSize);
+
+  // Comprueba si el fichero empieza por la cabecera de un fichero comprimido ("C6")
+  [[nodiscard]] bool isCompressedFile(std::string const & filePath);
+
+  // Lee la cabecera, la tabla de colores y los índices. Comprueba el tamaño del fichero antes de
+  // reservar memoria; los errores se informan por std::cerr como en loadFromFile.
+  [[nodiscard]] bool readCompressed(std::string const & filePath, CompressedImage & compressed);
+
+  // Expande los índices sobre `pixels`, que tiene que tener pixelCount() píxeles. Cada hilo
+  // decodifica bloques de píxeles y copia sus colores con una tabla por canal (AVX2 con los planos
+  // SOA) o con una escritura de 8 bytes por píxel (AOS). Devuelve false si algún índice no está en
+  // la tabla de colores.
+  [[nodiscard]] bool expandCompressed(CompressedImage const & compressed,
+                                      WritablePixelChannels const & pixels);
+
+  // Escribe la cabecera, la tabla de colores y el flujo de índices tal como están
+  [[nodiscard]] bool writeCompressed(std::string const & filePath,
+                                     CompressedImage const & compressed);
+
+  // Índices de los píxeles [first, first + indices.size()); con la variante empaquetada `first`
+  // tiene que ser múltiplo de 8
+  void decodeIndices(CompressedImage const & compressed, std::size_t first,
+                     std::span<std::uint32_t> indices);
+
+  // Número de píxeles de cada entrada de la tabla de colores. Cada hilo cuenta una parte de los
+  // bloques en su propio histograma. Devuelve false si algún índice no está en la tabla.
+  [[nodiscard]] bool countIndices(CompressedImage const & compressed,
+                                  std::vector<std::uint32_t> & counts);
+}  // namespace image
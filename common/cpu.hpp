@@ -0,0 +1,11 @@
+#pragma once
+
+namespace image {
+#if defined(__x86_64__) || defined(__i386__)
+  // Si el procesador admite AVX2; se consulta una sola vez por proceso
+  inline bool cpuHasAvx2() {
+    static bool const supported = __builtin_cpu_supports("avx2") != 0;
+    return supported;
+  }
+#endif
+}  // namespace image
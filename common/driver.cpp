@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <common/batch.hpp>
+#include <common/colorstream.hpp>
+#include <common/driver.hpp>
+#include <common/info.hpp>
+#include <common/paletteimage.hpp>
+#include <common/progargs.hpp>
+#include <common/rowstream.hpp>
+#include <common/server.hpp>
+#include <common/threadpool.hpp>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace driver {
+  int runInfoList(progargs::ParsedOperationArgs const & parsedOperationArgs) {
+    std::vector<std::string> filePaths{parsedOperationArgs.inputFilePath};
+    filePaths.insert(filePaths.end(), parsedOperationArgs.additionalInputFilePaths.begin(),
+                     parsedOperationArgs.additionalInputFilePaths.end());
+    return image::printFileInfos(std::cout, filePaths, parsedOperationArgs.options.json) ? 0 : -1;
+  }
+
+  int runPalette(progargs::ParsedOperationArgs const & parsedOperationArgs) {
+    if (parsedOperationArgs.options.labels || parsedOperationArgs.options.packed) {
+      std::cerr << "Error: --labels and --packed are not supported on compressed input\n";
+      return -1;
+    }
+    std::vector<progargs::Stage> const stages = progargs::pipelineStages(parsedOperationArgs);
+    if (std::ranges::any_of(stages, [](progargs::Stage const & stage) {
+          return stage.cutFreqMethod == progargs::CutFreqMethod::Approximate;
+        })) {
+      std::cerr << "Error: compressed input only supports the exact cutfreq\n";
+      return -1;
+    }
+    image::PaletteImage image;
+    if (!image.loadFromFile(parsedOperationArgs.inputFilePath)) { return -1; }
+    for (progargs::Stage const & stage : stages) {
+      switch (stage.operation) {
+        case progargs::MaxLevel:
+          image.modifyMaxLevel(static_cast<unsigned short>(stage.args[0]));
+          break;
+        case progargs::CutFreq:
+          if (!image.cutfreq(stage.args[0])) { return -1; }
+          break;
+        default:
+          std::cerr << "Error: operation not supported on compressed input\n";
+          return -1;
+      }
+    }
+    return image.saveToFile(parsedOperationArgs.outputFilePath) ? 0 : -1;
+  }
+
+  int runStreaming(progargs::ParsedOperationArgs const & parsedOperationArgs,
+                   StreamResize const resizeStream) {
+    if (!parsedOperationArgs.nextStages.empty()) {
+      std::cerr << "Error: --memory-limit does not support operation chains\n";
+      return -1;
+    }
+    std::size_t const memoryLimit = parsedOperationArgs.options.memoryLimit;
+    bool written                  = false;
+    switch (parsedOperationArgs.operation) {
+      case progargs::MaxLevel:
+        written = image::streamMaxLevel(parsedOperationArgs.inputFilePath,
+                                        parsedOperationArgs.outputFilePath,
+                                        static_cast<unsigned short>(parsedOperationArgs.args[0]),
+                                        memoryLimit);
+        break;
+      case progargs::Resize:
+        if (parsedOperationArgs.resizeMethod != progargs::ResizeMethod::Default) {
+          std::cerr << "Error: --memory-limit only supports the default resize\n";
+          return -1;
+        }
+        written = resizeStream(parsedOperationArgs.inputFilePath,
+                               parsedOperationArgs.outputFilePath, parsedOperationArgs.args[0],
+                               parsedOperationArgs.args[1], memoryLimit);
+        break;
+      case progargs::CutFreq:
+        if (parsedOperationArgs.cutFreqMethod == progargs::CutFreqMethod::Approximate) {
+          std::cerr << "Error: --memory-limit only supports the exact cutfreq\n";
+          return -1;
+        }
+        written = image::streamCutFreq(parsedOperationArgs.inputFilePath,
+                                       parsedOperationArgs.outputFilePath,
+                                       parsedOperationArgs.args[0], memoryLimit);
+        break;
+      case progargs::Compress:
+        written = image::streamCompress(parsedOperationArgs.inputFilePath,
+                                        parsedOperationArgs.outputFilePath,
+                                        parsedOperationArgs.options.packed
+                                            ? image::CompressFormat::BitPacked
+                                            : image::CompressFormat::ByteAligned,
+                                        memoryLimit);
+        break;
+      default:
+        std::cerr << "Error: operation not supported with --memory-limit\n";
+        return -1;
+    }
+    return written ? 0 : -1;
+  }
+
+  int runBatch(progargs::ParsedOperationArgs const & parsedOperationArgs,
+               image::JobRunner const & run) {
+    bool const succeeded = image::runManifest(parsedOperationArgs.inputFilePath, run, std::cout);
+    return succeeded ? 0 : -1;
+  }
+
+  int runServer(progargs::ParsedOperationArgs const & parsedOperationArgs, image::JobRunner run) {
+    std::size_t const queueDepth = parsedOperationArgs.options.queueDepth != 0
+                                       ? parsedOperationArgs.options.queueDepth
+                                       : progargs::QUEUE_DEPTH_DEFAULT;
+    server::JobServer jobServer({.socketPath = parsedOperationArgs.inputFilePath,
+                                 .queueDepth = queueDepth,
+                                 .workers    = threadpool::threadCount()},
+                                std::move(run));
+    if (!jobServer.isListening()) { return -1; }
+    jobServer.handleSignals();
+    return jobServer.serve() ? 0 : -1;
+  }
+}  // namespace driver
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <common/batch.hpp>
+#include <common/compressed.hpp>
+#include <common/info.hpp>
+#include <common/labelmap.hpp>
+#include <common/pipeline.hpp>
+#include <common/progargs.hpp>
+#include <common/resample.hpp>
+#include <common/threadpool.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Programa imtool sin la disposición de la imagen: imtool-aos e imtool-soa instancian run() con
+// su Image y su resize por bandas. Lo que no toca los píxeles (info de varios ficheros, entradas
+// comprimidas, --memory-limit, --batch y --serve) está en driver.cpp.
+namespace driver {
+  // imageaos::resizeStream o imagesoa::resizeStream
+  using StreamResize = bool (*)(std::string const & inputPath, std::string const & outputPath,
+                                unsigned long new_width, unsigned long new_height,
+                                std::size_t memoryLimit);
+
+  // info de varios ficheros o con --json: una línea por fichero
+  [[nodiscard]] int runInfoList(progargs::ParsedOperationArgs const & parsedOperationArgs);
+
+  // Con una entrada comprimida, maxlevel y cutfreq trabajan sobre la tabla de colores sin
+  // expandir los índices y escriben otro fichero comprimido del mismo formato; no hay píxeles que
+  // etiquetar ni formato de salida que elegir
+  [[nodiscard]] int runPalette(progargs::ParsedOperationArgs const & parsedOperationArgs);
+
+  // Con --memory-limit, maxlevel y resize leen y escriben por bandas de filas sin cargar la
+  // imagen completa; cutfreq y compress cuentan además los colores en runs volcados a disco
+  [[nodiscard]] int runStreaming(progargs::ParsedOperationArgs const & parsedOperationArgs,
+                                 StreamResize resizeStream);
+
+  [[nodiscard]] int runBatch(progargs::ParsedOperationArgs const & parsedOperationArgs,
+                             image::JobRunner const & run);
+
+  // Tantos trabajos a la vez como hilos tiene el pool, que además reparte las filas de cada uno
+  [[nodiscard]] int runServer(progargs::ParsedOperationArgs const & parsedOperationArgs,
+                              image::JobRunner run);
+
+  // info solo analiza las cabeceras; con varios ficheros o --json imprime una línea por fichero
+  template <typename Image>
+  int runInfo(progargs::ParsedOperationArgs const & parsedOperationArgs) {
+    if (!parsedOperationArgs.additionalInputFilePaths.empty() || parsedOperationArgs.options.json) {
+      return runInfoList(parsedOperationArgs);
+    }
+    image::FileInfo const info = image::probeFile(parsedOperationArgs.inputFilePath);
+    if (info.status == image::PayloadStatus::Invalid) { return -1; }
+    if (info.status == image::PayloadStatus::Truncated) {
+      std::cerr << "Warning: pixel data truncated (" << info.fileSize << " of "
+                << info.expectedSize << " bytes)\n";
+    }
+
+    Image image;
+    image.setWidth(info.header.getWidth());
+    image.setHeight(info.header.getHeight());
+    image.setMaxColorValue(info.header.getMaxColorValue());
+    image.displayMetadata();
+    return 0;
+  }
+
+  // Sin tercer argumento se mantiene la interpolación propia de la disposición
+  template <typename Image>
+  void runResize(Image & image, progargs::Stage const & stage) {
+    unsigned long const width  = stage.args[0];
+    unsigned long const height = stage.args[1];
+    switch (stage.resizeMethod) {
+      case progargs::ResizeMethod::Fixed:
+        image.resizeFixed(width, height);
+        break;
+      case progargs::ResizeMethod::Box:
+        image.resample(width, height, image::ResampleFilter::Box);
+        break;
+      case progargs::ResizeMethod::Bilinear:
+        image.resample(width, height, image::ResampleFilter::Bilinear);
+        break;
+      case progargs::ResizeMethod::Bicubic:
+        image.resample(width, height, image::ResampleFilter::Bicubic);
+        break;
+      case progargs::ResizeMethod::Lanczos3:
+        image.resample(width, height, image::ResampleFilter::Lanczos3);
+        break;
+      default:
+        image.resize(width, height);
+        break;
+    }
+  }
+
+  // Con --labels, cutfreq y compress etiquetan antes cada píxel e informan de su memoria; el
+  // cutfreq aproximado informa del error que introduce
+  template <typename Image>
+  void runCutFreq(Image & image, progargs::Stage const & stage,
+                  progargs::Options const & options) {
+    if (stage.cutFreqMethod == progargs::CutFreqMethod::Approximate) {
+      std::int64_t const maxError = image.cutfreqApproximate(stage.args[0]);
+      std::cerr << "Approximate cutfreq: max squared distance error " << maxError << "\n";
+    } else if (options.labels) {
+      image::ColorLabels const labels = image.labelColors();
+      image::reportLabelMemory(std::cerr, labels);
+      image.cutfreq(stage.args[0], labels);
+    } else {
+      image.cutfreq(stage.args[0]);
+    }
+  }
+
+  // Con --packed se escribe la variante C6v2 de índices empaquetados
+  template <typename Image>
+  bool runCompress(Image const & image, progargs::ParsedOperationArgs const & parsedOperationArgs) {
+    image::CompressFormat const format = parsedOperationArgs.options.packed
+                                             ? image::CompressFormat::BitPacked
+                                             : image::CompressFormat::ByteAligned;
+    if (!parsedOperationArgs.options.labels) {
+      return image.saveToFileCompress(parsedOperationArgs.outputFilePath, format);
+    }
+    image::ColorLabels const labels = image.labelColors();
+    image::reportLabelMemory(std::cerr, labels);
+    return image.saveToFileCompress(parsedOperationArgs.outputFilePath, labels, format);
+  }
+
+  // Las operaciones de la cadena se aplican en orden sobre la imagen en memoria. Los maxlevel se
+  // funden con el paso anterior (image::fusePipeline): tras un resize por defecto se aplican en su
+  // bucle de salida y varios seguidos se componen en una sola tabla. Solo el último paso escribe.
+  template <typename Image>
+  bool runPipeline(Image & image, progargs::ParsedOperationArgs const & parsedOperationArgs) {
+    for (image::PipelineStep const & step :
+         image::fusePipeline(progargs::pipelineStages(parsedOperationArgs))) {
+      progargs::Stage const & stage = step.stage;
+      switch (stage.operation) {
+        case progargs::MaxLevel:
+          image.modifyMaxLevel(image::chainLevels(image.getMaxColorValue(), step.maxLevels),
+                               step.maxLevels.back());
+          break;
+        case progargs::Resize:
+          if (step.maxLevels.empty()) {
+            runResize(image, stage);
+          } else {
+            image.resize(stage.args[0], stage.args[1],
+                         image::chainLevels(image.getMaxColorValue(), step.maxLevels),
+                         step.maxLevels.back());
+          }
+          break;
+        case progargs::CutFreq:
+          runCutFreq(image, stage, parsedOperationArgs.options);
+          break;
+        case progargs::Compress:
+          return runCompress(image, parsedOperationArgs);
+        default:
+          break;
+      }
+    }
+    return image.saveToFile(parsedOperationArgs.outputFilePath);
+  }
+
+  template <typename Image>
+  int runDecompress(Image & image, progargs::ParsedOperationArgs const & parsedOperationArgs) {
+    if (!image.loadFromFileCompress(parsedOperationArgs.inputFilePath)) { return -1; }
+    return image.saveToFile(parsedOperationArgs.outputFilePath) ? 0 : -1;
+  }
+
+  // Un trabajo completo, de la línea de órdenes o de un lote. `image` puede venir de un trabajo
+  // anterior: la carga reutiliza la memoria de sus píxeles.
+  template <typename Image>
+  int runJob(Image & image, progargs::ParsedOperationArgs const & parsedOperationArgs,
+             StreamResize const resizeStream) {
+    if (parsedOperationArgs.operation == progargs::Decompress) {
+      return runDecompress(image, parsedOperationArgs);
+    }
+    if (image::isCompressedFile(parsedOperationArgs.inputFilePath)) {
+      return runPalette(parsedOperationArgs);
+    }
+    if (parsedOperationArgs.options.memoryLimit != 0) {
+      return runStreaming(parsedOperationArgs, resizeStream);
+    }
+
+    if (!image.loadFromFile(parsedOperationArgs.inputFilePath)) { return -1; }
+    return runPipeline(image, parsedOperationArgs) ? 0 : -1;
+  }
+
+  // Trabajo de un lote o del servidor: cada hilo conserva su imagen entre trabajos para
+  // reutilizar sus búferes, salvo los que superan image::RECYCLED_BUFFER_BYTES
+  template <typename Image>
+  image::JobRunner recycledJobRunner(StreamResize const resizeStream) {
+    return [resizeStream](progargs::ParsedOperationArgs const & job) {
+      thread_local Image image;
+      image.setRecycleBuffers(true);
+      int const status = runJob(image, job, resizeStream);
+      image.trimBuffers(image::RECYCLED_BUFFER_BYTES);
+      return status == 0;
+    };
+  }
+
+  template <typename Image>
+  int run(std::vector<std::string> const & args, StreamResize const resizeStream) {
+    progargs::ParsedOperationArgs const parsedOperationArgs = progargs::parseOperation(args);
+    if (parsedOperationArgs.operation == progargs::Info) {
+      return runInfo<Image>(parsedOperationArgs);
+    }
+    threadpool::setThreadCount(parsedOperationArgs.options.threads);
+    if (parsedOperationArgs.operation == progargs::Batch) {
+      return runBatch(parsedOperationArgs, recycledJobRunner<Image>(resizeStream));
+    }
+    if (parsedOperationArgs.operation == progargs::Serve) {
+      return runServer(parsedOperationArgs, recycledJobRunner<Image>(resizeStream));
+    }
+
+    Image image;
+    return runJob(image, parsedOperationArgs, resizeStream);
+  }
+}  // namespace driver
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <atomic>
+#include <common/histogram.hpp>
+#include <common/image.hpp>
+#include <common/threadpool.hpp>
+#include <optional>
+
+namespace image {
+  namespace {
+    constexpr unsigned DENSE_CHANNEL_BITS = 8;
+    constexpr std::size_t DENSE_SIZE      = std::size_t{1} << (3 * DENSE_CHANNEL_BITS);
+    constexpr std::size_t DENSE_BLOCK     = std::size_t{1} << (2 * DENSE_CHANNEL_BITS);
+    constexpr std::size_t DENSE_MASK      = (std::size_t{1} << DENSE_CHANNEL_BITS) - 1;
+
+    // El array directo solo compensa (16M contadores que poner a cero y recorrer) con imágenes
+    // grandes; cada parcial densa debe cubrir bastantes píxeles por el mismo motivo
+    constexpr std::size_t DENSE_MIN_PIXELS       = std::size_t{1} << 20;
+    constexpr std::size_t DENSE_PIXELS_PER_PART  = std::size_t{1} << 22;
+    constexpr std::size_t HASHED_PIXELS_PER_PART = std::size_t{1} << 16;
+    constexpr std::size_t SPLIT_COLORS_PER_PART  = std::size_t{1} << 16;
+
+    // Cada parcial densa ocupa 64 MiB; con muchos hilos se cuentan menos partes, y más grandes,
+    // para no pasar de este presupuesto
+    constexpr std::size_t DENSE_PART_BYTES    = DENSE_SIZE * sizeof(std::uint32_t);
+    constexpr std::size_t DENSE_MEMORY_BUDGET = std::size_t{256} << 20;
+    constexpr std::size_t DENSE_MAX_PARTS     = DENSE_MEMORY_BUDGET / DENSE_PART_BYTES;
+
+    // Cuenta en el array directo; devuelve false si alguna muestra no cabe en 8 bits
+    bool countDenseRange(PixelChannels const & pixels, PixelRange const range,
+                         std::vector<std::uint32_t> & counts) {
+      counts.assign(DENSE_SIZE, 0);
+      for (std::size_t pixel = range.first; pixel < range.last; ++pixel) {
+        std::size_t const offset = pixel * pixels.stride;
+        std::size_t const red    = pixels.channels[0][offset];
+        std::size_t const green  = pixels.channels[1][offset];
+        std::size_t const blue   = pixels.channels[2][offset];
+        if ((red | green | blue) > DENSE_MASK) { return false; }
+        ++counts[(((red << DENSE_CHANNEL_BITS) | green) << DENSE_CHANNEL_BITS) | blue];
+      }
+      return true;
+    }
+
+    // Suma las parciales de un bloque de índices y recoge los colores presentes en orden
+    std::vector<ColorFrequency>
+        collectDenseBlock(std::vector<std::vector<std::uint32_t>> const & partials,
+                          std::size_t const block) {
+      std::vector<ColorFrequency> found;
+      for (std::size_t index = block * DENSE_BLOCK; index < (block + 1) * DENSE_BLOCK; ++index) {
+        std::uint32_t count = 0;
+        for (auto const & partial : partials) { count += partial[index]; }
+        if (count == 0) { continue; }
+        auto const red   = static_cast<unsigned short>(index >> (2 * DENSE_CHANNEL_BITS));
+        auto const green = static_cast<unsigned short>((index >> DENSE_CHANNEL_BITS) & DENSE_MASK);
+        auto const blue  = static_cast<unsigned short>(index & DENSE_MASK);
+        found.push_back({.color = packColor(red, green, blue), .count = count});
+      }
+      return found;
+    }
+
+    std::optional<std::vector<ColorFrequency>> countDense(PixelChannels const & pixels) {
+      std::size_t const parts =
+          std::min(partCount(pixels.count, DENSE_PIXELS_PER_PART), DENSE_MAX_PARTS);
+      std::vector<std::vector<std::uint32_t>> partials(parts);
+      std::atomic<bool> fits{true};
+      threadpool::parallelFor(0, parts, [&](std::size_t const first, std::size_t const last) {
+        for (std::size_t part = first; part < last; ++part) {
+          if (!countDenseRange(pixels, partRange(pixels.count, parts, part), partials[part])) {
+            fits = false;
+          }
+        }
+      });
+      if (!fits) { return std::nullopt; }
+
+      std::vector<std::vector<ColorFrequency>> blocks(DENSE_SIZE / DENSE_BLOCK);
+      threadpool::parallelFor(0, blocks.size(),
+                              [&](std::size_t const first, std::size_t const last) {
+                                for (std::size_t block = first; block < last; ++block) {
+                                  blocks[block] = collectDenseBlock(partials, block);
+                                }
+                              });
+
+      std::vector<ColorFrequency> histogram;
+      for (auto const & block : blocks) {
+        histogram.insert(histogram.end(), block.begin(), block.end());
+      }
+      return histogram;
+    }
+
+    std::vector<ColorFrequency> countHashed(PixelChannels const & pixels) {
+      std::size_t const parts = partCount(pixels.count, HASHED_PIXELS_PER_PART);
+      std::vector<FlatColorMap<std::uint32_t>> partials(parts);
+      threadpool::parallelFor(0, parts, [&](std::size_t const first, std::size_t const last) {
+        for (std::size_t part = first; part < last; ++part) {
+          PixelRange const range = partRange(pixels.count, parts, part);
+          for (std::size_t pixel = range.first; pixel < range.last; ++pixel) {
+            ++partials[part][pixels.colorAt(pixel)];
+          }
+        }
+      });
+
+      // Fusión: se vuelcan todas las parciales, se ordenan por color y se suman los repetidos
+      std::vector<ColorFrequency> histogram;
+      for (auto const & partial : partials) {
+        partial.forEach([&histogram](PackedColor const color, std::uint32_t const count) {
+          histogram.push_back({.color = color, .count = count});
+        });
+      }
+      std::ranges::sort(histogram, {}, &ColorFrequency::color);
+
+      std::size_t merged = 0;
+      for (std::size_t i = 0; i < histogram.size(); ++i) {
+        if (merged > 0 && histogram[merged - 1].color == histogram[i].color) {
+          histogram[merged - 1].count += histogram[i].count;
+        } else {
+          histogram[merged++] = histogram[i];
+        }
+      }
+      histogram.resize(merged);
+      return histogram;
+    }
+
+    // Frecuencia del n-ésimo color menos frecuente y cuántos colores con esa frecuencia se
+    // eliminan (los de menor color)
+    struct CutThreshold {
+        std::uint32_t count;
+        std::size_t ties;
+    };
+
+    CutThreshold cutThreshold(std::vector<ColorFrequency> const & histogram, std::size_t const n) {
+      std::vector<std::uint32_t> counts(histogram.size());
+      std::ranges::transform(histogram, counts.begin(), &ColorFrequency::count);
+      auto const nth = counts.begin() + static_cast<std::ptrdiff_t>(n - 1);
+      std::ranges::nth_element(counts, nth);
+      std::uint32_t const count = *nth;
+      auto const below          = std::count_if(
+          counts.begin(), nth, [count](std::uint32_t const other) { return other < count; });
+      return {.count = count, .ties = n - static_cast<std::size_t>(below)};
+    }
+
+    // Reparto de una parte del histograma: colores por debajo del umbral y empates que contiene, y
+    // cuántos colores eliminados y empates hay en las partes anteriores
+    struct SplitPart {
+        std::size_t below         = 0;
+        std::size_t ties          = 0;
+        std::size_t removedBefore = 0;
+        std::size_t tiesBefore    = 0;
+    };
+
+    void countSplitPart(std::span<ColorFrequency const> colors, std::uint32_t const threshold,
+                        SplitPart & part) {
+      for (auto const & [color, count] : colors) {
+        if (count < threshold) { ++part.below; }
+        if (count == threshold) { ++part.ties; }
+      }
+    }
+
+    void emitSplitPart(std::span<ColorFrequency const> colors, CutThreshold const threshold,
+                       SplitPart const & part, std::span<ColorTuple> removed,
+                       std::span<ColorTuple> kept) {
+      std::size_t ties      = part.tiesBefore;
+      std::size_t removedAt = part.removedBefore;
+      std::size_t keptAt    = 0;
+      for (auto const & [color, count] : colors) {
+        bool remove = count < threshold.count;
+        if (count == threshold.count) { remove = ties++ < threshold.ties; }
+        (remove ? removed[removedAt++] : kept[keptAt++]) = unpackColor(color);
+      }
+    }
+  }  // namespace
+
+  std::size_t partCount(std::size_t const pixels, std::size_t const pixelsPerPart) {
+    return std::clamp<std::size_t>(pixels / pixelsPerPart, 1, threadpool::threadCount());
+  }
+
+  PixelRange partRange(std::size_t const pixels, std::size_t const parts, std::size_t const part) {
+    return {.first = pixels * part / parts, .last = pixels * (part + 1) / parts};
+  }
+
+  std::vector<ColorFrequency> countColors(PixelChannels const & pixels,
+                                          unsigned short const maxColorValue) {
+    if (maxColorValue <= MAX_COLOR_VALUE_8BIT && pixels.count >= DENSE_MIN_PIXELS) {
+      if (auto dense = countDense(pixels)) { return std::move(*dense); }
+    }
+    return countHashed(pixels);
+  }
+
+  ColorSplit splitLeastFrequent(std::vector<ColorFrequency> const & histogram, std::size_t n) {
+    n = std::min(n, histogram.size());
+    ColorSplit split{std::vector<ColorTuple>(n), std::vector<ColorTuple>(histogram.size() - n)};
+    // Sin umbral que buscar, todos los colores van al mismo grupo
+    CutThreshold const threshold =
+        n == 0 ? CutThreshold{.count = 0, .ties = 0} : cutThreshold(histogram, n);
+    std::span<ColorFrequency const> const colors(histogram);
+    std::size_t const parts = partCount(colors.size(), SPLIT_COLORS_PER_PART);
+    std::vector<SplitPart> splits(parts);
+    auto const partColors = [&](std::size_t const part) {
+      PixelRange const range = partRange(colors.size(), parts, part);
+      return colors.subspan(range.first, range.last - range.first);
+    };
+    threadpool::parallelFor(0, parts, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t part = first; part < last; ++part) {
+        countSplitPart(partColors(part), threshold.count, splits[part]);
+      }
+    });
+
+    for (std::size_t part = 1; part < parts; ++part) {
+      SplitPart const & previous  = splits[part - 1];
+      std::size_t const tiesQuota = threshold.ties - std::min(threshold.ties, previous.tiesBefore);
+      splits[part].tiesBefore     = previous.tiesBefore + previous.ties;
+      splits[part].removedBefore =
+          previous.removedBefore + previous.below + std::min(previous.ties, tiesQuota);
+    }
+    threadpool::parallelFor(0, parts, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t part = first; part < last; ++part) {
+        std::size_t const keptFirst = partRange(colors.size(), parts, part).first -
+                                      splits[part].removedBefore;
+        emitSplitPart(partColors(part), threshold, splits[part], split.first,
+                      std::span(split.second).subspan(keptFirst));
+      }
+    });
+    return split;
+  }
+
+  std::vector<std::pair<ColorTuple, int>>
+      unpackFrequencies(std::vector<ColorFrequency> const & histogram) {
+    std::vector<std::pair<ColorTuple, int>> frequencies;
+    frequencies.reserve(histogram.size());
+    for (auto const & [color, count] : histogram) {
+      frequencies.emplace_back(unpackColor(color), static_cast<int>(count));
+    }
+    return frequencies;
+  }
+}  // namespace image
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <common/colormap.hpp>
+#include <common/pixelio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace image {
+  struct ColorFrequency {
+      PackedColor color;
+      std::uint32_t count;
+
+      bool operator==(ColorFrequency const & other) const = default;
+  };
+
+  // Canales de una imagen en solo lectura. `stride` es la distancia en muestras entre dos píxeles
+  // consecutivos de un mismo canal: 3 para AOS y 1 para SOA.
+  struct PixelChannels {
+      std::array<std::span<unsigned short const>, CHANNELS> channels;
+      std::size_t stride;
+      std::size_t count;
+
+      [[nodiscard]] PackedColor colorAt(std::size_t const pixel) const {
+        std::size_t const offset = pixel * stride;
+        return packColor(channels[0][offset], channels[1][offset], channels[2][offset]);
+      }
+  };
+
+  struct PixelRange {
+      std::size_t first;
+      std::size_t last;
+  };
+
+  // Número de partes en que se reparten `pixels` píxeles para contarlos en paralelo: una por hilo
+  // como mucho y de al menos `pixelsPerPart` píxeles cada una
+  [[nodiscard]] std::size_t partCount(std::size_t pixels, std::size_t pixelsPerPart);
+  [[nodiscard]] PixelRange partRange(std::size_t pixels, std::size_t parts, std::size_t part);
+
+  // Histograma de colores ordenado por color, es decir, en el mismo orden que recorrería un
+  // std::map de tuplas. Con imágenes de 8 bits grandes se cuenta en un array directo de 2^24
+  // entradas; en otro caso en tablas hash planas. Cada hilo cuenta una parte de los píxeles en su
+  // propio histograma parcial y las parciales se suman al final. Las parciales densas son como
+  // mucho cuatro (256 MiB) sea cual sea el número de hilos.
+  [[nodiscard]] std::vector<ColorFrequency> countColors(PixelChannels const & pixels,
+                                                        unsigned short maxColorValue);
+
+  // Colores a eliminar y a conservar de cutfreq, en el formato de Image::splitColors
+  using ColorSplit = std::pair<std::vector<ColorTuple>, std::vector<ColorTuple>>;
+
+  // Separa los `n` colores menos frecuentes del resto sin ordenar el histograma: busca con
+  // nth_element la frecuencia umbral y reparte los colores en una pasada paralela. Los empates de
+  // frecuencia se resuelven por color (se elimina el menor) y los dos grupos conservan el orden por
+  // color de `histogram`, que debe ser el de countColors; así, entre dos colores conservados a la
+  // misma distancia, nearestColors elige el menor.
+  [[nodiscard]] ColorSplit splitLeastFrequent(std::vector<ColorFrequency> const & histogram,
+                                              std::size_t n);
+
+  // Conversión al formato de pares (tupla, frecuencia) que usan las operaciones de las imágenes
+  [[nodiscard]] std::vector<std::pair<ColorTuple, int>>
+      unpackFrequencies(std::vector<ColorFrequency> const & histogram);
+}  // namespace image
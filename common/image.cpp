@@ -36,10 +36,39 @@ namespace image {
     return file.good();
   }
 
-  bool Image::writeHeaderCompress(std::ofstream & file, unsigned long const colorTableSize) const {
-    file << "C6 " << width_ << " " << height_ << " " << maxColorValue_ << " " << colorTableSize
-         << "\n";
+  bool Image::writeHeaderCompress(std::ofstream & file, unsigned long const colorTableSize,
+                                  CompressFormat const format) const {
+    file << (format == CompressFormat::BitPacked ? "C6v2 " : "C6 ") << width_ << " " << height_
+         << " " << maxColorValue_ << " " << colorTableSize << "\n";
     return file.good();
   }
 
+  bool Image::readHeaderCompress(std::ifstream & file, CompressFormat & format,
+                                 unsigned long & colorTableSize) {
+    std::string magic;
+    file >> magic;
+    if (magic == "C6") {
+      format = CompressFormat::ByteAligned;
+    } else if (magic == "C6v2") {
+      format = CompressFormat::BitPacked;
+    } else {
+      std::cerr << "Unsupported file format: " << magic << '\n';
+      return false;
+    }
+
+    file >> width_ >> height_ >> maxColorValue_ >> colorTableSize;
+    file.ignore();
+    if (!file) {
+      std::cerr << "Invalid compressed header\n";
+      return false;
+    }
+
+    if (maxColorValue_ < MIN_COLOR_VALUE || maxColorValue_ > MAX_COLOR_VALUE_16BIT) {
+      std::cerr << "Unsupported max color value: " << maxColorValue_ << " (must be between "
+                << MIN_COLOR_VALUE << " and " << MAX_COLOR_VALUE_16BIT << ").\n";
+      return false;
+    }
+
+    return true;
+  }
 }  // namespace image
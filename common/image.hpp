@@ -1,5 +1,8 @@
 #pragma once
 
+#include <common/colormap.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace image {
@@ -7,6 +10,10 @@ namespace image {
   constexpr int MAX_COLOR_VALUE_8BIT  = 255;
   constexpr int MAX_COLOR_VALUE_16BIT = 65535;
 
+  // Índices de píxel de un fichero comprimido: de 1, 2 o 4 bytes (cabecera "C6") o empaquetados
+  // a ceil(log2(colores)) bits (cabecera "C6v2", opción --packed)
+  enum class CompressFormat : std::uint8_t { ByteAligned, BitPacked };
+
   struct Pixel {
       unsigned short red   = 0;
       unsigned short green = 0;
@@ -21,7 +28,11 @@ namespace image {
     public:
       bool readHeader(std::ifstream & file);
       bool writeHeader(std::ofstream & file) const;
-      bool writeHeaderCompress(std::ofstream & file, unsigned long colorTableSize) const;
+      bool writeHeaderCompress(std::ofstream & file, unsigned long colorTableSize,
+                               CompressFormat format = CompressFormat::ByteAligned) const;
+      // Lee la cabecera "C6 w h max n" o "C6v2 w h max n" y el salto de línea que la termina
+      bool readHeaderCompress(std::ifstream & file, CompressFormat & format,
+                              unsigned long & colorTableSize);
 
       [[nodiscard]] unsigned long getWidth() const { return width_; }
 
@@ -42,13 +53,11 @@ namespace image {
   };
 }  // namespace image
 
+// Los tres canales empaquetados y mezclados; con un XOR desplazado de los canales los colores
+// parecidos coincidirían en los bits bajos
 template <>
 struct std::hash<image::Pixel> {
     std::size_t operator()(image::Pixel const & pixel) const noexcept {
-      std::size_t const hash1 = std::hash<unsigned short>{}(pixel.red);
-      std::size_t const hash2 = std::hash<unsigned short>{}(pixel.green);
-      std::size_t const hash3 = std::hash<unsigned short>{}(pixel.blue);
-
-      return hash1 ^ (hash2 << 1) ^ (hash3 << 3);
+      return image::mixColor(image::packColor(pixel.red, pixel.green, pixel.blue));
     }
 };
@@ -0,0 +1,116 @@
+#include <common/compressed.hpp>
+#include <common/info.hpp>
+#include <common/pixelio.hpp>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace image {
+  namespace {
+    constexpr unsigned char FIRST_PRINTABLE = 0x20;
+
+    void writeJsonString(std::ostream & out, std::string const & value) {
+      out << '"';
+      for (char const character : value) {
+        if (character == '"' || character == '\\') {
+          out << '\\' << character;
+        } else if (static_cast<unsigned char>(character) < FIRST_PRINTABLE) {
+          out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+              << static_cast<unsigned>(character) << std::dec << std::setfill(' ');
+        } else {
+          out << character;
+        }
+      }
+      out << '"';
+    }
+  }  // namespace
+
+  char const * toString(PayloadStatus const status) {
+    switch (status) {
+      case PayloadStatus::Ok:
+        return "ok";
+      case PayloadStatus::Truncated:
+        return "truncated";
+      case PayloadStatus::TrailingData:
+        return "trailing-data";
+      case PayloadStatus::Unchecked:
+        return "unchecked";
+      default:
+        return "invalid";
+    }
+  }
+
+  FileInfo probeFile(std::string const & filePath) {
+    FileInfo info;
+    info.filePath = filePath;
+
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open file: " << filePath << '\n';
+      return info;
+    }
+    // Con un fichero comprimido el tamaño esperado es el de la tabla de colores y los índices
+    if (file.peek() == 'C') {
+      CompressFormat format{};
+      unsigned long colorTableSize = 0;
+      if (!info.header.readHeaderCompress(file, format, colorTableSize)) { return info; }
+      auto const payload = compressedPayload(info.header, format, colorTableSize);
+      if (!payload) {
+        std::cerr << "Invalid compressed dimensions: " << info.header.getWidth() << 'x'
+                  << info.header.getHeight() << '\n';
+        return info;
+      }
+      info.expectedSize = payload->tableBytes + payload->indexBytes;
+    } else {
+      if (!info.header.readHeader(file)) { return info; }
+      info.expectedSize = info.header.getWidth() * info.header.getHeight() * CHANNELS *
+                          bytesPerSample(info.header.getMaxColorValue());
+    }
+
+    std::streamoff const dataOffset = file.tellg();
+
+    struct stat status{};
+    if (dataOffset < 0 || stat(filePath.c_str(), &status) != 0 || !S_ISREG(status.st_mode)) {
+      info.status = PayloadStatus::Unchecked;
+      return info;
+    }
+
+    info.expectedSize += static_cast<std::uintmax_t>(dataOffset);
+    info.fileSize      = static_cast<std::uintmax_t>(status.st_size);
+    if (info.fileSize < info.expectedSize) {
+      info.status = PayloadStatus::Truncated;
+    } else if (info.fileSize > info.expectedSize) {
+      info.status = PayloadStatus::TrailingData;
+    } else {
+      info.status = PayloadStatus::Ok;
+    }
+    return info;
+  }
+
+  void printFileInfo(std::ostream & out, FileInfo const & info, bool const json) {
+    if (!json) {
+      out << info.filePath << '\t' << info.header.getWidth() << '\t' << info.header.getHeight()
+          << '\t' << info.header.getMaxColorValue() << '\t' << toString(info.status) << '\n';
+      return;
+    }
+
+    out << "{\"file\":";
+    writeJsonString(out, info.filePath);
+    out << ",\"width\":" << info.header.getWidth() << ",\"height\":" << info.header.getHeight()
+        << ",\"maxColorValue\":" << info.header.getMaxColorValue()
+        << ",\"fileSize\":" << info.fileSize << ",\"expectedSize\":" << info.expectedSize
+        << ",\"status\":\"" << toString(info.status) << "\"}\n";
+  }
+
+  bool printFileInfos(std::ostream & out, std::vector<std::string> const & filePaths,
+                      bool const json) {
+    bool allValid = true;
+    for (auto const & filePath : filePaths) {
+      FileInfo const info = probeFile(filePath);
+      allValid            = allValid && info.status != PayloadStatus::Invalid;
+      printFileInfo(out, info, json);
+    }
+    return allValid;
+  }
+}  // namespace image
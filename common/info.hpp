@@ -0,0 +1,31 @@
+#pragma once
+
+#include <common/image.hpp>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace image {
+  enum class PayloadStatus : std::uint8_t { Ok, Truncated, TrailingData, Unchecked, Invalid };
+
+  // Metadatos de un fichero obtenidos solo de su cabecera, sin leer los píxeles
+  struct FileInfo {
+      std::string filePath;
+      Image header;
+      std::uintmax_t fileSize     = 0;
+      std::uintmax_t expectedSize = 0;
+      PayloadStatus status        = PayloadStatus::Invalid;
+  };
+
+  [[nodiscard]] char const * toString(PayloadStatus status);
+
+  // Lee la cabecera y compara el tamaño esperado de los datos con el tamaño real del fichero
+  [[nodiscard]] FileInfo probeFile(std::string const & filePath);
+
+  // Escribe una línea por fichero, en texto separado por tabuladores o en JSON
+  void printFileInfo(std::ostream & out, FileInfo const & info, bool json);
+
+  // Analiza varios ficheros en un solo proceso; devuelve false si alguno no es válido
+  bool printFileInfos(std::ostream & out, std::vector<std::string> const & filePaths, bool json);
+}  // namespace image
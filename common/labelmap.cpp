@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <common/bitpack.hpp>
+#include <common/colorindex.hpp>
+#include <common/image.hpp>
+#include <common/labelmap.hpp>
+#include <common/threadpool.hpp>
+#include <iomanip>
+
+namespace image {
+  namespace {
+    // Píxeles por parte en el etiquetado y por bloque en las pasadas que solo indexan
+    constexpr std::size_t LABEL_PIXELS_PER_PART = std::size_t{1} << 16;
+    constexpr std::size_t GATHER_GRAIN          = std::size_t{1} << 16;
+
+    constexpr unsigned BYTE_BITS        = 8;
+    constexpr std::uint32_t BYTE_MASK   = 0xFF;
+    constexpr double BYTES_PER_MEBIBYTE = 1024.0 * 1024.0;
+    constexpr int MEBIBYTE_PRECISION    = 2;
+
+    // Etiquetas locales de una parte. En las tablas se guarda etiqueta + 1 para distinguir los
+    // colores nuevos (valor 0)
+    struct LabelPart {
+        FlatColorMap<std::uint32_t> ids;
+        std::vector<PackedColor> colors;
+        std::vector<std::uint32_t> counts;
+    };
+
+    std::uint32_t labelFor(FlatColorMap<std::uint32_t> & ids, std::vector<PackedColor> & colors,
+                           std::vector<std::uint32_t> & counts, PackedColor const color) {
+      std::uint32_t & id = ids[color];
+      if (id == 0) {
+        colors.push_back(color);
+        counts.push_back(0);
+        id = static_cast<std::uint32_t>(colors.size());
+      }
+      return id - 1;
+    }
+
+    void labelPart(PixelChannels const & pixels, PixelRange const range,
+                   std::span<std::uint32_t> labels, LabelPart & part) {
+      for (std::size_t pixel = range.first; pixel < range.last; ++pixel) {
+        std::uint32_t const label =
+            labelFor(part.ids, part.colors, part.counts, pixels.colorAt(pixel));
+        labels[pixel] = label;
+        ++part.counts[label];
+      }
+    }
+
+    // Recorre las partes en orden de píxel, así que los colores globales quedan en orden de
+    // primera aparición. Devuelve, para cada parte, la traducción de etiqueta local a global.
+    std::vector<std::vector<std::uint32_t>> mergeParts(std::vector<LabelPart> const & parts,
+                                                       ColorLabels & result) {
+      FlatColorMap<std::uint32_t> ids;
+      std::vector<std::vector<std::uint32_t>> remaps(parts.size());
+      for (std::size_t index = 0; index < parts.size(); ++index) {
+        LabelPart const & part = parts[index];
+        remaps[index].resize(part.colors.size());
+        for (std::size_t local = 0; local < part.colors.size(); ++local) {
+          std::uint32_t const label =
+              labelFor(ids, result.colors, result.counts, part.colors[local]);
+          remaps[index][local]  = label;
+          result.counts[label] += part.counts[local];
+        }
+      }
+      return remaps;
+    }
+  }  // namespace
+
+  std::size_t ColorLabels::memoryBytes() const {
+    return (labels.capacity() * sizeof(std::uint32_t)) +
+           (colors.capacity() * sizeof(PackedColor)) + (counts.capacity() * sizeof(std::uint32_t));
+  }
+
+  ColorLabels labelColors(PixelChannels const & pixels) {
+    ColorLabels result;
+    result.labels.resize(pixels.count);
+    std::span<std::uint32_t> const labels(result.labels);
+    std::size_t const partTotal = partCount(pixels.count, LABEL_PIXELS_PER_PART);
+    std::vector<LabelPart> parts(partTotal);
+    threadpool::parallelFor(0, partTotal, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t part = first; part < last; ++part) {
+        labelPart(pixels, partRange(pixels.count, partTotal, part), labels, parts[part]);
+      }
+    });
+
+    auto const remaps = mergeParts(parts, result);
+    threadpool::parallelFor(0, partTotal, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t part = first; part < last; ++part) {
+        PixelRange const range = partRange(pixels.count, partTotal, part);
+        for (std::size_t pixel = range.first; pixel < range.last; ++pixel) {
+          labels[pixel] = remaps[part][labels[pixel]];
+        }
+      }
+    });
+    return result;
+  }
+
+  std::vector<ColorFrequency> labeledHistogram(ColorLabels const & labels) {
+    std::vector<ColorFrequency> histogram(labels.colors.size());
+    for (std::size_t label = 0; label < histogram.size(); ++label) {
+      histogram[label] = {.color = labels.colors[label], .count = labels.counts[label]};
+    }
+    std::ranges::sort(histogram, {}, &ColorFrequency::color);
+    return histogram;
+  }
+
+  void replaceLabeledColors(WritablePixelChannels const & pixels, ColorLabels const & labels,
+                            ReplacementTable const & replacements) {
+    std::vector<PackedColor> byLabel(labels.colors.size(), EMPTY_PACKED_SLOT);
+    for (std::size_t label = 0; label < byLabel.size(); ++label) {
+      if (auto const * replacement = replacements.find(labels.colors[label])) {
+        byLabel[label] = *replacement;
+      }
+    }
+    threadpool::parallelFor(
+        0, pixels.count,
+        [&](std::size_t const first, std::size_t const last) {
+          for (std::size_t pixel = first; pixel < last; ++pixel) {
+            PackedColor const replacement = byLabel[labels.labels[pixel]];
+            if (replacement == EMPTY_PACKED_SLOT) { continue; }
+            auto const [red, green, blue]             = unpackColor(replacement);
+            pixels.channels[0][pixel * pixels.stride] = red;
+            pixels.channels[1][pixel * pixels.stride] = green;
+            pixels.channels[2][pixel * pixels.stride] = blue;
+          }
+        },
+        GATHER_GRAIN);
+  }
+
+  bool writeLabeledCompress(std::ofstream & file, ColorLabels const & labels,
+                            unsigned short const maxColorValue, CompressFormat const format) {
+    if (!writeCompressColorTable(file, labels.colors, maxColorValue)) { return false; }
+
+    if (format == CompressFormat::BitPacked) {
+      std::vector<char> const packed = packIndices(
+          labels.labels.size(), indexBitWidth(labels.colors.size()),
+          [&](std::size_t const first, std::span<std::uint32_t> indices) {
+            std::copy_n(labels.labels.begin() + static_cast<std::ptrdiff_t>(first),
+                        indices.size(), indices.begin());
+          });
+      file.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+      return file.good();
+    }
+
+    // Índices en little endian, con el ancho mínimo para el número de colores
+    std::size_t const indexBytes = indexByteSize(labels.colors.size());
+    std::vector<char> indices(labels.labels.size() * indexBytes);
+    threadpool::parallelFor(
+        0, labels.labels.size(),
+        [&](std::size_t const first, std::size_t const last) {
+          for (std::size_t pixel = first; pixel < last; ++pixel) {
+            for (std::size_t byte = 0; byte < indexBytes; ++byte) {
+              indices[(pixel * indexBytes) + byte] =
+                  static_cast<char>((labels.labels[pixel] >> (byte * BYTE_BITS)) & BYTE_MASK);
+            }
+          }
+        },
+        GATHER_GRAIN);
+    file.write(indices.data(), static_cast<std::streamsize>(indices.size()));
+    return file.good();
+  }
+
+  void reportLabelMemory(std::ostream & out, ColorLabels const & labels) {
+    out << "Label map: " << labels.labels.size() << " pixels, " << labels.colors.size()
+        << " colors, " << std::fixed << std::setprecision(MEBIBYTE_PRECISION)
+        << static_cast<double>(labels.memoryBytes()) / BYTES_PER_MEBIBYTE << " MiB\n";
+  }
+}  // namespace image
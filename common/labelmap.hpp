@@ -0,0 +1,45 @@
+#pragma once
+
+#include <common/colormap.hpp>
+#include <common/histogram.hpp>
+#include <common/image.hpp>
+#include <common/replacement.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Etiqueta de color de cada píxel. Las etiquetas son índices densos asignados por orden de
+  // primera aparición (el mismo orden de la tabla de colores de compress); `colors` y `counts`
+  // dan el color y la frecuencia de cada etiqueta. Con ellas, la segunda fase de cutfreq y de
+  // compress se reduce a indexar arrays pequeños en lugar de volver a buscar cada color.
+  struct ColorLabels {
+      std::vector<std::uint32_t> labels;
+      std::vector<PackedColor> colors;
+      std::vector<std::uint32_t> counts;
+
+      // Memoria ocupada por los tres vectores, en bytes
+      [[nodiscard]] std::size_t memoryBytes() const;
+  };
+
+  // Etiqueta los píxeles en paralelo: cada hilo etiqueta una parte con su propia tabla y las
+  // etiquetas locales se traducen después a las globales
+  [[nodiscard]] ColorLabels labelColors(PixelChannels const & pixels);
+
+  // Histograma ordenado por color, igual que el de countColors
+  [[nodiscard]] std::vector<ColorFrequency> labeledHistogram(ColorLabels const & labels);
+
+  // Aplica `replacements` a los píxeles consultando una vez cada etiqueta y no cada píxel
+  void replaceLabeledColors(WritablePixelChannels const & pixels, ColorLabels const & labels,
+                            ReplacementTable const & replacements);
+
+  // Tabla de colores e índices de píxel de un fichero comprimido (todo salvo la cabecera)
+  [[nodiscard]] bool writeLabeledCompress(std::ofstream & file, ColorLabels const & labels,
+                                          unsigned short maxColorValue,
+                                          CompressFormat format = CompressFormat::ByteAligned);
+
+  void reportLabelMemory(std::ostream & out, ColorLabels const & labels);
+}  // namespace image
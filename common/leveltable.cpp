@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <common/cpu.hpp>
+#include <common/leveltable.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace image {
+  namespace {
+    // Muestras por bloque de trabajo: suficientes para amortizar el reparto entre hilos
+    constexpr std::size_t APPLY_GRAIN = std::size_t{1} << 16;
+
+    void applyScalar(std::span<unsigned short const> levels, std::span<unsigned short> samples) {
+      for (unsigned short & sample : samples) { sample = levels[sample]; }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    constexpr std::size_t AVX2_SAMPLES = 16;
+    constexpr int LEVEL_LOW_BITS       = 0xFFFF;
+
+    // Ocho búsquedas con un gather de 32 bits sobre la tabla de 16 bits; la entrada de relleno
+    // permite leer la palabra siguiente a la última
+    [[gnu::target("avx2")]] __m256i lookupLanes(std::span<unsigned short const> levels,
+                                                __m128i const samples) {
+      __m256i const index = _mm256_cvtepu16_epi32(samples);
+      __m256i const words =
+          _mm256_i32gather_epi32(reinterpret_cast<int const *>(levels.data()), index, 2);  // NOLINT
+      return _mm256_and_si256(words, _mm256_set1_epi32(LEVEL_LOW_BITS));
+    }
+
+    [[gnu::target("avx2")]] std::size_t applyAvx2(std::span<unsigned short const> levels,
+                                                  std::span<unsigned short> samples) {
+      std::size_t index = 0;
+      for (; index + AVX2_SAMPLES <= samples.size(); index += AVX2_SAMPLES) {
+        auto * block       = reinterpret_cast<__m256i *>(samples.subspan(index).data());  // NOLINT
+        __m256i const data = _mm256_loadu_si256(block);
+        __m256i const low  = lookupLanes(levels, _mm256_castsi256_si128(data));
+        __m256i const high = lookupLanes(levels, _mm256_extracti128_si256(data, 1));
+        // packus mezcla las mitades de 128 bits; el permute devuelve el orden original
+        _mm256_storeu_si256(block, _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high),
+                                                            _MM_SHUFFLE(3, 1, 2, 0)));
+      }
+      return index;
+    }
+#endif
+
+    void applyBlock(std::span<unsigned short const> levels, std::span<unsigned short> samples) {
+      std::size_t done = 0;
+#if defined(__x86_64__) || defined(__i386__)
+      if (cpuHasAvx2()) { done = applyAvx2(levels, samples); }
+#endif
+      applyScalar(levels, samples.subspan(done));
+    }
+  }  // namespace
+
+  LevelTable::LevelTable(unsigned short const oldMaxColorValue,
+                         unsigned short const newMaxColorValue)
+    : levels_(LEVEL_COUNT + 1) {
+    if (oldMaxColorValue == 0) { return; }
+    for (std::size_t level = 0; level < LEVEL_COUNT; ++level) {
+      std::uint64_t const scaled = std::uint64_t{level} * newMaxColorValue / oldMaxColorValue;
+      levels_[level] =
+          static_cast<unsigned short>(std::min<std::uint64_t>(scaled, newMaxColorValue));
+    }
+  }
+
+  LevelTable::LevelTable(LevelTable const & first, LevelTable const & second)
+    : levels_(LEVEL_COUNT + 1) {
+    for (std::size_t level = 0; level < LEVEL_COUNT; ++level) {
+      levels_[level] = second[first[static_cast<unsigned short>(level)]];
+    }
+  }
+
+  void LevelTable::apply(std::span<unsigned short> samples) const {
+    std::span<unsigned short const> const levels(levels_);
+    threadpool::parallelFor(
+        0, samples.size(),
+        [levels, samples](std::size_t const first, std::size_t const last) {
+          applyBlock(levels, samples.subspan(first, last - first));
+        },
+        APPLY_GRAIN);
+  }
+
+  void LevelTable::applyRow(std::span<unsigned short> samples) const {
+    applyBlock(levels_, samples);
+  }
+}  // namespace image
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Niveles distintos que puede tener una muestra de 16 bits
+  constexpr std::size_t LEVEL_COUNT = std::size_t{1} << 16;
+
+  // Tabla de conversión de niveles para maxlevel: la entrada v vale floor(v * nuevo / anterior),
+  // calculado en enteros (sin el error de truncado de multiplicar por un factor en float) y
+  // recortado al nuevo máximo (si el máximo anterior es 0, todas las entradas valen 0). Lleva una
+  // entrada de relleno al final para las lecturas vectoriales.
+  class LevelTable {
+    public:
+      LevelTable(unsigned short oldMaxColorValue, unsigned short newMaxColorValue);
+      // Composición: aplicar la tabla equivale a aplicar `first` y después `second`
+      LevelTable(LevelTable const & first, LevelTable const & second);
+
+      [[nodiscard]] unsigned short operator[](unsigned short const level) const {
+        return levels_[level];
+      }
+
+      // Sustituye cada muestra por su nivel en la tabla, repartiendo el trabajo entre los hilos
+      void apply(std::span<unsigned short> samples) const;
+      // Igual que apply pero en el hilo que llama, para las filas que ya calcula un hilo del pool
+      void applyRow(std::span<unsigned short> samples) const;
+
+    private:
+      std::vector<unsigned short> levels_;
+  };
+}  // namespace image
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <common/colorsearch.hpp>
+#include <common/histogram.hpp>
+#include <common/leveltable.hpp>
+#include <common/paletteimage.hpp>
+#include <common/replacement.hpp>
+#include <vector>
+
+namespace image {
+  namespace {
+    // Histograma ordenado por color, como el de countColors: las entradas sin píxeles no
+    // aparecen y las repetidas se suman
+    std::vector<ColorFrequency> paletteHistogram(std::vector<PackedColor> const & colors,
+                                                 std::vector<std::uint32_t> const & counts) {
+      std::vector<ColorFrequency> histogram;
+      for (std::size_t index = 0; index < colors.size(); ++index) {
+        if (counts[index] != 0) {
+          histogram.push_back({.color = colors[index], .count = counts[index]});
+        }
+      }
+      std::ranges::sort(histogram, {}, &ColorFrequency::color);
+
+      std::vector<ColorFrequency> merged;
+      for (ColorFrequency const & entry : histogram) {
+        if (!merged.empty() && merged.back().color == entry.color) {
+          merged.back().count += entry.count;
+        } else {
+          merged.push_back(entry);
+        }
+      }
+      return merged;
+    }
+  }  // namespace
+
+  bool PaletteImage::loadFromFile(std::string const & filePath) {
+    return readCompressed(filePath, compressed_);
+  }
+
+  bool PaletteImage::saveToFile(std::string const & filePath) const {
+    return writeCompressed(filePath, compressed_);
+  }
+
+  void PaletteImage::modifyMaxLevel(unsigned short const newMaxColorValue) {
+    LevelTable const levels(compressed_.header.getMaxColorValue(), newMaxColorValue);
+    for (PackedColor & color : compressed_.colors) {
+      auto const [red, green, blue] = unpackColor(color);
+      color                         = packColor(levels[red], levels[green], levels[blue]);
+    }
+    compressed_.header.setMaxColorValue(newMaxColorValue);
+  }
+
+  bool PaletteImage::cutfreq(std::uint32_t const n) {
+    std::vector<std::uint32_t> counts;
+    if (!countIndices(compressed_, counts)) { return false; }
+
+    auto const [colorsToRemove, remainingColors] =
+        splitLeastFrequent(paletteHistogram(compressed_.colors, counts), n);
+    auto const replacements = nearestColors(remainingColors, colorsToRemove);
+    ReplacementTable const table = replacementTable(colorsToRemove, replacements);
+    for (PackedColor & color : compressed_.colors) {
+      if (auto const * replacement = table.find(color)) { color = *replacement; }
+    }
+    return true;
+  }
+}  // namespace image
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <common/compressed.hpp>
+#include <cstdint>
+#include <string>
+
+namespace image {
+  // Imagen comprimida (C6 o C6v2) sin expandir: las operaciones que solo dependen del color de
+  // cada píxel reescriben la tabla de colores y copian el flujo de índices tal cual, así que su
+  // coste depende del número de colores y no del de píxeles. La tabla puede acabar con colores
+  // repetidos; el fichero sigue siendo válido y se expande a los mismos píxeles que la operación
+  // sobre la imagen expandida.
+  class PaletteImage {
+    public:
+      [[nodiscard]] bool loadFromFile(std::string const & filePath);
+      // Mismo formato de índices que el fichero leído
+      [[nodiscard]] bool saveToFile(std::string const & filePath) const;
+
+      // Cada entrada de la tabla pasa por la misma LevelTable que las muestras de los píxeles
+      void modifyMaxLevel(unsigned short newMaxColorValue);
+
+      // Las frecuencias salen del histograma de índices (sumando las entradas con el mismo color)
+      // y las sustituciones se aplican a la tabla. Devuelve false si algún índice no está en la
+      // tabla de colores.
+      [[nodiscard]] bool cutfreq(std::uint32_t n);
+
+    private:
+      CompressedImage compressed_;
+  };
+}  // namespace image
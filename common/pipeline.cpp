@@ -0,0 +1,38 @@
+#include <common/pipeline.hpp>
+
+namespace image {
+  namespace {
+    // Operaciones cuyo bucle de salida puede aplicar una LevelTable a cada fila
+    bool fusesLevels(progargs::Stage const & stage) {
+      return stage.operation == progargs::MaxLevel ||
+             (stage.operation == progargs::Resize &&
+              stage.resizeMethod == progargs::ResizeMethod::Default);
+    }
+  }  // namespace
+
+  std::vector<PipelineStep> fusePipeline(std::vector<progargs::Stage> const & stages) {
+    std::vector<PipelineStep> steps;
+    for (progargs::Stage const & stage : stages) {
+      auto const maxLevel = static_cast<unsigned short>(
+          stage.operation == progargs::MaxLevel ? stage.args[0] : 0);
+      if (stage.operation == progargs::MaxLevel && !steps.empty() &&
+          fusesLevels(steps.back().stage)) {
+        steps.back().maxLevels.push_back(maxLevel);
+        continue;
+      }
+      steps.push_back({.stage = stage, .maxLevels = {}});
+      if (stage.operation == progargs::MaxLevel) { steps.back().maxLevels.push_back(maxLevel); }
+    }
+    return steps;
+  }
+
+  LevelTable chainLevels(unsigned short maxColorValue, std::span<unsigned short const> maxLevels) {
+    LevelTable levels(maxColorValue, maxLevels.front());
+    maxColorValue = maxLevels.front();
+    for (unsigned short const maxLevel : maxLevels.subspan(1)) {
+      levels        = LevelTable(levels, LevelTable(maxColorValue, maxLevel));
+      maxColorValue = maxLevel;
+    }
+    return levels;
+  }
+}  // namespace image
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <common/leveltable.hpp>
+#include <common/progargs.hpp>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Paso de una cadena de operaciones una vez fusionados los maxlevel. Los maxlevel que siguen a
+  // un resize por defecto pasan a `maxLevels` y se aplican en su bucle de salida; los que siguen a
+  // otro maxlevel se componen con él en una sola tabla. En un paso maxlevel, `maxLevels` empieza
+  // por el suyo.
+  struct PipelineStep {
+      progargs::Stage stage;
+      std::vector<unsigned short> maxLevels;
+  };
+
+  [[nodiscard]] std::vector<PipelineStep> fusePipeline(std::vector<progargs::Stage> const & stages);
+
+  // Tabla de aplicar uno tras otro los maxlevel de `maxLevels` a una imagen de valor máximo
+  // `maxColorValue`
+  [[nodiscard]] LevelTable chainLevels(unsigned short maxColorValue,
+                                       std::span<unsigned short const> maxLevels);
+}  // namespace image
@@ -0,0 +1,222 @@
+#include <array>
+#include <common/image.hpp>
+#include <common/pixelio.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSSE3__)
+  #include <immintrin.h>
+#endif
+
+namespace image {
+  namespace {
+    std::span<unsigned char const> mapFile(std::string const & filePath) {
+      int const descriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);  // NOLINT
+      if (descriptor < 0) { return {}; }
+
+      struct stat status{};
+      if (fstat(descriptor, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size <= 0) {
+        close(descriptor);
+        return {};
+      }
+
+      auto const size = static_cast<std::size_t>(status.st_size);
+      void * address  = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+      close(descriptor);
+      if (address == MAP_FAILED) { return {}; }  // NOLINT
+
+      madvise(address, size, MADV_SEQUENTIAL);
+      return {static_cast<unsigned char const *>(address), size};
+    }
+
+#if defined(__SSSE3__)
+    constexpr std::size_t SIMD_BYTES          = 16;
+    constexpr std::size_t SIMD_WIDE_SAMPLES   = SIMD_BYTES / 2;
+    constexpr std::size_t SIMD_NARROW_SAMPLES = SIMD_BYTES;
+    constexpr unsigned char ZERO_LANE         = 0x80;
+
+    using ShuffleMask = std::array<unsigned char, SIMD_BYTES>;
+
+    // Máscara que intercambia los bytes de cada muestra de 16 bits
+    constexpr ShuffleMask SWAP_MASK = [] {
+      ShuffleMask mask{};
+      for (std::size_t i = 0; i < SIMD_BYTES; ++i) {
+        mask[i] = static_cast<unsigned char>(i ^ 1U);
+      }
+      return mask;
+    }();
+
+    // Máscaras pshufb que llevan los bytes de cada plano a su posición RGB en cada bloque de salida
+    using InterleaveMasks = std::array<std::array<ShuffleMask, CHANNELS>, CHANNELS>;
+
+    constexpr InterleaveMasks makeInterleaveMasks(std::size_t const sampleBytes) {
+      InterleaveMasks masks{};
+      for (std::size_t block = 0; block < CHANNELS; ++block) {
+        for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+          for (std::size_t lane = 0; lane < SIMD_BYTES; ++lane) {
+            std::size_t const byte   = (block * SIMD_BYTES) + lane;
+            std::size_t const pixel  = byte / (CHANNELS * sampleBytes);
+            std::size_t const offset = byte % (CHANNELS * sampleBytes);
+            std::size_t const source =
+                sampleBytes == 2 ? (2 * pixel) + (1 - (offset % 2)) : pixel;
+            masks[block][channel][lane] = offset / sampleBytes == channel
+                                              ? static_cast<unsigned char>(source)
+                                              : ZERO_LANE;
+          }
+        }
+      }
+      return masks;
+    }
+
+    constexpr InterleaveMasks WIDE_INTERLEAVE   = makeInterleaveMasks(2);
+    constexpr InterleaveMasks NARROW_INTERLEAVE = makeInterleaveMasks(1);
+
+    __m128i loadMask(ShuffleMask const & mask) {
+      return _mm_loadu_si128(reinterpret_cast<__m128i const *>(mask.data()));  // NOLINT
+    }
+
+    __m128i loadSamples(std::span<unsigned short const> samples, std::size_t const index) {
+      return _mm_loadu_si128(
+          reinterpret_cast<__m128i const *>(samples.subspan(index).data()));  // NOLINT
+    }
+
+    void storeBytes(std::span<unsigned char> out, std::size_t const index, __m128i const value) {
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out.subspan(index).data()), value);  // NOLINT
+    }
+
+    struct ChannelRegisters {
+        __m128i red;
+        __m128i green;
+        __m128i blue;
+    };
+
+    // Combina tres registros (uno por canal) en tres bloques consecutivos de salida
+    void interleave(InterleaveMasks const & masks, ChannelRegisters const & channels,
+                    std::span<unsigned char> out) {
+      for (std::size_t block = 0; block < CHANNELS; ++block) {
+        auto const & blockMasks = masks.at(block);
+        __m128i const merged    = _mm_or_si128(
+            _mm_or_si128(_mm_shuffle_epi8(channels.red, loadMask(blockMasks[0])),
+                            _mm_shuffle_epi8(channels.green, loadMask(blockMasks[1]))),
+            _mm_shuffle_epi8(channels.blue, loadMask(blockMasks[2])));
+        storeBytes(out, block * SIMD_BYTES, merged);
+      }
+    }
+#endif
+  }  // namespace
+
+  std::size_t bytesPerSample(unsigned short const maxColorValue) {
+    return maxColorValue > MAX_COLOR_VALUE_8BIT ? 2 : 1;
+  }
+
+  PixelSource::PixelSource(std::ifstream & file, std::string const & filePath) : file_(file) {
+    std::streamoff const dataOffset = file_.tellg();
+    if (dataOffset < 0) { return; }
+
+    mapped_ = mapFile(filePath);
+    if (mapped_.size() < static_cast<std::size_t>(dataOffset)) {
+      if (!mapped_.empty()) {
+        munmap(const_cast<unsigned char *>(mapped_.data()), mapped_.size());  // NOLINT
+      }
+      mapped_ = {};
+      return;
+    }
+    offset_ = static_cast<std::size_t>(dataOffset);
+  }
+
+  PixelSource::~PixelSource() {
+    if (!mapped_.empty()) {
+      munmap(const_cast<unsigned char *>(mapped_.data()), mapped_.size());  // NOLINT
+    }
+  }
+
+  std::span<unsigned char const> PixelSource::next(std::size_t const count) {
+    if (isMapped()) {
+      if (count > mapped_.size() - offset_) { return {}; }
+      std::span<unsigned char const> const bytes = mapped_.subspan(offset_, count);
+      offset_                                   += count;
+      return bytes;
+    }
+
+    buffer_.resize(count);
+    file_.read(reinterpret_cast<char *>(buffer_.data()),  // NOLINT
+               static_cast<std::streamsize>(count));
+    if (static_cast<std::size_t>(file_.gcount()) != count) { return {}; }
+    return buffer_;
+  }
+
+  void encodeSamples(std::span<unsigned short const> samples, std::size_t const sampleBytes,
+                     std::span<unsigned char> out) {
+    std::size_t index = 0;
+#if defined(__SSSE3__)
+    if (sampleBytes == 2) {
+      __m128i const swap = loadMask(SWAP_MASK);
+      for (; index + SIMD_WIDE_SAMPLES <= samples.size(); index += SIMD_WIDE_SAMPLES) {
+        storeBytes(out, index * 2, _mm_shuffle_epi8(loadSamples(samples, index), swap));
+      }
+    } else {
+      __m128i const low = _mm_set1_epi16(static_cast<short>(SAMPLE_MASK));
+      for (; index + SIMD_NARROW_SAMPLES <= samples.size(); index += SIMD_NARROW_SAMPLES) {
+        storeBytes(out, index,
+                   _mm_packus_epi16(_mm_and_si128(loadSamples(samples, index), low),
+                                    _mm_and_si128(loadSamples(samples, index + SIMD_WIDE_SAMPLES),
+                                                  low)));
+      }
+    }
+#endif
+
+    for (; index < samples.size(); ++index) {
+      if (sampleBytes == 2) {
+        storeWideSample(out, index * 2, samples[index]);
+      } else {
+        out[index] = static_cast<unsigned char>(samples[index]);
+      }
+    }
+  }
+
+  void encodePlanes(PlaneRow const & planes, std::size_t const sampleBytes,
+                    std::span<unsigned char> out) {
+    std::size_t const width = planes.red.size();
+    std::size_t xPos        = 0;
+#if defined(__SSSE3__)
+    if (sampleBytes == 2) {
+      for (; xPos + SIMD_WIDE_SAMPLES <= width; xPos += SIMD_WIDE_SAMPLES) {
+        interleave(WIDE_INTERLEAVE,
+                   {.red   = loadSamples(planes.red, xPos),
+                    .green = loadSamples(planes.green, xPos),
+                    .blue  = loadSamples(planes.blue, xPos)},
+                   out.subspan(xPos * CHANNELS * 2));
+      }
+    } else {
+      __m128i const low = _mm_set1_epi16(static_cast<short>(SAMPLE_MASK));
+      auto const narrow = [low](std::span<unsigned short const> plane, std::size_t const index) {
+        return _mm_packus_epi16(_mm_and_si128(loadSamples(plane, index), low),
+                                _mm_and_si128(loadSamples(plane, index + SIMD_WIDE_SAMPLES), low));
+      };
+      for (; xPos + SIMD_NARROW_SAMPLES <= width; xPos += SIMD_NARROW_SAMPLES) {
+        interleave(NARROW_INTERLEAVE,
+                   {.red   = narrow(planes.red, xPos),
+                    .green = narrow(planes.green, xPos),
+                    .blue  = narrow(planes.blue, xPos)},
+                   out.subspan(xPos * CHANNELS));
+      }
+    }
+#endif
+
+    for (; xPos < width; ++xPos) {
+      if (sampleBytes == 2) {
+        std::size_t const base = xPos * CHANNELS * 2;
+        storeWideSample(out, base, planes.red[xPos]);
+        storeWideSample(out, base + 2, planes.green[xPos]);
+        storeWideSample(out, base + 4, planes.blue[xPos]);
+      } else {
+        std::size_t const base = xPos * CHANNELS;
+        out[base]              = static_cast<unsigned char>(planes.red[xPos]);
+        out[base + 1]          = static_cast<unsigned char>(planes.green[xPos]);
+        out[base + 2]          = static_cast<unsigned char>(planes.blue[xPos]);
+      }
+    }
+  }
+}  // namespace image
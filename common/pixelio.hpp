@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace image {
+  constexpr unsigned char SAMPLE_SHIFT   = 8;
+  constexpr unsigned short SAMPLE_MASK   = 0xFF;
+  constexpr std::size_t CHANNELS         = 3;
+  constexpr std::size_t WRITE_CHUNK_SIZE = std::size_t{1} << 20;
+
+  // Bytes que ocupa cada muestra en el fichero: 1 para imágenes de 8 bits, 2 para 16 bits
+  [[nodiscard]] std::size_t bytesPerSample(unsigned short maxColorValue);
+
+  // Acceso a los datos de píxeles que siguen a la cabecera. Si el fichero es regular se proyecta
+  // en memoria y los bytes se leen sin copias; en otro caso (tuberías, FIFOs) se lee por bloques.
+  class PixelSource {
+    public:
+      PixelSource(std::ifstream & file, std::string const & filePath);
+      ~PixelSource();
+      PixelSource(PixelSource const &)             = delete;
+      PixelSource & operator=(PixelSource const &) = delete;
+      PixelSource(PixelSource &&)                  = delete;
+      PixelSource & operator=(PixelSource &&)      = delete;
+
+      // Devuelve los siguientes `count` bytes, o un span vacío si el fichero termina antes
+      [[nodiscard]] std::span<unsigned char const> next(std::size_t count);
+
+      [[nodiscard]] bool isMapped() const { return !mapped_.empty(); }
+
+    private:
+      std::ifstream & file_;
+      std::span<unsigned char const> mapped_;
+      std::size_t offset_ = 0;
+      std::vector<unsigned char> buffer_;
+  };
+
+  // Decodifica una fila de muestras RGB big-endian y entrega cada píxel a `sink(index, r, g, b)`
+  template <typename Sink>
+  void decodeRow(std::span<unsigned char const> row, std::size_t sampleBytes, Sink && sink) {
+    if (sampleBytes == 2) {
+      std::size_t const pixels = row.size() / (CHANNELS * 2);
+      for (std::size_t i = 0; i < pixels; ++i) {
+        std::span<unsigned char const> const src = row.subspan(i * CHANNELS * 2, CHANNELS * 2);
+        auto const sample = [src](std::size_t const channel) {
+          return static_cast<unsigned short>((src[channel * 2] << SAMPLE_SHIFT) |
+                                             src[(channel * 2) + 1]);
+        };
+        sink(i, sample(0), sample(1), sample(2));
+      }
+      return;
+    }
+
+    std::size_t const pixels = row.size() / CHANNELS;
+    for (std::size_t i = 0; i < pixels; ++i) {
+      std::span<unsigned char const> const src = row.subspan(i * CHANNELS, CHANNELS);
+      sink(i, static_cast<unsigned short>(src[0]), static_cast<unsigned short>(src[1]),
+           static_cast<unsigned short>(src[2]));
+    }
+  }
+
+  inline void storeWideSample(std::span<unsigned char> out, std::size_t const offset,
+                              unsigned short const value) {
+    out[offset]     = static_cast<unsigned char>(value >> SAMPLE_SHIFT);
+    out[offset + 1] = static_cast<unsigned char>(value & SAMPLE_MASK);
+  }
+
+  // Codifica muestras ya entrelazadas (AOS) en el formato del fichero: intercambio de bytes para
+  // 16 bits y estrechamiento para 8 bits
+  void encodeSamples(std::span<unsigned short const> samples, std::size_t sampleBytes,
+                     std::span<unsigned char> out);
+
+  // Entrelaza una fila de los tres planos (SOA) directamente en el formato del fichero
+  struct PlaneRow {
+      std::span<unsigned short const> red;
+      std::span<unsigned short const> green;
+      std::span<unsigned short const> blue;
+  };
+
+  void encodePlanes(PlaneRow const & planes, std::size_t sampleBytes, std::span<unsigned char> out);
+
+  // Escribe `rows` filas de `rowBytes` bytes rellenando un búfer grande alineado a filas, de modo
+  // que la imagen se emite en pocas llamadas a write()
+  template <typename FillRow>
+  bool writeRows(std::ofstream & file, std::size_t rowBytes, std::size_t rows, FillRow && fillRow) {
+    if (rowBytes == 0) { return file.good(); }
+
+    std::size_t const rowsPerChunk = std::max<std::size_t>(1, WRITE_CHUNK_SIZE / rowBytes);
+    std::vector<char> buffer(std::min(rowsPerChunk, rows) * rowBytes);
+    auto * const data = reinterpret_cast<unsigned char *>(buffer.data());  // NOLINT
+    std::span<unsigned char> const bytes(data, buffer.size());
+
+    for (std::size_t first = 0; first < rows; first += rowsPerChunk) {
+      std::size_t const count = std::min(rowsPerChunk, rows - first);
+      for (std::size_t row = 0; row < count; ++row) {
+        fillRow(first + row, bytes.subspan(row * rowBytes, rowBytes));
+      }
+      file.write(buffer.data(), static_cast<std::streamsize>(count * rowBytes));
+    }
+    return file.good();
+  }
+}  // namespace image
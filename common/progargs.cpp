@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <common/progargs.hpp>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -10,36 +12,36 @@ namespace progargs {
       exit(-1);
     }
 
-    ParsedOperationArgs parseInfo(OperationArgs const & operationArgs) {
-      if (operationArgs.args.size() != ARG_COUNT_INFO) {
-        printErrorAndExit("Invalid number of extra arguments for info: " +
-                          std::to_string(operationArgs.args.size()));
-      }
+    // Los analizadores lanzan el error; parseOperation lo imprime y termina el proceso
+    [[noreturn]] void reject(std::string const & message) { throw ArgumentError(message); }
 
+    // Los argumentos extra de info son ficheros de entrada adicionales
+    ParsedOperationArgs parseInfo(OperationArgs const & operationArgs) {
       ParsedOperationArgs parsedArgs;
-      parsedArgs.inputFilePath = operationArgs.inputFilePath;
-      parsedArgs.operation     = Info;
+      parsedArgs.inputFilePath            = operationArgs.inputFilePath;
+      parsedArgs.operation                = Info;
+      parsedArgs.additionalInputFilePaths = operationArgs.args;
 
       return parsedArgs;
     }
 
     ParsedOperationArgs parseMaxLevel(OperationArgs const & operationArgs) {
       if (operationArgs.args.size() != ARG_COUNT_MAXLEVEL) {
-        printErrorAndExit("Invalid number of extra arguments for maxlevel: " +
-                          std::to_string(operationArgs.args.size()));
+        reject("Invalid number of extra arguments for maxlevel: " +
+               std::to_string(operationArgs.args.size()));
       }
 
       int maxLevel = 0;
       try {
         maxLevel = std::stoi(operationArgs.args[0]);
       } catch (std::invalid_argument const &) {
-        printErrorAndExit("Invalid maxlevel: " + operationArgs.args[0]);
+        reject("Invalid maxlevel: " + operationArgs.args[0]);
       } catch (std::out_of_range const &) {
-        printErrorAndExit("Invalid maxlevel (out of range): " + operationArgs.args[0]);
+        reject("Invalid maxlevel (out of range): " + operationArgs.args[0]);
       }
 
       if (maxLevel < MAX_LEVEL_MIN || maxLevel > MAX_LEVEL_MAX) {
-        printErrorAndExit("Invalid maxlevel: " + operationArgs.args[0]);
+        reject("Invalid maxlevel: " + operationArgs.args[0]);
       }
 
       ParsedOperationArgs parsedArgs;
@@ -51,10 +53,20 @@ namespace progargs {
       return parsedArgs;
     }
 
+    ResizeMethod parseResizeMethod(std::string const & method) {
+      if (method == RESIZE_METHOD_FIXED) { return ResizeMethod::Fixed; }
+      if (method == RESIZE_METHOD_BOX) { return ResizeMethod::Box; }
+      if (method == RESIZE_METHOD_BILINEAR) { return ResizeMethod::Bilinear; }
+      if (method == RESIZE_METHOD_BICUBIC) { return ResizeMethod::Bicubic; }
+      if (method == RESIZE_METHOD_LANCZOS3) { return ResizeMethod::Lanczos3; }
+      reject("Invalid resize method: " + method);
+    }
+
     ParsedOperationArgs parseResize(OperationArgs const & operationArgs) {
-      if (operationArgs.args.size() != ARG_COUNT_RESIZE) {
-        printErrorAndExit("Invalid number of extra arguments for resize: " +
-                          std::to_string(operationArgs.args.size()));
+      if (operationArgs.args.size() != ARG_COUNT_RESIZE &&
+          operationArgs.args.size() != ARG_COUNT_RESIZE_METHOD) {
+        reject("Invalid number of extra arguments for resize: " +
+               std::to_string(operationArgs.args.size()));
       }
 
       int width  = 0;
@@ -63,52 +75,65 @@ namespace progargs {
         width  = std::stoi(operationArgs.args[0]);
         height = std::stoi(operationArgs.args[1]);
       } catch (std::invalid_argument const &) {
-        printErrorAndExit("Invalid resize arguments: non-integer value provided");
+        reject("Invalid resize arguments: non-integer value provided");
       } catch (std::out_of_range const &) {
-        printErrorAndExit("Invalid resize arguments: value out of range");
+        reject("Invalid resize arguments: value out of range");
       }
 
-      if (width <= 0) { printErrorAndExit("Invalid resize width: " + operationArgs.args[0]); }
-      if (height <= 0) { printErrorAndExit("Invalid resize height: " + operationArgs.args[1]); }
+      if (width <= 0) { reject("Invalid resize width: " + operationArgs.args[0]); }
+      if (height <= 0) { reject("Invalid resize height: " + operationArgs.args[1]); }
 
       ParsedOperationArgs parsedArgs;
       parsedArgs.inputFilePath  = operationArgs.inputFilePath;
       parsedArgs.outputFilePath = operationArgs.outputFilePath;
       parsedArgs.operation      = Resize;
       parsedArgs.args = {static_cast<std::uint16_t>(width), static_cast<std::uint16_t>(height)};
+      if (operationArgs.args.size() == ARG_COUNT_RESIZE_METHOD) {
+        parsedArgs.resizeMethod = parseResizeMethod(operationArgs.args[2]);
+      }
 
       return parsedArgs;
     }
 
+    CutFreqMethod parseCutFreqMethod(std::string const & method) {
+      if (method == CUTFREQ_METHOD_EXACT) { return CutFreqMethod::Exact; }
+      if (method == CUTFREQ_METHOD_APPROXIMATE) { return CutFreqMethod::Approximate; }
+      reject("Invalid cutfreq method: " + method);
+    }
+
     ParsedOperationArgs parseCutFreq(OperationArgs const & operationArgs) {
-      if (operationArgs.args.size() != ARG_COUNT_CUTFREQ) {
-        printErrorAndExit("Invalid number of extra arguments for cutfreq: " +
-                          std::to_string(operationArgs.args.size()));
+      if (operationArgs.args.size() != ARG_COUNT_CUTFREQ &&
+          operationArgs.args.size() != ARG_COUNT_CUTFREQ_METHOD) {
+        reject("Invalid number of extra arguments for cutfreq: " +
+               std::to_string(operationArgs.args.size()));
       }
       std::uint32_t cutFreq = 0;
       try {
         cutFreq = static_cast<std::uint32_t>(std::stoul(operationArgs.args[0]));
       } catch (std::invalid_argument const &) {
-        printErrorAndExit("Invalid cutfreq: non-integer value provided");
+        reject("Invalid cutfreq: non-integer value provided");
       } catch (std::out_of_range const &) {
-        printErrorAndExit("Invalid cutfreq (out of range): " + operationArgs.args[0]);
+        reject("Invalid cutfreq (out of range): " + operationArgs.args[0]);
       }
 
-      if (cutFreq <= 0) { printErrorAndExit("Invalid cutfreq: " + operationArgs.args[0]); }
+      if (cutFreq <= 0) { reject("Invalid cutfreq: " + operationArgs.args[0]); }
 
       ParsedOperationArgs parsedArgs;
       parsedArgs.inputFilePath  = operationArgs.inputFilePath;
       parsedArgs.outputFilePath = operationArgs.outputFilePath;
       parsedArgs.operation      = CutFreq;
       parsedArgs.args           = {cutFreq};
+      if (operationArgs.args.size() == ARG_COUNT_CUTFREQ_METHOD) {
+        parsedArgs.cutFreqMethod = parseCutFreqMethod(operationArgs.args[1]);
+      }
 
       return parsedArgs;
     }
 
     ParsedOperationArgs parseCompress(OperationArgs const & operationArgs) {
       if (operationArgs.args.size() != ARG_COUNT_COMPRESS) {
-        printErrorAndExit("Invalid number of extra arguments for compress: " +
-                          std::to_string(operationArgs.args.size() - ARG_COUNT_COMPRESS));
+        reject("Invalid number of extra arguments for compress: " +
+               std::to_string(operationArgs.args.size() - ARG_COUNT_COMPRESS));
       }
 
       ParsedOperationArgs parsedArgs;
@@ -119,40 +144,258 @@ namespace progargs {
       return parsedArgs;
     }
 
+    // La entrada es un fichero C6 o C6v2 y la salida un PPM
+    ParsedOperationArgs parseDecompress(OperationArgs const & operationArgs) {
+      if (operationArgs.args.size() != ARG_COUNT_DECOMPRESS) {
+        reject("Invalid number of extra arguments for decompress: " +
+               std::to_string(operationArgs.args.size()));
+      }
+
+      ParsedOperationArgs parsedArgs;
+      parsedArgs.inputFilePath  = operationArgs.inputFilePath;
+      parsedArgs.outputFilePath = operationArgs.outputFilePath;
+      parsedArgs.operation      = Decompress;
+
+      return parsedArgs;
+    }
+
     OperationType mapOperationToEnum(std::string const & operation) {
       if (operation == "info") { return Info; }
       if (operation == "maxlevel") { return MaxLevel; }
       if (operation == "resize") { return Resize; }
       if (operation == "cutfreq") { return CutFreq; }
       if (operation == "compress") { return Compress; }
+      if (operation == "decompress") { return Decompress; }
       return Invalid;
     }
+
+    unsigned parseThreads(std::string const & value) {
+      int threads = 0;
+      try {
+        threads = std::stoi(value);
+      } catch (std::invalid_argument const &) {
+        reject("Invalid thread count: " + value);
+      } catch (std::out_of_range const &) {
+        reject("Invalid thread count (out of range): " + value);
+      }
+
+      if (threads < THREADS_MIN || threads > THREADS_MAX) {
+        reject("Invalid thread count: " + value);
+      }
+      return static_cast<unsigned>(threads);
+    }
+
+    std::size_t parseQueueDepth(std::string const & value) {
+      int depth = 0;
+      try {
+        depth = std::stoi(value);
+      } catch (std::invalid_argument const &) {
+        reject("Invalid queue depth: " + value);
+      } catch (std::out_of_range const &) {
+        reject("Invalid queue depth (out of range): " + value);
+      }
+
+      if (depth < QUEUE_DEPTH_MIN || depth > QUEUE_DEPTH_MAX) {
+        reject("Invalid queue depth: " + value);
+      }
+      return static_cast<std::size_t>(depth);
+    }
+
+    // Bytes con sufijo opcional K, M o G (potencias de 1024), p. ej. "512M"
+    std::size_t parseMemoryLimit(std::string const & value) {
+      std::size_t digits       = 0;
+      unsigned long long bytes = 0;
+      try {
+        bytes = std::stoull(value, &digits);
+      } catch (std::invalid_argument const &) {
+        reject("Invalid memory limit: " + value);
+      } catch (std::out_of_range const &) {
+        reject("Invalid memory limit (out of range): " + value);
+      }
+
+      std::string const suffix = value.substr(digits);
+      unsigned shift           = 0;
+      if (suffix == "K") {
+        shift = MEMORY_UNIT_SHIFT;
+      } else if (suffix == "M") {
+        shift = 2 * MEMORY_UNIT_SHIFT;
+      } else if (suffix == "G") {
+        shift = 3 * MEMORY_UNIT_SHIFT;
+      } else if (!suffix.empty()) {
+        reject("Invalid memory limit: " + value);
+      }
+      if (bytes == 0 || value.starts_with('-') || bytes > (SIZE_MAX >> shift)) {
+        reject("Invalid memory limit: " + value);
+      }
+      return static_cast<std::size_t>(bytes) << shift;
+    }
+
+    // Separa las opciones "--nombre [valor]" de los argumentos posicionales
+    std::vector<std::string> extractOptions(std::vector<std::string> const & args,
+                                            Options & options) {
+      std::vector<std::string> positional;
+      for (std::size_t i = 0; i < args.size(); ++i) {
+        std::string const & arg = args[i];
+        if (!arg.starts_with(OPTION_PREFIX)) {
+          positional.push_back(arg);
+          continue;
+        }
+        if (optionTakesValue(arg) && ++i == args.size()) {
+          reject("Missing value for option: " + arg);
+        }
+        if (arg == OPTION_JSON) {
+          options.json = true;
+        } else if (arg == OPTION_LABELS) {
+          options.labels = true;
+        } else if (arg == OPTION_PACKED) {
+          options.packed = true;
+        } else if (arg == OPTION_THREADS) {
+          options.threads = parseThreads(args[i]);
+        } else if (arg == OPTION_BATCH) {
+          options.batchManifest = args[i];
+        } else if (arg == OPTION_SERVE) {
+          options.serveSocket = args[i];
+        } else if (arg == OPTION_QUEUE_DEPTH) {
+          options.queueDepth = parseQueueDepth(args[i]);
+        } else if (arg == OPTION_MEMORY_LIMIT) {
+          options.memoryLimit = parseMemoryLimit(args[i]);
+        } else {
+          reject("Invalid option: " + arg);
+        }
+      }
+      return positional;
+    }
+
+    ParsedOperationArgs parseOperationArgs(OperationArgs const & operationArgs) {
+      switch (mapOperationToEnum(operationArgs.operation)) {
+        case Info:
+          return parseInfo(operationArgs);
+        case MaxLevel:
+          return parseMaxLevel(operationArgs);
+        case Resize:
+          return parseResize(operationArgs);
+        case CutFreq:
+          return parseCutFreq(operationArgs);
+        case Compress:
+          return parseCompress(operationArgs);
+        case Decompress:
+          return parseDecompress(operationArgs);
+        default:
+          reject("Invalid option: " + operationArgs.operation);
+      }
+    }
+
+    // Argumentos de cada operación de la cadena, separados por STAGE_SEPARATOR
+    std::vector<std::vector<std::string>> splitStages(std::vector<std::string> const & args) {
+      std::vector<std::vector<std::string>> stages(1);
+      for (std::string const & arg : args) {
+        if (arg == STAGE_SEPARATOR) {
+          stages.emplace_back();
+        } else {
+          stages.back().push_back(arg);
+        }
+      }
+      if (std::ranges::any_of(stages, [](auto const & stage) { return stage.empty(); })) {
+        reject("Invalid operation chain: empty operation");
+      }
+      return stages;
+    }
+
+    // info y decompress no se encadenan y compress, que escribe otro formato, va la última
+    void checkChain(std::vector<ParsedOperationArgs> const & stages) {
+      for (std::size_t stage = 0; stage < stages.size(); ++stage) {
+        OperationType const operation = stages[stage].operation;
+        if (operation == Info || operation == Decompress) {
+          reject("Operation cannot be chained");
+        }
+        if (operation == Compress && stage + 1 != stages.size()) {
+          reject("compress must be the last operation of a chain");
+        }
+      }
+    }
+
+    Stage toStage(ParsedOperationArgs const & parsedArgs) {
+      return {.operation     = parsedArgs.operation,
+              .args          = parsedArgs.args,
+              .resizeMethod  = parsedArgs.resizeMethod,
+              .cutFreqMethod = parsedArgs.cutFreqMethod};
+    }
+
+    // --batch y --serve sustituyen a la entrada, la salida y la operación; los trabajos traen
+    // sus propias opciones
+    ParsedOperationArgs parseService(std::vector<std::string> const & positional,
+                                     Options const & options) {
+      bool const serve          = !options.serveSocket.empty();
+      std::string const service = serve ? OPTION_SERVE : OPTION_BATCH;
+      if (serve && !options.batchManifest.empty()) {
+        reject("--batch and --serve cannot be combined");
+      }
+      if (positional.size() != 1) { reject(service + " takes no other arguments"); }
+      if (options.json || options.labels || options.packed || options.memoryLimit != 0) {
+        reject("Only --threads can be combined with " + service);
+      }
+      if (!serve && options.queueDepth != 0) { reject("--queue-depth requires --serve"); }
+
+      ParsedOperationArgs parsedArgs(serve ? options.serveSocket : options.batchManifest, "",
+                                     serve ? Serve : Batch);
+      parsedArgs.options = options;
+      return parsedArgs;
+    }
   }  // namespace
 
+  ParsedOperationArgs parseJob(std::vector<std::string> const & args) {
+    Options options;
+    std::vector<std::string> const positional = extractOptions(args, options);
+    if (!options.batchManifest.empty() || !options.serveSocket.empty()) {
+      return parseService(positional, options);
+    }
+    if (options.queueDepth != 0) { reject("--queue-depth requires --serve"); }
+    if (positional.size() < ARG_COUNT_MIN) {
+      reject("Invalid number of arguments: " + std::to_string(positional.size() - 1));
+    }
+
+    std::vector<std::vector<std::string>> const stages =
+        splitStages(std::vector(positional.begin() + OPERATION_INDEX, positional.end()));
+    std::vector<ParsedOperationArgs> parsedStages;
+    for (auto const & stage : stages) {
+      parsedStages.push_back(parseOperationArgs(
+          {.inputFilePath  = positional[INPUT_FILE_INDEX],
+           .outputFilePath = positional[OUTPUT_FILE_INDEX],
+           .operation      = stage.front(),
+           .args           = std::vector(stage.begin() + 1, stage.end())}));
+    }
+    if (parsedStages.size() > 1) { checkChain(parsedStages); }
+    // La búsqueda aproximada no usa las etiquetas
+    if (options.labels && std::ranges::any_of(parsedStages, [](auto const & stage) {
+          return stage.cutFreqMethod == CutFreqMethod::Approximate;
+        })) {
+      reject("--labels cannot be combined with approximate cutfreq");
+    }
+
+    ParsedOperationArgs parsedArgs = parsedStages.front();
+    for (std::size_t stage = 1; stage < parsedStages.size(); ++stage) {
+      parsedArgs.nextStages.push_back(toStage(parsedStages[stage]));
+    }
+    parsedArgs.options = options;
+    return parsedArgs;
+  }
+
   ParsedOperationArgs parseOperation(std::vector<std::string> const & args) {
-    if (args.size() < ARG_COUNT_MIN) {
-      printErrorAndExit("Invalid number of arguments: " + std::to_string(args.size() - 1));
-    }
-
-    OperationArgs const operationArgs = {.inputFilePath  = args[INPUT_FILE_INDEX],
-                                         .outputFilePath = args[OUTPUT_FILE_INDEX],
-                                         .operation      = args[OPERATION_INDEX],
-                                         .args =
-                                             std::vector(args.begin() + ARG_COUNT_MIN, args.end())};
-
-    switch (mapOperationToEnum(operationArgs.operation)) {
-      case Info:
-        return parseInfo(operationArgs);
-      case MaxLevel:
-        return parseMaxLevel(operationArgs);
-      case Resize:
-        return parseResize(operationArgs);
-      case CutFreq:
-        return parseCutFreq(operationArgs);
-      case Compress:
-        return parseCompress(operationArgs);
-      default:
-        printErrorAndExit("Invalid option: " + operationArgs.operation);
+    try {
+      return parseJob(args);
+    } catch (ArgumentError const & error) {
+      printErrorAndExit(error.what());
     }
   }
+
+  bool optionTakesValue(std::string const & option) {
+    return option == OPTION_THREADS || option == OPTION_BATCH || option == OPTION_SERVE ||
+           option == OPTION_QUEUE_DEPTH || option == OPTION_MEMORY_LIMIT;
+  }
+
+  std::vector<Stage> pipelineStages(ParsedOperationArgs const & parsedArgs) {
+    std::vector<Stage> stages{toStage(parsedArgs)};
+    stages.insert(stages.end(), parsedArgs.nextStages.begin(), parsedArgs.nextStages.end());
+    return stages;
+  }
 }  // namespace progargs
\ No newline at end of file
@@ -1,11 +1,30 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace progargs {
-  enum OperationType : std::uint8_t { Info, MaxLevel, Resize, CutFreq, Compress, Invalid };
+  enum OperationType : std::uint8_t {
+    Info,
+    MaxLevel,
+    Resize,
+    CutFreq,
+    Compress,
+    Decompress,
+    Batch,
+    Serve,
+    Invalid
+  };
+
+  // Algoritmo de redimensionado; sin argumento se usa la interpolación propia de cada disposición.
+  // Box, Bilinear, Bicubic y Lanczos3 usan el remuestreador separable.
+  enum class ResizeMethod : std::uint8_t { Default, Fixed, Box, Bilinear, Bicubic, Lanczos3 };
+
+  // Búsqueda de sustitutos de cutfreq; la aproximada solo mira las celdas vecinas de una rejilla
+  enum class CutFreqMethod : std::uint8_t { Exact, Approximate };
 
   struct OperationArgs {
       std::string inputFilePath;
@@ -14,11 +33,52 @@ namespace progargs {
       std::vector<std::string> args;
   };
 
+  // Opciones "--nombre" que pueden aparecer en cualquier posición de la línea de órdenes
+  struct Options {
+      bool json        = false;
+      unsigned threads = 0;      // 0: todos los núcleos disponibles
+      bool labels      = false;  // cutfreq y compress etiquetan cada píxel con su color
+      bool packed      = false;  // compress empaqueta los índices a ceil(log2(colores)) bits
+
+      // maxlevel, resize, cutfreq y compress por bandas de filas con como mucho estos bytes de
+      // búferes y tablas; 0: la imagen completa en memoria
+      std::size_t memoryLimit = 0;
+
+      // Manifiesto de trabajos "entrada salida operación args..." que se ejecutan en lote
+      std::string batchManifest;
+
+      // Socket Unix en el que --serve atiende trabajos con la sintaxis del manifiesto y
+      // trabajos que pueden esperar en cola; 0: QUEUE_DEPTH_DEFAULT
+      std::string serveSocket;
+      std::size_t queueDepth = 0;
+  };
+
+  // Argumentos no válidos; el mensaje es el que parseOperation imprime tras "Error: "
+  class ArgumentError : public std::runtime_error {
+    public:
+      using std::runtime_error::runtime_error;
+  };
+
+  // Operación de una cadena "op args... + op args... + ...": las operaciones se aplican en orden
+  // sobre la imagen en memoria y solo la última escribe el fichero de salida
+  struct Stage {
+      OperationType operation     = Invalid;
+      std::vector<std::uint32_t> args;
+      ResizeMethod resizeMethod   = ResizeMethod::Default;
+      CutFreqMethod cutFreqMethod = CutFreqMethod::Exact;
+  };
+
   struct ParsedOperationArgs {
       std::string inputFilePath;
       std::string outputFilePath;
       OperationType operation;
       std::vector<std::uint32_t> args;
+      std::vector<std::string> additionalInputFilePaths;
+      Options options;
+      ResizeMethod resizeMethod   = ResizeMethod::Default;
+      CutFreqMethod cutFreqMethod = CutFreqMethod::Exact;
+      // Operaciones que siguen a `operation` en una cadena; vacío con una sola operación
+      std::vector<Stage> nextStages;
 
       explicit ParsedOperationArgs(std::string inputPath = "", std::string outputPath = "",
                                    OperationType operationType          = Invalid,
@@ -27,19 +87,64 @@ namespace progargs {
           operation(operationType), args(std::move(arguments)) { }
   };
 
+  // Imprime el error y termina el proceso si los argumentos no son válidos
   [[nodiscard]] ParsedOperationArgs parseOperation(std::vector<std::string> const & args);
 
+  // Como parseOperation, pero lanza ArgumentError; para los trabajos de un lote, donde un
+  // trabajo mal escrito no debe detener los demás
+  [[nodiscard]] ParsedOperationArgs parseJob(std::vector<std::string> const & args);
+
+  // Todas las operaciones de la cadena en orden, empezando por la de `parsedArgs.operation`
+  [[nodiscard]] std::vector<Stage> pipelineStages(ParsedOperationArgs const & parsedArgs);
+
+  // Opciones seguidas de su valor ("--threads 4"); las demás son indicadores sin valor
+  [[nodiscard]] bool optionTakesValue(std::string const & option);
+
   inline constexpr int INPUT_FILE_INDEX  = 1;
   inline constexpr int OUTPUT_FILE_INDEX = 2;
   inline constexpr int OPERATION_INDEX   = 3;
 
-  inline constexpr int ARG_COUNT_MIN      = 4;
-  inline constexpr int ARG_COUNT_INFO     = 0;
-  inline constexpr int ARG_COUNT_MAXLEVEL = 1;
-  inline constexpr int ARG_COUNT_RESIZE   = 2;
-  inline constexpr int ARG_COUNT_CUTFREQ  = 1;
-  inline constexpr int ARG_COUNT_COMPRESS = 0;
+  inline constexpr int ARG_COUNT_MIN            = 4;
+  inline constexpr int ARG_COUNT_MAXLEVEL       = 1;
+  inline constexpr int ARG_COUNT_RESIZE         = 2;
+  inline constexpr int ARG_COUNT_RESIZE_METHOD  = 3;
+  inline constexpr int ARG_COUNT_CUTFREQ        = 1;
+  inline constexpr int ARG_COUNT_CUTFREQ_METHOD = 2;
+  inline constexpr int ARG_COUNT_COMPRESS       = 0;
+  inline constexpr int ARG_COUNT_DECOMPRESS     = 0;
+
+  inline constexpr char const * OPTION_PREFIX       = "--";
+  inline constexpr char const * OPTION_JSON         = "--json";
+  inline constexpr char const * OPTION_THREADS      = "--threads";
+  inline constexpr char const * OPTION_LABELS       = "--labels";
+  inline constexpr char const * OPTION_PACKED       = "--packed";
+  inline constexpr char const * OPTION_MEMORY_LIMIT = "--memory-limit";
+  inline constexpr char const * OPTION_BATCH        = "--batch";
+  inline constexpr char const * OPTION_SERVE        = "--serve";
+  inline constexpr char const * OPTION_QUEUE_DEPTH  = "--queue-depth";
+
+  // Separa las operaciones de una cadena: "resize 800 600 + maxlevel 255 + compress"
+  inline constexpr char const * STAGE_SEPARATOR = "+";
+
+  inline constexpr char const * RESIZE_METHOD_FIXED    = "fixed";
+  inline constexpr char const * RESIZE_METHOD_BOX      = "box";
+  inline constexpr char const * RESIZE_METHOD_BILINEAR = "bilinear";
+  inline constexpr char const * RESIZE_METHOD_BICUBIC  = "bicubic";
+  inline constexpr char const * RESIZE_METHOD_LANCZOS3 = "lanczos3";
+
+  inline constexpr char const * CUTFREQ_METHOD_EXACT       = "exact";
+  inline constexpr char const * CUTFREQ_METHOD_APPROXIMATE = "approx";
 
   inline constexpr int MAX_LEVEL_MIN = 1;
   inline constexpr int MAX_LEVEL_MAX = 65535;
+
+  inline constexpr int THREADS_MIN = 1;
+  inline constexpr int THREADS_MAX = 1024;
+
+  inline constexpr int QUEUE_DEPTH_MIN             = 1;
+  inline constexpr int QUEUE_DEPTH_MAX             = 65536;
+  inline constexpr std::size_t QUEUE_DEPTH_DEFAULT = 64;
+
+  // Sufijos binarios de --memory-limit: K, M y G
+  inline constexpr unsigned MEMORY_UNIT_SHIFT = 10;
 }  // namespace progargs
@@ -0,0 +1,192 @@
+#include <algorithm>
+#include <common/cpu.hpp>
+#include <common/image.hpp>
+#include <common/replacement.hpp>
+#include <common/threadpool.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
+
+namespace image {
+  namespace {
+    constexpr unsigned NARROW_CHANNEL_BITS = 8;
+    constexpr std::size_t NARROW_COLORS    = std::size_t{1} << (3 * NARROW_CHANNEL_BITS);
+    constexpr unsigned FILTER_WORD_BITS    = 32;
+    constexpr unsigned FILTER_WORD_SHIFT   = 5;
+    constexpr std::uint32_t FILTER_BIT     = FILTER_WORD_BITS - 1;
+    // Píxeles por bloque de trabajo
+    constexpr std::size_t APPLY_GRAIN = std::size_t{1} << 16;
+
+    std::size_t narrowIndex(std::size_t const red, std::size_t const green,
+                            std::size_t const blue) {
+      return (((red << NARROW_CHANNEL_BITS) | green) << NARROW_CHANNEL_BITS) | blue;
+    }
+
+    bool filterHas(std::span<std::uint32_t const> filter, std::size_t const index) {
+      return ((filter[index >> FILTER_WORD_SHIFT] >> (index & FILTER_BIT)) & 1U) != 0;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    constexpr std::size_t AVX2_PIXELS  = 16;
+    constexpr short NARROW_LOW_BITS    = 0x00FF;
+    constexpr int FILTER_BIT_LANE      = 31;
+    constexpr unsigned HALF_MASK_SHIFT = 8;
+
+    // Ocho píxeles con las muestras reducidas a 8 bits y la máscara de los que ya eran de 8 bits
+    struct NarrowLanes {
+        __m128i red;
+        __m128i green;
+        __m128i blue;
+        __m128i narrow;
+    };
+
+    // Máscara de los ocho píxeles de 8 bits cuyo color está en el filtro
+    [[gnu::target("avx2")]] unsigned filterLanes(std::span<std::uint32_t const> filter,
+                                                  NarrowLanes const & lanes) {
+      __m256i const index = _mm256_or_si256(
+          _mm256_or_si256(
+              _mm256_slli_epi32(_mm256_cvtepu16_epi32(lanes.red), 2 * NARROW_CHANNEL_BITS),
+              _mm256_slli_epi32(_mm256_cvtepu16_epi32(lanes.green), NARROW_CHANNEL_BITS)),
+          _mm256_cvtepu16_epi32(lanes.blue));
+      __m256i const words = _mm256_i32gather_epi32(
+          reinterpret_cast<int const *>(filter.data()),  // NOLINT
+          _mm256_srli_epi32(index, FILTER_WORD_SHIFT), sizeof(std::uint32_t));
+      __m256i const bits = _mm256_srlv_epi32(
+          words, _mm256_and_si256(index, _mm256_set1_epi32(static_cast<int>(FILTER_BIT))));
+      __m256i const found = _mm256_and_si256(_mm256_slli_epi32(bits, FILTER_BIT_LANE),
+                                             _mm256_cvtepi16_epi32(lanes.narrow));
+      return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(found)));
+    }
+
+    [[gnu::target("avx2")]] __m256i loadPixels(std::span<unsigned short> plane,
+                                               std::size_t const first) {
+      return _mm256_loadu_si256(
+          reinterpret_cast<__m256i const *>(plane.subspan(first).data()));  // NOLINT
+    }
+
+    // Máscara de los 16 píxeles a partir de `first` cuyo color está en el filtro. Los píxeles con
+    // alguna muestra de más de 8 bits no pueden estar en la tabla: se indexan con sus 8 bits bajos
+    // para no salirse del filtro y se descartan.
+    [[gnu::target("avx2")]] unsigned filterBlock(WritablePixelChannels const & pixels,
+                                                 std::span<std::uint32_t const> filter,
+                                                 std::size_t const first) {
+      __m256i const red    = loadPixels(pixels.channels[0], first);
+      __m256i const green  = loadPixels(pixels.channels[1], first);
+      __m256i const blue   = loadPixels(pixels.channels[2], first);
+      __m256i const low    = _mm256_set1_epi16(NARROW_LOW_BITS);
+      __m256i const all    = _mm256_or_si256(_mm256_or_si256(red, green), blue);
+      __m256i const high   = _mm256_andnot_si256(low, all);
+      __m256i const narrow = _mm256_cmpeq_epi16(high, _mm256_setzero_si256());
+      __m256i const red8   = _mm256_and_si256(red, low);
+      __m256i const green8 = _mm256_and_si256(green, low);
+      __m256i const blue8  = _mm256_and_si256(blue, low);
+      NarrowLanes const lower{.red    = _mm256_castsi256_si128(red8),
+                              .green  = _mm256_castsi256_si128(green8),
+                              .blue   = _mm256_castsi256_si128(blue8),
+                              .narrow = _mm256_castsi256_si128(narrow)};
+      NarrowLanes const upper{.red    = _mm256_extracti128_si256(red8, 1),
+                              .green  = _mm256_extracti128_si256(green8, 1),
+                              .blue   = _mm256_extracti128_si256(blue8, 1),
+                              .narrow = _mm256_extracti128_si256(narrow, 1)};
+      return filterLanes(filter, lower) | (filterLanes(filter, upper) << HALF_MASK_SHIFT);
+    }
+
+    // Recorre planos separados en bloques de 16 píxeles y solo llama a `replace` con los píxeles
+    // marcados en el filtro. Devuelve el primer píxel sin recorrer.
+    template <typename Replace>
+    [[gnu::target("avx2")]] std::size_t filterPlanesAvx2(WritablePixelChannels const & pixels,
+                                                         std::span<std::uint32_t const> filter,
+                                                         Replace && replace) {
+      std::size_t first = 0;
+      for (; first + AVX2_PIXELS <= pixels.count; first += AVX2_PIXELS) {
+        unsigned lanes = filterBlock(pixels, filter, first);
+        for (; lanes != 0; lanes &= lanes - 1) {
+          replace(first + static_cast<std::size_t>(__builtin_ctz(lanes)));
+        }
+      }
+      return first;
+    }
+#endif
+  }  // namespace
+
+  void ReplacementTable::add(ColorTuple const & from, ColorTuple const & to) {
+    auto const [red, green, blue]              = from;
+    auto const [newRed, newGreen, newBlue]     = to;
+    replacements_[packColor(red, green, blue)] = packColor(newRed, newGreen, newBlue);
+    if (!narrow_) { return; }
+    if (std::max({red, green, blue}) > MAX_COLOR_VALUE_8BIT) {
+      narrow_ = false;
+      narrowFilter_.clear();
+      narrowFilter_.shrink_to_fit();
+      return;
+    }
+    if (narrowFilter_.empty()) { narrowFilter_.assign(NARROW_COLORS / FILTER_WORD_BITS, 0); }
+    std::size_t const index = narrowIndex(red, green, blue);
+    narrowFilter_[index >> FILTER_WORD_SHIFT] |= 1U << (index & FILTER_BIT);
+  }
+
+  void ReplacementTable::replacePixel(WritablePixelChannels const & pixels,
+                                      std::size_t const pixel) const {
+    std::size_t const offset        = pixel * pixels.stride;
+    PackedColor const * replacement = replacements_.get(packColor(
+        pixels.channels[0][offset], pixels.channels[1][offset], pixels.channels[2][offset]));
+    if (replacement == nullptr) { return; }
+    auto const [red, green, blue] = unpackColor(*replacement);
+    pixels.channels[0][offset]    = red;
+    pixels.channels[1][offset]    = green;
+    pixels.channels[2][offset]    = blue;
+  }
+
+  void ReplacementTable::applyRange(WritablePixelChannels const & pixels, std::size_t first,
+                                    std::size_t const last) const {
+    if (!narrow_) {
+      for (std::size_t pixel = first; pixel < last; ++pixel) { replacePixel(pixels, pixel); }
+      return;
+    }
+    std::span<std::uint32_t const> const filter(narrowFilter_);
+#if defined(__x86_64__) || defined(__i386__)
+    if (pixels.stride == 1 && cpuHasAvx2()) {
+      std::size_t const count = last - first;
+      WritablePixelChannels const block{.channels = {pixels.channels[0].subspan(first, count),
+                                                     pixels.channels[1].subspan(first, count),
+                                                     pixels.channels[2].subspan(first, count)},
+                                        .stride   = 1,
+                                        .count    = count};
+      first += filterPlanesAvx2(block, filter,
+                                [&](std::size_t const pixel) { replacePixel(block, pixel); });
+    }
+#endif
+    for (std::size_t pixel = first; pixel < last; ++pixel) {
+      std::size_t const offset = pixel * pixels.stride;
+      std::size_t const red    = pixels.channels[0][offset];
+      std::size_t const green  = pixels.channels[1][offset];
+      std::size_t const blue   = pixels.channels[2][offset];
+      if (std::max({red, green, blue}) > MAX_COLOR_VALUE_8BIT) { continue; }
+      if (filterHas(filter, narrowIndex(red, green, blue))) { replacePixel(pixels, pixel); }
+    }
+  }
+
+  void ReplacementTable::apply(WritablePixelChannels const & pixels) const {
+    if (replacements_.size() == 0) { return; }
+    threadpool::parallelFor(
+        0, pixels.count,
+        [this, &pixels](std::size_t const first, std::size_t const last) {
+          applyRange(pixels, first, last);
+        },
+        APPLY_GRAIN);
+  }
+
+  ReplacementTable replacementTable(std::span<ColorTuple const> from,
+                                    std::span<ColorTuple const> to) {
+    ReplacementTable table;
+    for (std::size_t i = 0; i < from.size(); ++i) { table.add(from[i], to[i]); }
+    return table;
+  }
+
+  ReplacementTable replacementTable(std::map<ColorTuple, ColorTuple> const & replacements) {
+    ReplacementTable table;
+    for (auto const & [from, to] : replacements) { table.add(from, to); }
+    return table;
+  }
+}  // namespace image
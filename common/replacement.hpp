@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <common/colormap.hpp>
+#include <common/pixelio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Canales de una imagen que se pueden modificar; mismo significado de `stride` que en
+  // PixelChannels.
+  struct WritablePixelChannels {
+      std::array<std::span<unsigned short>, CHANNELS> channels;
+      std::size_t stride;
+      std::size_t count;
+  };
+
+  // Sustituciones de colores de cutfreq en una tabla hash plana. Mientras todos los colores a
+  // sustituir son de 8 bits mantiene además un bit por cada uno de los 2^24 colores posibles, de
+  // modo que los píxeles que se conservan (la gran mayoría) se descartan con una sola lectura.
+  class ReplacementTable {
+    public:
+      void add(ColorTuple const & from, ColorTuple const & to);
+
+      [[nodiscard]] std::size_t size() const { return replacements_.size(); }
+
+      // Color que sustituye a `color`, o nullptr si se conserva
+      [[nodiscard]] PackedColor const * find(PackedColor const color) const {
+        return replacements_.get(color);
+      }
+
+      // Sustituye los colores de todos los píxeles, repartidos entre los hilos
+      void apply(WritablePixelChannels const & pixels) const;
+
+    private:
+      void applyRange(WritablePixelChannels const & pixels, std::size_t first,
+                      std::size_t last) const;
+      void replacePixel(WritablePixelChannels const & pixels, std::size_t pixel) const;
+
+      FlatColorMap<PackedColor> replacements_;
+      std::vector<std::uint32_t> narrowFilter_;
+      bool narrow_ = true;
+  };
+
+  // Tabla que sustituye cada color de `from` por el de la misma posición en `to`
+  [[nodiscard]] ReplacementTable replacementTable(std::span<ColorTuple const> from,
+                                                  std::span<ColorTuple const> to);
+
+  // Tabla con las sustituciones de un mapa como el de buildReplacementMap
+  [[nodiscard]] ReplacementTable
+      replacementTable(std::map<ColorTuple, ColorTuple> const & replacements);
+}  // namespace image
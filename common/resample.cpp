@@ -0,0 +1,290 @@
+#include <algorithm>
+#include <cmath>
+#include <common/resample.hpp>
+#include <common/threadpool.hpp>
+#include <numbers>
+#include <vector>
+
+namespace image {
+  namespace {
+    constexpr unsigned ACCUMULATOR_SHIFT = 2 * FIXED_SHIFT;
+    constexpr std::uint64_t ROUNDING     = std::uint64_t{1} << (ACCUMULATOR_SHIFT - 1);
+    constexpr std::uint64_t FRACTION     = FIXED_ONE - 1;
+
+    // Desplazamientos (ya multiplicados por el paso) de las dos muestras de origen de cada
+    // posición de destino, y peso 16.16 de la muestra alta
+    struct FixedAxis {
+        std::vector<std::size_t> low;
+        std::vector<std::size_t> high;
+        std::vector<std::uint32_t> weight;
+    };
+
+    // La posición de origen i * (origen - 1) / (destino - 1) se calcula en enteros, sin error de
+    // redondeo acumulado
+    FixedAxis makeFixedAxis(std::size_t const targetSize, std::size_t const sourceSize,
+                            std::size_t const stride) {
+      FixedAxis axis{.low    = std::vector<std::size_t>(targetSize),
+                     .high   = std::vector<std::size_t>(targetSize),
+                     .weight = std::vector<std::uint32_t>(targetSize)};
+      for (std::size_t i = 0; i < targetSize; ++i) {
+        std::uint64_t const position =
+            targetSize > 1
+                ? (std::uint64_t{i} * (sourceSize - 1) << FIXED_SHIFT) / (targetSize - 1)
+                : 0;
+        std::size_t const low = position >> FIXED_SHIFT;
+        axis.low[i]           = low * stride;
+        axis.high[i]          = std::min(low + 1, sourceSize - 1) * stride;
+        axis.weight[i]        = static_cast<std::uint32_t>(position & FRACTION);
+      }
+      return axis;
+    }
+
+    // Una fila de destino de un canal y las dos filas de origen de las que se interpola
+    struct ChannelRow {
+        std::span<unsigned short const> top;
+        std::span<unsigned short const> bottom;
+        std::span<unsigned short> out;
+        std::uint32_t weight;
+    };
+
+    std::uint32_t lerpFixed(unsigned short const low, unsigned short const high,
+                            std::uint32_t const weight) {
+      return (low * (FIXED_ONE - weight)) + (high * weight);
+    }
+
+    void resizeChannelRow(ChannelRow const & row, FixedAxis const & columns,
+                          std::size_t const stride) {
+      std::uint64_t const bottomWeight = row.weight;
+      std::uint64_t const topWeight    = FIXED_ONE - row.weight;
+      for (std::size_t xPos = 0; xPos < columns.low.size(); ++xPos) {
+        std::size_t const low    = columns.low[xPos];
+        std::size_t const high   = columns.high[xPos];
+        std::uint32_t const top  = lerpFixed(row.top[low], row.top[high], columns.weight[xPos]);
+        std::uint32_t const bottom =
+            lerpFixed(row.bottom[low], row.bottom[high], columns.weight[xPos]);
+        std::uint64_t const value = (top * topWeight) + (bottom * bottomWeight);
+        row.out[xPos * stride] =
+            static_cast<unsigned short>((value + ROUNDING) >> ACCUMULATOR_SHIFT);
+      }
+    }
+
+    constexpr double BOX_SUPPORT      = 0.5;
+    constexpr double BILINEAR_SUPPORT = 1.0;
+    constexpr double BICUBIC_SUPPORT  = 2.0;
+    constexpr double LANCZOS_SUPPORT  = 3.0;
+    constexpr double CUBIC_A          = -0.5;  // Catmull-Rom
+    constexpr double CUBIC_OUTER_C2   = 5.0;
+    constexpr double CUBIC_OUTER_C1   = 8.0;
+    constexpr double CUBIC_OUTER_C0   = 4.0;
+    constexpr double PIXEL_CENTER     = 0.5;
+    constexpr float ROUND_HALF        = 0.5F;
+
+    double filterSupport(ResampleFilter const filter) {
+      switch (filter) {
+        case ResampleFilter::Box:
+          return BOX_SUPPORT;
+        case ResampleFilter::Bilinear:
+          return BILINEAR_SUPPORT;
+        case ResampleFilter::Bicubic:
+          return BICUBIC_SUPPORT;
+        case ResampleFilter::Lanczos3:
+          return LANCZOS_SUPPORT;
+      }
+      return BILINEAR_SUPPORT;
+    }
+
+    double cubic(double const distance) {
+      if (distance < 1.0) {
+        return ((((CUBIC_A + 2.0) * distance) - (CUBIC_A + 3.0)) * distance * distance) + 1.0;
+      }
+      if (distance < BICUBIC_SUPPORT) {
+        return CUBIC_A *
+               (((((distance - CUBIC_OUTER_C2) * distance) + CUBIC_OUTER_C1) * distance) -
+                CUBIC_OUTER_C0);
+      }
+      return 0.0;
+    }
+
+    double sinc(double const value) {
+      if (value == 0.0) { return 1.0; }
+      double const angle = std::numbers::pi * value;
+      return std::sin(angle) / angle;
+    }
+
+    // Peso del filtro para una muestra a `offset` píxeles (ya escalados) del centro
+    double filterWeight(ResampleFilter const filter, double const offset) {
+      double const distance = std::abs(offset);
+      switch (filter) {
+        case ResampleFilter::Box:
+          return offset >= -BOX_SUPPORT && offset < BOX_SUPPORT ? 1.0 : 0.0;
+        case ResampleFilter::Bilinear:
+          return std::max(0.0, 1.0 - distance);
+        case ResampleFilter::Bicubic:
+          return cubic(distance);
+        case ResampleFilter::Lanczos3:
+          return distance < LANCZOS_SUPPORT ? sinc(distance) * sinc(distance / LANCZOS_SUPPORT)
+                                            : 0.0;
+      }
+      return 0.0;
+    }
+
+    // Pesos normalizados de cada posición de destino: `count[i]` muestras de origen a partir de
+    // `first[i]`, guardadas en `weights` con un paso fijo de `taps`
+    struct FilterAxis {
+        std::vector<std::size_t> first;
+        std::vector<std::size_t> count;
+        std::vector<float> weights;
+        std::size_t taps;
+    };
+
+    // Centro de una posición de destino en coordenadas de origen y escala del filtro
+    struct FilterWindow {
+        double center;
+        double scale;
+        ResampleFilter filter;
+    };
+
+    void fillFilterWeights(FilterAxis & axis, std::size_t const index,
+                           FilterWindow const & window) {
+      auto const weights = std::span(axis.weights).subspan(index * axis.taps, axis.taps);
+      double sum         = 0.0;
+      for (std::size_t tap = 0; tap < axis.count[index]; ++tap) {
+        double const position = static_cast<double>(axis.first[index] + tap) + PIXEL_CENTER;
+        double const weight =
+            filterWeight(window.filter, (position - window.center) / window.scale);
+        weights[tap]  = static_cast<float>(weight);
+        sum          += weight;
+      }
+      if (sum == 0.0) {
+        weights[0] = 1.0F;
+        return;
+      }
+      for (std::size_t tap = 0; tap < axis.count[index]; ++tap) {
+        weights[tap] = static_cast<float>(weights[tap] / sum);
+      }
+    }
+
+    FilterAxis makeFilterAxis(std::size_t const targetSize, std::size_t const sourceSize,
+                              ResampleFilter const filter) {
+      double const scale       = static_cast<double>(sourceSize) / static_cast<double>(targetSize);
+      double const filterScale = std::max(scale, 1.0);
+      double const support     = filterSupport(filter) * filterScale;
+      auto const taps          = (2 * static_cast<std::size_t>(std::ceil(support))) + 1;
+
+      FilterAxis axis{.first   = std::vector<std::size_t>(targetSize),
+                      .count   = std::vector<std::size_t>(targetSize),
+                      .weights = std::vector<float>(targetSize * taps),
+                      .taps    = taps};
+      for (std::size_t i = 0; i < targetSize; ++i) {
+        double const center = (static_cast<double>(i) + PIXEL_CENTER) * scale;
+        auto const begin = static_cast<std::size_t>(std::max(0.0, std::floor(center - support)));
+        auto const end =
+            std::min(sourceSize, static_cast<std::size_t>(std::ceil(center + support)));
+        axis.first[i] = std::min(begin, sourceSize - 1);
+        axis.count[i] = std::clamp<std::size_t>(end - std::min(begin, end), 1, taps);
+        fillFilterWeights(axis, i, {.center = center, .scale = filterScale, .filter = filter});
+      }
+      return axis;
+    }
+
+    using FloatPlanes = std::array<std::vector<float>, CHANNELS>;
+
+    // Primera pasada: filtra cada fila de origen en horizontal hacia planos intermedios de
+    // sourceHeight x targetWidth
+    void resampleRows(ChannelPlanes const & planes, ResampleGeometry const & geometry,
+                      FilterAxis const & columns, FloatPlanes & intermediate) {
+      std::size_t const sourceRow = geometry.sourceWidth * planes.stride;
+      threadpool::parallelFor(0, geometry.sourceHeight, [&](std::size_t first, std::size_t last) {
+        for (std::size_t yPos = first; yPos < last; ++yPos) {
+          for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+            auto const source = planes.source.at(channel).subspan(yPos * sourceRow);
+            auto const out    = std::span(intermediate.at(channel))
+                                 .subspan(yPos * geometry.targetWidth, geometry.targetWidth);
+            for (std::size_t xPos = 0; xPos < geometry.targetWidth; ++xPos) {
+              auto const weights = std::span(columns.weights).subspan(xPos * columns.taps);
+              float sum          = 0.0F;
+              for (std::size_t tap = 0; tap < columns.count[xPos]; ++tap) {
+                sum += weights[tap] * source[(columns.first[xPos] + tap) * planes.stride];
+              }
+              out[xPos] = sum;
+            }
+          }
+        }
+      });
+    }
+
+    struct ColumnPass {
+        FilterAxis const & rows;
+        FloatPlanes const & intermediate;
+        float maxValue;
+    };
+
+    // Segunda pasada: combina filas intermedias completas, redondea y recorta a [0, max]
+    void resampleColumns(ChannelPlanes const & planes, ResampleGeometry const & geometry,
+                         ColumnPass const & pass) {
+      std::size_t const width = geometry.targetWidth;
+      threadpool::parallelFor(0, geometry.targetHeight, [&](std::size_t first, std::size_t last) {
+        std::vector<float> sum(width);
+        for (std::size_t yPos = first; yPos < last; ++yPos) {
+          auto const weights = std::span(pass.rows.weights).subspan(yPos * pass.rows.taps);
+          for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+            std::ranges::fill(sum, 0.0F);
+            for (std::size_t tap = 0; tap < pass.rows.count[yPos]; ++tap) {
+              auto const row = std::span(pass.intermediate.at(channel))
+                                   .subspan((pass.rows.first[yPos] + tap) * width, width);
+              for (std::size_t xPos = 0; xPos < width; ++xPos) {
+                sum[xPos] += weights[tap] * row[xPos];
+              }
+            }
+            auto const out = planes.target.at(channel).subspan(yPos * width * planes.stride);
+            for (std::size_t xPos = 0; xPos < width; ++xPos) {
+              out[xPos * planes.stride] = static_cast<unsigned short>(
+                  std::clamp(sum[xPos], 0.0F, pass.maxValue) + ROUND_HALF);
+            }
+          }
+        }
+      });
+    }
+  }  // namespace
+
+  void resizeBilinearFixed(ChannelPlanes const & planes, ResampleGeometry const & geometry) {
+    if (geometry.sourceWidth == 0 || geometry.sourceHeight == 0) { return; }
+
+    FixedAxis const columns =
+        makeFixedAxis(geometry.targetWidth, geometry.sourceWidth, planes.stride);
+    FixedAxis const rows = makeFixedAxis(geometry.targetHeight, geometry.sourceHeight, 1);
+    std::size_t const sourceRow = geometry.sourceWidth * planes.stride;
+    std::size_t const targetRow = geometry.targetWidth * planes.stride;
+
+    threadpool::parallelFor(0, geometry.targetHeight, [&](std::size_t first, std::size_t last) {
+      for (std::size_t yPos = first; yPos < last; ++yPos) {
+        for (std::size_t channel = 0; channel < CHANNELS; ++channel) {
+          std::span<unsigned short const> const source = planes.source.at(channel);
+          resizeChannelRow({.top    = source.subspan(rows.low[yPos] * sourceRow),
+                            .bottom = source.subspan(rows.high[yPos] * sourceRow),
+                            .out    = planes.target.at(channel).subspan(yPos * targetRow),
+                            .weight = rows.weight[yPos]},
+                           columns, planes.stride);
+        }
+      }
+    });
+  }
+
+  void resample(ChannelPlanes const & planes, ResampleGeometry const & geometry,
+                ResampleFilter const filter, unsigned short const maxColorValue) {
+    if (geometry.sourceWidth == 0 || geometry.sourceHeight == 0) { return; }
+
+    FilterAxis const columns = makeFilterAxis(geometry.targetWidth, geometry.sourceWidth, filter);
+    FilterAxis const rows    = makeFilterAxis(geometry.targetHeight, geometry.sourceHeight, filter);
+
+    FloatPlanes intermediate;
+    for (auto & plane : intermediate) {
+      plane.resize(geometry.sourceHeight * geometry.targetWidth);
+    }
+    resampleRows(planes, geometry, columns, intermediate);
+    resampleColumns(planes, geometry,
+                    {.rows         = rows,
+                     .intermediate = intermediate,
+                     .maxValue     = static_cast<float>(maxColorValue)});
+  }
+}  // namespace image
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <array>
+#include <common/pixelio.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace image {
+  // Pesos en punto fijo 16.16
+  constexpr unsigned FIXED_SHIFT    = 16;
+  constexpr std::uint32_t FIXED_ONE = std::uint32_t{1} << FIXED_SHIFT;
+
+  struct ResampleGeometry {
+      std::size_t sourceWidth;
+      std::size_t sourceHeight;
+      std::size_t targetWidth;
+      std::size_t targetHeight;
+  };
+
+  // Canales de origen y destino de una imagen. `stride` es la distancia en muestras entre dos
+  // píxeles consecutivos del mismo canal: 3 para AOS (muestras entrelazadas) y 1 para SOA.
+  struct ChannelPlanes {
+      std::array<std::span<unsigned short const>, CHANNELS> source;
+      std::array<std::span<unsigned short>, CHANNELS> target;
+      std::size_t stride;
+  };
+
+  // Filtros del remuestreador separable
+  enum class ResampleFilter : std::uint8_t { Box, Bilinear, Bicubic, Lanczos3 };
+
+  // Interpolación bilineal con pesos 16.16 y acumuladores enteros de 32/64 bits. El resultado se
+  // redondea al entero más cercano (mitad hacia arriba), de modo que no depende de la disposición
+  // en memoria ni del número de hilos.
+  void resizeBilinearFixed(ChannelPlanes const & planes, ResampleGeometry const & geometry);
+
+  // Remuestreo separable en dos pasadas (horizontal y después vertical). Las tablas de pesos de
+  // cada eje se calculan una vez; al reducir, el soporte del filtro se ensancha con la escala para
+  // promediar todas las muestras de origen (box equivale entonces a un promedio por área).
+  void resample(ChannelPlanes const & planes, ResampleGeometry const & geometry,
+                ResampleFilter filter, unsigned short maxColorValue);
+}  // namespace image
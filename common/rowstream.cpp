@@ -0,0 +1,275 @@
+#include <algorithm>
+#include <common/leveltable.hpp>
+#include <common/pixelio.hpp>
+#include <common/rowstream.hpp>
+#include <common/threadpool.hpp>
+#include <iostream>
+
+namespace image {
+  namespace {
+    std::size_t rowSamples(Image const & header) {
+      return header.getWidth() * CHANNELS;
+    }
+
+    std::size_t fileRowBytes(Image const & header) {
+      return rowSamples(header) * bytesPerSample(header.getMaxColorValue());
+    }
+
+    std::size_t rowCount(Image const & header, std::size_t const samples) {
+      std::size_t const perRow = rowSamples(header);
+      return perRow == 0 ? 0 : samples / perRow;
+    }
+
+    void reportMemoryLimit(std::size_t const memoryLimit, std::size_t const needed) {
+      std::cerr << "Memory limit too small: " << memoryLimit << " bytes, one band needs "
+                << needed << " bytes\n";
+    }
+
+    // Filas de `source` que todavía no están en `rows`
+    std::size_t newSourceRows(std::vector<std::size_t> const & rows, SourceRows const & source) {
+      auto const isNew = [&rows](std::size_t const row) {
+        return rows.empty() || row > rows.back();
+      };
+      std::size_t count = isNew(source.low) ? 1 : 0;
+      if (source.high != source.low && isNew(source.high)) { ++count; }
+      return count;
+    }
+
+    std::size_t rowSlot(std::vector<std::size_t> const & rows, std::size_t const row) {
+      return static_cast<std::size_t>(std::ranges::lower_bound(rows, row) - rows.begin());
+    }
+  }  // namespace
+
+  bool RowReader::open(std::string const & filePath) {
+    file_.open(filePath, std::ios::binary);
+    if (!file_.is_open()) {
+      std::cerr << "Failed to open file: " << filePath << '\n';
+      return false;
+    }
+    return header_.readHeader(file_);
+  }
+
+  std::size_t RowReader::rowBytes() const {
+    return fileRowBytes(header_);
+  }
+
+  bool RowReader::readRows(std::span<unsigned short> rows, RowLayout const layout) {
+    std::size_t const width       = header_.getWidth();
+    std::size_t const samples     = rowSamples(header_);
+    std::size_t const bytesPerRow = rowBytes();
+    std::size_t const sampleBytes = bytesPerSample(header_.getMaxColorValue());
+    std::size_t const count       = rowCount(header_, rows.size());
+
+    bytes_.resize(count * bytesPerRow);
+    file_.read(reinterpret_cast<char *>(bytes_.data()),  // NOLINT
+               static_cast<std::streamsize>(bytes_.size()));
+    if (!file_) {
+      std::cerr << "Unexpected end of file while reading pixel data.\n";
+      return false;
+    }
+
+    std::span<unsigned char const> const bytes(bytes_);
+    threadpool::parallelFor(0, count, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t row = first; row < last; ++row) {
+        std::span<unsigned char const> const in = bytes.subspan(row * bytesPerRow, bytesPerRow);
+        std::span<unsigned short> const out     = rows.subspan(row * samples, samples);
+        if (layout == RowLayout::Interleaved) {
+          decodeRow(in, sampleBytes,
+                    [out](std::size_t const xPos, unsigned short const red,
+                          unsigned short const green, unsigned short const blue) {
+                      out[xPos * CHANNELS]       = red;
+                      out[(xPos * CHANNELS) + 1] = green;
+                      out[(xPos * CHANNELS) + 2] = blue;
+                    });
+        } else {
+          decodeRow(in, sampleBytes,
+                    [out, width](std::size_t const xPos, unsigned short const red,
+                                 unsigned short const green, unsigned short const blue) {
+                      out[xPos]               = red;
+                      out[width + xPos]       = green;
+                      out[(2 * width) + xPos] = blue;
+                    });
+        }
+      }
+    });
+    return true;
+  }
+
+  bool RowReader::skipRows(std::size_t const count) {
+    auto const bytes = static_cast<std::streamsize>(count * rowBytes());
+    file_.ignore(bytes);
+    if (file_.gcount() != bytes) {
+      std::cerr << "Unexpected end of file while reading pixel data.\n";
+      return false;
+    }
+    return true;
+  }
+
+  bool RowWriter::open(std::string const & filePath, Image const & header) {
+    file_.open(filePath, std::ios::binary);
+    if (!file_.is_open()) {
+      std::cerr << "Failed to open file: " << filePath << '\n';
+      return false;
+    }
+    header_ = header;
+    return header_.writeHeader(file_);
+  }
+
+  bool RowWriter::writeRows(std::span<unsigned short const> rows, RowLayout const layout) {
+    std::size_t const width       = header_.getWidth();
+    std::size_t const samples     = rowSamples(header_);
+    std::size_t const bytesPerRow = fileRowBytes(header_);
+    std::size_t const sampleBytes = bytesPerSample(header_.getMaxColorValue());
+    std::size_t const count       = rowCount(header_, rows.size());
+
+    bytes_.resize(count * bytesPerRow);
+    std::span<unsigned char> const bytes(bytes_);
+    threadpool::parallelFor(0, count, [&](std::size_t const first, std::size_t const last) {
+      for (std::size_t row = first; row < last; ++row) {
+        std::span<unsigned short const> const in = rows.subspan(row * samples, samples);
+        std::span<unsigned char> const out       = bytes.subspan(row * bytesPerRow, bytesPerRow);
+        if (layout == RowLayout::Interleaved) {
+          encodeSamples(in, sampleBytes, out);
+        } else {
+          encodePlanes({.red   = in.first(width),
+                        .green = in.subspan(width, width),
+                        .blue  = in.subspan(2 * width, width)},
+                       sampleBytes, out);
+        }
+      }
+    });
+    file_.write(reinterpret_cast<char const *>(bytes_.data()),  // NOLINT
+                static_cast<std::streamsize>(bytes_.size()));
+    return file_.good();
+  }
+
+  std::size_t bandRowCount(Image const & header, std::size_t const rowCost,
+                           std::size_t const memoryLimit) {
+    std::size_t const bandRows =
+        rowCost == 0 ? header.getHeight() : std::min(header.getHeight(), memoryLimit / rowCost);
+    if (bandRows == 0 && header.getHeight() > 0) { reportMemoryLimit(memoryLimit, rowCost); }
+    return bandRows;
+  }
+
+  bool streamMaxLevel(std::string const & inputPath, std::string const & outputPath,
+                      unsigned short const newMaxColorValue, std::size_t const memoryLimit) {
+    RowReader reader;
+    if (!reader.open(inputPath)) { return false; }
+    Image const & header = reader.header();
+    Image output         = header;
+    output.setMaxColorValue(newMaxColorValue);
+
+    // Cada fila de la banda ocupa sus bytes de entrada, sus muestras y sus bytes de salida
+    std::size_t const samples = rowSamples(header);
+    std::size_t const rowCost =
+        (samples * sizeof(unsigned short)) + reader.rowBytes() + fileRowBytes(output);
+    std::size_t const bandRows = bandRowCount(header, rowCost, memoryLimit);
+    if (bandRows == 0 && header.getHeight() > 0) { return false; }
+
+    RowWriter writer;
+    if (!writer.open(outputPath, output)) { return false; }
+    LevelTable const levels(header.getMaxColorValue(), newMaxColorValue);
+    std::vector<unsigned short> band(bandRows * samples);
+    for (std::size_t first = 0; first < header.getHeight(); first += bandRows) {
+      std::size_t const count              = std::min(bandRows, header.getHeight() - first);
+      std::span<unsigned short> const rows = std::span(band).first(count * samples);
+      if (!reader.readRows(rows, RowLayout::Interleaved)) { return false; }
+      levels.apply(rows);
+      if (!writer.writeRows(rows, RowLayout::Interleaved)) { return false; }
+    }
+    return true;
+  }
+
+  bool streamResize(RowReader & reader, std::string const & outputPath, RowResize const & resize,
+                    std::size_t const memoryLimit) {
+    Image const & header = reader.header();
+    Image output         = header;
+    output.setWidth(resize.width);
+    output.setHeight(resize.height);
+    bool const rowsInRange = std::ranges::all_of(resize.sourceRows, [&](SourceRows const & rows) {
+      return rows.high < header.getHeight();
+    });
+    if (!rowsInRange) {
+      std::cerr << "Source row out of range in streaming resize\n";
+      return false;
+    }
+
+    std::size_t const sourceSamples = rowSamples(header);
+    std::size_t const targetSamples = rowSamples(output);
+    // Cada fila ocupa sus muestras y sus bytes en el fichero
+    std::size_t const sourceCost = (sourceSamples * sizeof(unsigned short)) + reader.rowBytes();
+    std::size_t const targetCost = (targetSamples * sizeof(unsigned short)) + fileRowBytes(output);
+
+    RowWriter writer;
+    if (!writer.open(outputPath, output)) { return false; }
+
+    // Filas de origen de la banda en orden creciente, guardadas una tras otra en `window`; la
+    // muestra de relleno del final permite las lecturas vectoriales tras la última fila
+    std::vector<std::size_t> windowRows;
+    std::vector<unsigned short> window(1);
+    std::vector<unsigned short> target;
+    std::size_t nextRow = 0;  // primera fila de origen sin leer
+
+    for (std::size_t first = 0; first < resize.height;) {
+      // La banda crece mientras sus filas de origen y de destino caben en el límite
+      std::vector<std::size_t> rows;
+      std::size_t last = first;
+      while (last < resize.height) {
+        SourceRows const & source = resize.sourceRows[last];
+        std::size_t const cost    = ((rows.size() + newSourceRows(rows, source)) * sourceCost) +
+                                 ((last - first + 1) * targetCost);
+        if (cost > memoryLimit) {
+          if (last == first) {
+            reportMemoryLimit(memoryLimit, cost);
+            return false;
+          }
+          break;
+        }
+        if (rows.empty() || source.low > rows.back()) { rows.push_back(source.low); }
+        if (source.high > rows.back()) { rows.push_back(source.high); }
+        ++last;
+      }
+
+      // Las filas ya leídas son las últimas de la banda anterior y pasan al principio de la
+      // ventana; el resto se lee en tramos de filas consecutivas. Cada fila ocupa un puesto entero
+      // de la ventana, así que origen y destino solo se solapan si la fila ya está en su puesto
+      window.resize(std::max(window.size(), (rows.size() * sourceSamples) + 1));
+      std::span<unsigned short> const slots(window);
+      std::size_t slot = 0;
+      for (; slot < rows.size() && rows[slot] < nextRow; ++slot) {
+        std::size_t const previous = rowSlot(windowRows, rows[slot]);
+        if (previous == slot) { continue; }
+        std::ranges::copy(slots.subspan(previous * sourceSamples, sourceSamples),
+                          slots.subspan(slot * sourceSamples).begin());
+      }
+      while (slot < rows.size()) {
+        std::size_t end = slot + 1;
+        while (end < rows.size() && rows[end] == rows[end - 1] + 1) { ++end; }
+        if (!reader.skipRows(rows[slot] - nextRow) ||
+            !reader.readRows(slots.subspan(slot * sourceSamples, (end - slot) * sourceSamples),
+                             resize.layout)) {
+          return false;
+        }
+        nextRow = rows[end - 1] + 1;
+        slot    = end;
+      }
+      windowRows = std::move(rows);
+
+      target.resize(std::max(target.size(), (last - first) * targetSamples));
+      std::span<unsigned short> const targetRows = std::span(target).first((last - first) *
+                                                                           targetSamples);
+      threadpool::parallelFor(first, last, [&](std::size_t const begin, std::size_t const end) {
+        for (std::size_t yPrime = begin; yPrime < end; ++yPrime) {
+          SourceRows const & source = resize.sourceRows[yPrime];
+          resize.kernel(
+              yPrime, slots.subspan(rowSlot(windowRows, source.low) * sourceSamples, sourceSamples),
+              slots.subspan(rowSlot(windowRows, source.high) * sourceSamples, sourceSamples),
+              targetRows.subspan((yPrime - first) * targetSamples, targetSamples));
+        }
+      });
+      if (!writer.writeRows(targetRows, resize.layout)) { return false; }
+      first = last;
+    }
+    return true;
+  }
+}  // namespace image
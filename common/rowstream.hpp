@@ -0,0 +1,92 @@
+#pragma once
+
+#include <common/image.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace image {
+  // Disposición de las muestras de cada fila en los búferes del flujo: entrelazadas (AOS) o en
+  // tres planos seguidos de `width` muestras (SOA). En los dos casos una fila ocupa width * 3
+  // muestras.
+  enum class RowLayout : std::uint8_t { Interleaved, Planar };
+
+  // Lee las filas de un PPM por bloques con read(), sin proyectar el fichero, de modo que la
+  // memoria ocupada depende del bloque y no del tamaño de la imagen
+  class RowReader {
+    public:
+      [[nodiscard]] bool open(std::string const & filePath);
+
+      [[nodiscard]] Image const & header() const { return header_; }
+
+      // Bytes de una fila en el fichero
+      [[nodiscard]] std::size_t rowBytes() const;
+
+      // Decodifica las filas siguientes sobre `rows`, que ocupa un número entero de filas
+      [[nodiscard]] bool readRows(std::span<unsigned short> rows, RowLayout layout);
+
+      [[nodiscard]] bool skipRows(std::size_t count);
+
+    private:
+      std::ifstream file_;
+      Image header_;
+      std::vector<unsigned char> bytes_;
+  };
+
+  class RowWriter {
+    public:
+      [[nodiscard]] bool open(std::string const & filePath, Image const & header);
+
+      // Codifica y escribe filas completas de la imagen de salida
+      [[nodiscard]] bool writeRows(std::span<unsigned short const> rows, RowLayout layout);
+
+    private:
+      std::ofstream file_;
+      Image header_;
+      std::vector<unsigned char> bytes_;
+  };
+
+  // Filas por banda para que cada banda, a `rowCost` bytes por fila, quepa en `memoryLimit`; como
+  // mucho todas las de la imagen. Devuelve 0 e informa por std::cerr si no cabe ni una fila.
+  [[nodiscard]] std::size_t bandRowCount(Image const & header, std::size_t rowCost,
+                                         std::size_t memoryLimit);
+
+  // maxlevel por bandas de filas: cada banda se lee, pasa por la LevelTable y se escribe antes de
+  // leer la siguiente. `memoryLimit` acota los búferes de una banda; devuelve false si no cabe ni
+  // una fila.
+  [[nodiscard]] bool streamMaxLevel(std::string const & inputPath, std::string const & outputPath,
+                                    unsigned short newMaxColorValue, std::size_t memoryLimit);
+
+  // Filas de origen de las que se interpola una fila de destino
+  struct SourceRows {
+      std::size_t low;
+      std::size_t high;
+  };
+
+  // Calcula la fila de destino `yPrime` a partir de sus dos filas de origen, todas en la
+  // disposición del flujo. Tras la fila `high` siempre queda al menos una muestra legible, para
+  // las lecturas vectoriales.
+  using ResizeRowKernel =
+      std::function<void(std::size_t yPrime, std::span<unsigned short const> low,
+                         std::span<unsigned short const> high, std::span<unsigned short> out)>;
+
+  // Redimensionado por filas que aporta cada disposición. `sourceRows` tiene una entrada por fila
+  // de destino y sus dos campos no decrecen.
+  struct RowResize {
+      unsigned long width;
+      unsigned long height;
+      RowLayout layout;
+      std::vector<SourceRows> sourceRows;
+      ResizeRowKernel kernel;
+  };
+
+  // Redimensiona por bandas de filas de destino: de cada banda solo se guardan las filas de origen
+  // que necesita (dos por fila de destino como mucho) y las filas de destino se escriben en cuanto
+  // se calculan. Con poca memoria cada banda tiene una sola fila de destino.
+  [[nodiscard]] bool streamResize(RowReader & reader, std::string const & outputPath,
+                                  RowResize const & resize, std::size_t memoryLimit);
+}  // namespace image
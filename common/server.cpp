@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <common/server.hpp>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <poll.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace server {
+  namespace {
+    constexpr std::size_t READ_CHUNK         = 4096;
+    constexpr std::size_t PATH_ARGS          = 2;  // entrada y salida de un trabajo
+    constexpr double MILLISECONDS            = 1000.0;
+    constexpr char const * UNAVAILABLE       = "unavailable: shutting down";
+    constexpr char const * SHUTDOWN_ACCEPTED = "ok shutting down";
+    constexpr char const * BUSY_QUEUE        = "busy: queue full";
+    constexpr char const * BUSY_CONNECTIONS  = "busy: too many connections";
+
+    using Clock = std::chrono::steady_clock;
+
+    // Escritura del pipe del servidor que atiende SIGINT y SIGTERM
+    std::atomic<int> signalWakeDescriptor{-1};
+
+    extern "C" void wakeOnSignal(int /*signal*/) {
+      int const descriptor = signalWakeDescriptor.load();
+      if (descriptor < 0) { return; }
+      char const byte                    = 1;
+      [[maybe_unused]] auto const result = write(descriptor, &byte, 1);
+    }
+
+    bool makeAddress(std::string const & path, sockaddr_un & address) {
+      address            = {};
+      address.sun_family = AF_UNIX;
+      if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid socket path: " << path << '\n';
+        return false;
+      }
+      std::memcpy(static_cast<char *>(address.sun_path), path.c_str(), path.size() + 1);
+      return true;
+    }
+
+    sockaddr const * asSockaddr(sockaddr_un const & address) {
+      return reinterpret_cast<sockaddr const *>(&address);  // NOLINT
+    }
+
+    // Un socket que ya no atiende nadie (un servidor que terminó sin borrarlo) se reemplaza; uno
+    // en uso no
+    FileDescriptor listenUnixSocket(std::string const & path) {
+      sockaddr_un address{};
+      if (!makeAddress(path, address)) { return {}; }
+
+      std::error_code error;
+      if (std::filesystem::is_socket(path, error)) {
+        if (connectUnixSocket(path).isValid()) {
+          std::cerr << "Socket already in use: " << path << '\n';
+          return {};
+        }
+        std::filesystem::remove(path, error);
+      }
+
+      FileDescriptor listener(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+      if (!listener.isValid() ||
+          bind(listener.get(), asSockaddr(address), sizeof(address)) != 0 ||
+          listen(listener.get(), SOMAXCONN) != 0) {
+        std::cerr << "Failed to listen on socket: " << path << " (" << std::strerror(errno)
+                  << ")\n";
+        return {};
+      }
+      return listener;
+    }
+
+    double millisecondsBetween(Clock::time_point const start, Clock::time_point const end) {
+      return std::chrono::duration<double>(end - start).count() * MILLISECONDS;
+    }
+
+    struct JobResult {
+        bool ok             = false;
+        double queuedMillis = 0.0;
+        double runMillis    = 0.0;
+        std::string failure;
+    };
+
+    struct PendingJob {
+        progargs::ParsedOperationArgs args;
+        Clock::time_point queuedAt;
+        std::promise<JobResult> result;
+    };
+
+    enum class PushResult : std::uint8_t { Queued, Full, Closed };
+
+    // Cada conexión tiene como mucho un trabajo en la cola o en ejecución, así que por defecto se
+    // admiten tantas como trabajos caben a la vez
+    std::size_t connectionLimit(ServerOptions const & options) {
+      if (options.maxConnections != 0) { return options.maxConnections; }
+      return std::max(1U, options.workers) + std::max<std::size_t>(1, options.queueDepth);
+    }
+
+    std::string formatResult(JobResult const & result) {
+      std::ostringstream reply;
+      reply << (result.ok ? "ok " : "failed ") << std::fixed << std::setprecision(2)
+            << result.runMillis << " ms, queued " << result.queuedMillis << " ms";
+      if (!result.failure.empty()) { reply << ": " << result.failure; }
+      return reply.str();
+    }
+  }  // namespace
+
+  FileDescriptor::~FileDescriptor() {
+    if (descriptor_ >= 0) { close(descriptor_); }
+  }
+
+  FileDescriptor::FileDescriptor(FileDescriptor && other) noexcept
+    : descriptor_(std::exchange(other.descriptor_, -1)) { }
+
+  FileDescriptor & FileDescriptor::operator=(FileDescriptor && other) noexcept {
+    if (this != &other) {
+      if (descriptor_ >= 0) { close(descriptor_); }
+      descriptor_ = std::exchange(other.descriptor_, -1);
+    }
+    return *this;
+  }
+
+  FileDescriptor connectUnixSocket(std::string const & path) {
+    sockaddr_un address{};
+    if (!makeAddress(path, address)) { return {}; }
+    FileDescriptor connection(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0));
+    if (!connection.isValid() ||
+        connect(connection.get(), asSockaddr(address), sizeof(address)) != 0) {
+      return {};
+    }
+    return connection;
+  }
+
+  bool LineReader::next(std::string & line) {
+    while (true) {
+      if (auto const end = buffer_.find('\n'); end != std::string::npos) {
+        line.assign(buffer_, 0, end);
+        buffer_.erase(0, end + 1);
+        if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+        return true;
+      }
+      if (buffer_.size() > MAX_LINE_BYTES) { return false; }
+
+      std::array<char, READ_CHUNK> chunk{};
+      ssize_t const received = recv(descriptor_, chunk.data(), chunk.size(), 0);
+      if (received < 0 && errno == EINTR) { continue; }
+      if (received <= 0) { return false; }
+      buffer_.append(chunk.data(), static_cast<std::size_t>(received));
+    }
+  }
+
+  bool writeLine(int const descriptor, std::string_view const line) {
+    std::string message(line);
+    message += '\n';
+    std::size_t sent = 0;
+    while (sent < message.size()) {
+      // MSG_NOSIGNAL: un cliente que se va no debe terminar el proceso con SIGPIPE
+      ssize_t const written =
+          send(descriptor, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+      if (written < 0 && errno == EINTR) { continue; }
+      if (written <= 0) { return false; }
+      sent += static_cast<std::size_t>(written);
+    }
+    return true;
+  }
+
+  std::string withAbsolutePaths(std::string const & job) {
+    std::istringstream tokens(job);
+    std::vector<std::string> words{std::istream_iterator<std::string>(tokens),
+                                   std::istream_iterator<std::string>()};
+    std::vector<std::size_t> positional;
+    for (std::size_t word = 0; word < words.size(); ++word) {
+      if (!words[word].starts_with(progargs::OPTION_PREFIX)) {
+        positional.push_back(word);
+      } else if (progargs::optionTakesValue(words[word])) {
+        ++word;
+      }
+    }
+    if (positional.size() <= PATH_ARGS) { return job; }
+
+    for (std::size_t path = 0; path < PATH_ARGS; ++path) {
+      std::error_code error;
+      std::string & word                   = words[positional[path]];
+      std::filesystem::path const absolute = std::filesystem::absolute(word, error);
+      if (!error) { word = absolute.string(); }
+    }
+    std::string line = words[0];
+    for (std::size_t word = 1; word < words.size(); ++word) { line += ' ' + words[word]; }
+    return line;
+  }
+
+  // Cola acotada: push no espera y rechaza el trabajo si ya hay `depth` esperando aparte de los
+  // que van a recoger los hilos libres; pop espera mientras está vacía. Tras close(), push falla
+  // y pop entrega lo que quede antes de devolver nullopt.
+  class JobServer::JobQueue {
+    public:
+      explicit JobQueue(std::size_t const depth) : depth_(std::max<std::size_t>(1, depth)) { }
+
+      PushResult push(PendingJob job) {
+        std::scoped_lock const lock(mutex_);
+        if (closed_) { return PushResult::Closed; }
+        if (jobs_.size() >= depth_ + idle_) { return PushResult::Full; }
+        jobs_.push_back(std::move(job));
+        notEmpty_.notify_one();
+        return PushResult::Queued;
+      }
+
+      std::optional<PendingJob> pop() {
+        std::unique_lock lock(mutex_);
+        ++idle_;
+        notEmpty_.wait(lock, [this] { return closed_ || !jobs_.empty(); });
+        --idle_;
+        if (jobs_.empty()) { return std::nullopt; }
+        PendingJob job = std::move(jobs_.front());
+        jobs_.pop_front();
+        return job;
+      }
+
+      void close() {
+        std::scoped_lock const lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+      }
+
+    private:
+      std::size_t depth_;
+      std::size_t idle_ = 0;  // hilos esperando en pop
+      std::deque<PendingJob> jobs_;
+      std::mutex mutex_;
+      std::condition_variable notEmpty_;
+      bool closed_ = false;
+  };
+
+  JobServer::JobServer(ServerOptions options, image::JobRunner run)
+    : options_(std::move(options)), run_(std::move(run)),
+      listener_(listenUnixSocket(options_.socketPath)),
+      queue_(std::make_unique<JobQueue>(options_.queueDepth)) {
+    std::array<int, 2> descriptors{-1, -1};
+    if (pipe2(descriptors.data(), O_CLOEXEC) == 0) {
+      wakeRead_  = FileDescriptor(descriptors[0]);
+      wakeWrite_ = FileDescriptor(descriptors[1]);
+    }
+  }
+
+  JobServer::~JobServer() {
+    if (previousActions_) {
+      sigaction(SIGINT, &(*previousActions_)[0], nullptr);
+      sigaction(SIGTERM, &(*previousActions_)[1], nullptr);
+    }
+    int expected = wakeWrite_.get();
+    signalWakeDescriptor.compare_exchange_strong(expected, -1);
+    if (listener_.isValid()) {
+      std::error_code error;
+      std::filesystem::remove(options_.socketPath, error);
+    }
+  }
+
+  void JobServer::handleSignals() {
+    signalWakeDescriptor = wakeWrite_.get();
+    struct sigaction action {};
+    action.sa_handler = wakeOnSignal;
+    sigemptyset(&action.sa_mask);
+    // Un segundo handleSignals() no debe guardar como anteriores las acciones de este servidor
+    std::array<struct sigaction, 2> previous{};
+    sigaction(SIGINT, &action, &previous[0]);
+    sigaction(SIGTERM, &action, &previous[1]);
+    if (!previousActions_) { previousActions_ = previous; }
+  }
+
+  void JobServer::stop() {
+    stopping_                          = true;
+    char const byte                    = 1;
+    [[maybe_unused]] auto const result = write(wakeWrite_.get(), &byte, 1);
+  }
+
+  bool JobServer::serve() {
+    if (!isListening()) { return false; }
+
+    std::vector<std::thread> workers;
+    for (unsigned worker = 0; worker < std::max(1U, options_.workers); ++worker) {
+      workers.emplace_back([this] { workerLoop(); });
+    }
+
+    std::array<pollfd, 2> waiting{
+      {{.fd = listener_.get(), .events = POLLIN, .revents = 0},
+       {.fd = wakeRead_.get(), .events = POLLIN, .revents = 0}}
+    };
+    bool listening = true;
+    while (!stopping_) {
+      if (poll(waiting.data(), waiting.size(), -1) < 0) {
+        if (errno == EINTR) { continue; }
+        std::cerr << "Failed to wait for connections (" << std::strerror(errno) << ")\n";
+        listening = false;
+        break;
+      }
+      if (waiting[1].revents != 0) { break; }
+      if ((waiting[0].revents & POLLIN) == 0) { continue; }
+
+      FileDescriptor connection(accept4(listener_.get(), nullptr, nullptr, SOCK_CLOEXEC));
+      if (!connection.isValid()) { continue; }
+      bool admitted = false;
+      {
+        std::scoped_lock const lock(connectionsMutex_);
+        admitted = activeConnections_ < connectionLimit(options_);
+        if (admitted) {
+          connections_.insert(connection.get());
+          ++activeConnections_;
+        }
+      }
+      if (!admitted) {
+        [[maybe_unused]] bool const written = writeLine(connection.get(), BUSY_CONNECTIONS);
+        continue;
+      }
+      std::thread([this, owned = std::move(connection)]() mutable {
+        serveConnection(std::move(owned));
+      }).detach();
+    }
+
+    // Parada ordenada: no se aceptan más conexiones ni trabajos, los de la cola terminan y
+    // reciben su respuesta y luego se cierran las conexiones
+    stopping_ = true;
+    listener_ = FileDescriptor();
+    std::error_code error;
+    std::filesystem::remove(options_.socketPath, error);
+    queue_->close();
+    for (auto & worker : workers) { worker.join(); }
+    closeConnections();
+    return listening;
+  }
+
+  void JobServer::serveConnection(FileDescriptor connection) {
+    int const descriptor = connection.get();
+    LineReader reader(descriptor);
+    std::string line;
+    while (reader.next(line)) {
+      if (line.find_first_not_of(" \t") == std::string::npos) { continue; }
+      std::string reply;
+      if (line == SHUTDOWN_COMMAND) {
+        stop();
+        reply = SHUTDOWN_ACCEPTED;
+      } else {
+        reply = runLine(line);
+      }
+      if (!writeLine(descriptor, reply)) { break; }
+    }
+
+    {
+      std::scoped_lock const lock(connectionsMutex_);
+      connections_.erase(descriptor);
+    }
+    connection = FileDescriptor();
+    std::scoped_lock const lock(connectionsMutex_);
+    --activeConnections_;
+    connectionsClosed_.notify_all();
+  }
+
+  std::string JobServer::runLine(std::string const & text) {
+    image::BatchJob job = image::parseJobLine(0, text);
+    if (!job.error.empty()) { return "invalid: " + job.error; }
+    if (stopping_) { return UNAVAILABLE; }
+
+    std::promise<JobResult> promise;
+    std::future<JobResult> result = promise.get_future();
+    switch (queue_->push({.args     = std::move(job.args),
+                          .queuedAt = Clock::now(),
+                          .result   = std::move(promise)})) {
+      case PushResult::Full:
+        return BUSY_QUEUE;
+      case PushResult::Closed:
+        return UNAVAILABLE;
+      default:
+        return formatResult(result.get());
+    }
+  }
+
+  void JobServer::workerLoop() {
+    while (std::optional<PendingJob> job = queue_->pop()) {
+      Clock::time_point const start = Clock::now();
+      JobResult result;
+      result.queuedMillis = millisecondsBetween(job->queuedAt, start);
+      try {
+        result.ok = run_(job->args);
+      } catch (std::exception const & error) {
+        result.failure = error.what();
+      } catch (...) {
+        result.failure = "unknown error";
+      }
+      result.runMillis = millisecondsBetween(start, Clock::now());
+      job->result.set_value(std::move(result));
+    }
+  }
+
+  // Las conexiones quedan bloqueadas leyendo la siguiente línea; cerrar su lectura las despierta
+  void JobServer::closeConnections() {
+    std::unique_lock lock(connectionsMutex_);
+    for (int const descriptor : connections_) { shutdown(descriptor, SHUT_RD); }
+    connectionsClosed_.wait(lock, [this] { return activeConnections_ == 0; });
+  }
+}  // namespace server
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <common/batch.hpp>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+
+namespace server {
+  // Descriptor de fichero que se cierra al destruir el objeto
+  class FileDescriptor {
+    public:
+      FileDescriptor() = default;
+      explicit FileDescriptor(int descriptor) : descriptor_(descriptor) { }
+      ~FileDescriptor();
+      FileDescriptor(FileDescriptor const &)             = delete;
+      FileDescriptor & operator=(FileDescriptor const &) = delete;
+      FileDescriptor(FileDescriptor && other) noexcept;
+      FileDescriptor & operator=(FileDescriptor && other) noexcept;
+
+      [[nodiscard]] int get() const { return descriptor_; }
+
+      [[nodiscard]] bool isValid() const { return descriptor_ >= 0; }
+
+    private:
+      int descriptor_ = -1;
+  };
+
+  [[nodiscard]] FileDescriptor connectUnixSocket(std::string const & path);
+
+  // Lee líneas terminadas en '\n' de un socket
+  class LineReader {
+    public:
+      explicit LineReader(int descriptor) : descriptor_(descriptor) { }
+
+      // Devuelve false si la conexión se cierra o la línea supera MAX_LINE_BYTES
+      [[nodiscard]] bool next(std::string & line);
+
+    private:
+      int descriptor_;
+      std::string buffer_;
+  };
+
+  // Escribe la línea y su '\n'; false si la conexión se ha cerrado
+  [[nodiscard]] bool writeLine(int descriptor, std::string_view line);
+
+  inline constexpr std::size_t MAX_LINE_BYTES = std::size_t{64} << 10;
+
+  // El servidor resuelve las rutas relativas desde su propio directorio, así que el cliente envía
+  // la entrada y la salida del trabajo absolutas. Las opciones y sus valores pueden ir en
+  // cualquier posición, como en parseJob; una línea sin operación ("shutdown") no cambia.
+  [[nodiscard]] std::string withAbsolutePaths(std::string const & job);
+
+  // Orden que detiene el servidor en lugar de un trabajo
+  inline constexpr std::string_view SHUTDOWN_COMMAND = "shutdown";
+
+  struct ServerOptions {
+      std::string socketPath;
+      std::size_t queueDepth     = 0;  // trabajos que esperan turno como mucho
+      unsigned workers           = 1;  // trabajos que se ejecutan a la vez
+      std::size_t maxConnections = 0;  // conexiones abiertas a la vez; 0: workers + queueDepth
+  };
+
+  // Servidor de trabajos sobre un socket Unix. Cada conexión envía líneas con la sintaxis del
+  // manifiesto de --batch y recibe una respuesta por línea:
+  //   ok <ms de ejecución> ms, queued <ms en cola> ms
+  //   failed <ms> ms, queued <ms> ms[: excepción]
+  //   invalid: <error de los argumentos>
+  //   busy: queue full
+  //   unavailable: shutting down
+  // Una conexión tiene un solo trabajo a la vez: no lee la línea siguiente hasta responder a la
+  // anterior, así que las líneas que un cliente envíe seguidas se ejecutan una tras otra. Cada
+  // conexión tiene su hilo, hasta `maxConnections`; las que pasan del límite reciben
+  // "busy: too many connections" y se cierran. Los trabajos esperan en una cola de `queueDepth`
+  // puestos y, con la cola llena, la línea recibe "busy: queue full" sin ejecutarse. Los
+  // `workers` hilos que ejecutan los trabajos viven lo que el servidor, igual que el pool de
+  // hilos que reparte las filas de cada trabajo, y el JobRunner conserva sus búferes.
+  // La orden "shutdown", stop() o SIGINT/SIGTERM (con handleSignals) cierran el socket; los
+  // trabajos en cola terminan y reciben su respuesta antes de que serve() vuelva.
+  class JobServer {
+    public:
+      JobServer(ServerOptions options, image::JobRunner run);
+      ~JobServer();
+      JobServer(JobServer const &)             = delete;
+      JobServer & operator=(JobServer const &) = delete;
+      JobServer(JobServer &&)                  = delete;
+      JobServer & operator=(JobServer &&)      = delete;
+
+      // El socket se crea en el constructor; los clientes pueden conectarse antes de serve()
+      [[nodiscard]] bool isListening() const {
+        return listener_.isValid() && wakeWrite_.isValid();
+      }
+
+      // Hace que SIGINT y SIGTERM detengan este servidor; el destructor restaura las acciones
+      // anteriores
+      void handleSignals();
+
+      // Atiende conexiones hasta la parada; devuelve false si falla el socket
+      bool serve();
+
+      void stop();
+
+    private:
+      void serveConnection(FileDescriptor connection);
+      [[nodiscard]] std::string runLine(std::string const & text);
+      void workerLoop();
+      void closeConnections();
+
+      ServerOptions options_;
+      image::JobRunner run_;
+      FileDescriptor listener_;
+      // stop() y las señales escriben un byte para despertar el bucle de serve()
+      FileDescriptor wakeRead_;
+      FileDescriptor wakeWrite_;
+      std::atomic<bool> stopping_{false};
+      // Acciones de SIGINT y SIGTERM antes de handleSignals()
+      std::optional<std::array<struct sigaction, 2>> previousActions_;
+
+      class JobQueue;
+      std::unique_ptr<JobQueue> queue_;
+
+      std::mutex connectionsMutex_;
+      std::condition_variable connectionsClosed_;
+      std::set<int> connections_;
+      std::size_t activeConnections_ = 0;
+  };
+}  // namespace server
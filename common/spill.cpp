@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <common/spill.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <utility>
+
+namespace image {
+  namespace {
+    constexpr char const * SPILL_TEMPLATE        = "imtool-spill-XXXXXX";
+    constexpr std::size_t MIN_MERGE_BUFFER_BYTES = std::size_t{4} << 10;
+    constexpr std::size_t MIN_MERGE_FAN_IN       = 2;
+
+    // Crea un fichero temporal vacío con un nombre único en el directorio temporal del sistema
+    // (TMPDIR)
+    bool createSpillFile(std::filesystem::path & path) {
+      std::error_code error;
+      std::string name = (std::filesystem::temp_directory_path(error) / SPILL_TEMPLATE).string();
+      int const descriptor = error ? -1 : mkstemp(name.data());
+      if (descriptor < 0) {
+        std::cerr << "Failed to create temporary file: " << name << '\n';
+        return false;
+      }
+      close(descriptor);
+      path = name;
+      return true;
+    }
+
+    // Lectura secuencial de un run con un búfer de registros
+    class RunReader {
+      public:
+        RunReader(std::filesystem::path const & path, std::size_t const bufferRecords)
+          : file_(path, std::ios::binary), buffer_(bufferRecords) { }
+
+        [[nodiscard]] bool isOpen() const { return file_.is_open(); }
+
+        [[nodiscard]] bool failed() const { return file_.bad(); }
+
+        // Avanza al siguiente registro; devuelve false al final del run
+        bool next() {
+          if (++position_ < filled_) { return true; }
+          file_.read(reinterpret_cast<char *>(buffer_.data()),  // NOLINT
+                     static_cast<std::streamsize>(buffer_.size() * sizeof(ColorRecord)));
+          filled_   = static_cast<std::size_t>(file_.gcount()) / sizeof(ColorRecord);
+          position_ = 0;
+          return filled_ > 0;
+        }
+
+        [[nodiscard]] ColorRecord const & current() const { return buffer_[position_]; }
+
+      private:
+        std::ifstream file_;
+        std::vector<ColorRecord> buffer_;
+        std::size_t position_ = 0;
+        std::size_t filled_   = 0;
+    };
+
+    using HeapEntry = std::pair<PackedColor, std::size_t>;
+  }  // namespace
+
+  SpilledColorRuns::SpilledColorRuns(std::size_t const memoryBudget, RecordCombine const combine)
+    : memoryBudget_(memoryBudget), combine_(combine) { }
+
+  SpilledColorRuns::~SpilledColorRuns() {
+    for (auto const & run : runs_) {
+      std::error_code error;
+      std::filesystem::remove(run, error);
+    }
+  }
+
+  void SpilledColorRuns::combine(ColorRecord & into, std::uint64_t const value) const {
+    into.value = combine_ == RecordCombine::Sum ? into.value + value : std::min(into.value, value);
+  }
+
+  // La fusión con los registros acumulados necesita un segundo vector, así que el presupuesto se
+  // compara con el doble de los registros
+  bool SpilledColorRuns::add(std::span<ColorRecord const> records) {
+    std::size_t const needed = (records_.size() + records.size()) * 2 * sizeof(ColorRecord);
+    if (needed > memoryBudget_ && !records_.empty() && !spill()) { return false; }
+
+    std::vector<ColorRecord> merged;
+    merged.reserve(records_.size() + records.size());
+    std::size_t kept = 0;
+    for (ColorRecord const & record : records) {
+      while (kept < records_.size() && records_[kept].color < record.color) {
+        merged.push_back(records_[kept++]);
+      }
+      if (kept < records_.size() && records_[kept].color == record.color) {
+        merged.push_back(records_[kept++]);
+        combine(merged.back(), record.value);
+      } else {
+        merged.push_back(record);
+      }
+    }
+    merged.insert(merged.end(), records_.begin() + static_cast<std::ptrdiff_t>(kept),
+                  records_.end());
+    records_ = std::move(merged);
+
+    // Una sola banda puede no caber en el presupuesto
+    if (records_.size() * 2 * sizeof(ColorRecord) > memoryBudget_) { return spill(); }
+    return true;
+  }
+
+  bool SpilledColorRuns::spill() {
+    std::filesystem::path path;
+    if (!createSpillFile(path)) { return false; }
+    runs_.push_back(path);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<char const *>(records_.data()),  // NOLINT
+               static_cast<std::streamsize>(records_.size() * sizeof(ColorRecord)));
+    if (!file.good()) {
+      std::cerr << "Failed to write temporary file: " << path.string() << '\n';
+      return false;
+    }
+    records_ = {};
+    return true;
+  }
+
+  std::size_t SpilledColorRuns::mergeFanIn() const {
+    return std::clamp(memoryBudget_ / MIN_MERGE_BUFFER_BYTES, MIN_MERGE_FAN_IN, MAX_MERGE_RUNS);
+  }
+
+  bool SpilledColorRuns::merge(std::function<void(ColorRecord const &)> const & visit) {
+    if (runs_.empty()) {
+      std::ranges::for_each(records_, visit);
+      return true;
+    }
+    if (!records_.empty() && !spill()) { return false; }
+
+    // Cada paso cambia los primeros runs por uno hasta que quedan `fanIn`; el último solo fusiona
+    // los que sobran para que la fusión final abra `fanIn` runs
+    std::size_t const fanIn = mergeFanIn();
+    while (runs_.size() > fanIn) {
+      if (!mergeFront(std::min(fanIn, runs_.size() - fanIn + 1))) { return false; }
+    }
+    return mergeRuns(runs_, visit);
+  }
+
+  // Fusiona los `count` primeros runs en uno nuevo al final de la lista. El nuevo run se añade
+  // antes de escribirlo para que el destructor lo borre aunque falle.
+  bool SpilledColorRuns::mergeFront(std::size_t const count) {
+    std::vector<std::filesystem::path> const group(
+        runs_.begin(), runs_.begin() + static_cast<std::ptrdiff_t>(count));
+    std::filesystem::path path;
+    if (!createSpillFile(path)) { return false; }
+    runs_.push_back(path);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    bool const merged = mergeRuns(group, [&file](ColorRecord const & record) {
+      file.write(reinterpret_cast<char const *>(&record), sizeof(ColorRecord));  // NOLINT
+    });
+    if (!merged) { return false; }
+    if (!file.good()) {
+      std::cerr << "Failed to write temporary file: " << path.string() << '\n';
+      return false;
+    }
+
+    runs_.erase(runs_.begin(), runs_.begin() + static_cast<std::ptrdiff_t>(count));
+    for (auto const & run : group) {
+      std::error_code error;
+      std::filesystem::remove(run, error);
+    }
+    return true;
+  }
+
+  bool SpilledColorRuns::mergeRuns(std::span<std::filesystem::path const> const runs,
+                                   std::function<void(ColorRecord const &)> const & visit) const {
+    std::size_t const bufferRecords =
+        std::max<std::size_t>(1, memoryBudget_ / (runs.size() * sizeof(ColorRecord)));
+    std::vector<RunReader> readers;
+    readers.reserve(runs.size());
+    // Montículo con el menor color de cada run arriba
+    std::vector<HeapEntry> heap;
+    for (auto const & run : runs) {
+      RunReader & reader = readers.emplace_back(run, bufferRecords);
+      if (!reader.isOpen()) {
+        std::cerr << "Failed to open file: " << run.string() << '\n';
+        return false;
+      }
+      if (reader.next()) { heap.emplace_back(reader.current().color, readers.size() - 1); }
+    }
+    std::ranges::make_heap(heap, std::greater<>{});
+
+    auto const popRun = [&heap, &readers]() -> RunReader & {
+      std::ranges::pop_heap(heap, std::greater<>{});
+      RunReader & reader = readers[heap.back().second];
+      heap.pop_back();
+      return reader;
+    };
+    auto const advance = [&heap, &readers](RunReader & reader) {
+      if (!reader.next()) { return; }
+      heap.emplace_back(reader.current().color, static_cast<std::size_t>(&reader - readers.data()));
+      std::ranges::push_heap(heap, std::greater<>{});
+    };
+    while (!heap.empty()) {
+      RunReader & first = popRun();
+      ColorRecord record = first.current();
+      advance(first);
+      while (!heap.empty() && heap.front().first == record.color) {
+        RunReader & other = popRun();
+        combine(record, other.current().value);
+        advance(other);
+      }
+      visit(record);
+    }
+
+    if (std::ranges::any_of(readers, &RunReader::failed)) {
+      std::cerr << "Failed to read temporary file\n";
+      return false;
+    }
+    return true;
+  }
+}  // namespace image
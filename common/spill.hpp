@@ -0,0 +1,67 @@
+#pragma once
+
+#include <common/colormap.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace image {
+  // Color con un valor asociado: su frecuencia (cutfreq) o su primera aparición (compress)
+  struct ColorRecord {
+      PackedColor color;
+      std::uint64_t value;
+
+      bool operator==(ColorRecord const & other) const = default;
+  };
+
+  // Cómo se combinan los valores de un color que aparece en varios runs
+  enum class RecordCombine : std::uint8_t { Sum, Min };
+
+  // Runs que merge() abre a la vez como mucho
+  inline constexpr std::size_t MAX_MERGE_RUNS = 64;
+
+  // Histograma externo. Los registros se acumulan en memoria ordenados por color y, cuando no
+  // caben en `memoryBudget` bytes, se vuelcan a un fichero temporal como un run ordenado. merge()
+  // fusiona los runs con un montículo, leyendo cada uno con un búfer que reparte el presupuesto
+  // entre todos. Si hay más runs de los que admite mergeFanIn(), los primeros se fusionan antes en
+  // runs intermedios hasta que quedan pocos. Los ficheros temporales se borran al destruir el
+  // objeto.
+  class SpilledColorRuns {
+    public:
+      SpilledColorRuns(std::size_t memoryBudget, RecordCombine combine);
+      SpilledColorRuns(SpilledColorRuns const &)             = delete;
+      SpilledColorRuns & operator=(SpilledColorRuns const &) = delete;
+      SpilledColorRuns(SpilledColorRuns &&)                  = delete;
+      SpilledColorRuns & operator=(SpilledColorRuns &&)      = delete;
+      ~SpilledColorRuns();
+
+      // Añade registros ordenados por color y sin colores repetidos
+      [[nodiscard]] bool add(std::span<ColorRecord const> records);
+
+      // Runs escritos en disco hasta ahora
+      [[nodiscard]] std::size_t runCount() const { return runs_.size(); }
+
+      // Runs que se fusionan a la vez: MAX_MERGE_RUNS, o menos si el presupuesto no da para un
+      // búfer mínimo por run
+      [[nodiscard]] std::size_t mergeFanIn() const;
+
+      // Recorre todos los registros en orden de color, uno por color con los valores combinados.
+      // Se puede llamar varias veces.
+      [[nodiscard]] bool merge(std::function<void(ColorRecord const &)> const & visit);
+
+    private:
+      [[nodiscard]] bool spill();
+      [[nodiscard]] bool mergeFront(std::size_t count);
+      [[nodiscard]] bool mergeRuns(std::span<std::filesystem::path const> runs,
+                                   std::function<void(ColorRecord const &)> const & visit) const;
+      void combine(ColorRecord & into, std::uint64_t value) const;
+
+      std::size_t memoryBudget_;
+      RecordCombine combine_;
+      std::vector<ColorRecord> records_;
+      std::vector<std::filesystem::path> runs_;
+  };
+}  // namespace image
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <atomic>
+#include <common/threadpool.hpp>
+#include <exception>
+#include <memory>
+
+namespace threadpool {
+  namespace {
+    // Bloques por hilo: suficientes para equilibrar la carga sin disparar la sincronización
+    constexpr std::size_t CHUNKS_PER_THREAD = 4;
+
+    struct RangeJob {
+        RangeTask const * task = nullptr;
+        std::size_t begin      = 0;
+        std::size_t end        = 0;
+        std::size_t chunkSize  = 1;
+        std::size_t chunks     = 0;
+        std::atomic<std::size_t> nextChunk{0};
+        std::size_t finishedChunks = 0;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+
+        // Ejecuta bloques hasta que no quede ninguno por repartir
+        void run() {
+          for (std::size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            std::size_t const first = begin + (chunk * chunkSize);
+            std::size_t const last  = std::min(end, first + chunkSize);
+            std::exception_ptr caught;
+            try {
+              (*task)(first, last);
+            } catch (...) {
+              caught = std::current_exception();
+            }
+
+            std::scoped_lock const lock(mutex);
+            if (caught && !error) { error = caught; }
+            if (++finishedChunks == chunks) { finished.notify_all(); }
+          }
+        }
+    };
+
+    std::mutex sharedMutex;
+    std::unique_ptr<ThreadPool> sharedPool;
+    unsigned requestedThreads = 0;
+
+    unsigned defaultThreadCount() { return std::max(1U, std::thread::hardware_concurrency()); }
+  }  // namespace
+
+  ThreadPool::ThreadPool(unsigned const threads) {
+    for (unsigned i = 1; i < std::max(1U, threads); ++i) {
+      workers_.emplace_back([this] { workerLoop(); });
+    }
+  }
+
+  ThreadPool::~ThreadPool() {
+    {
+      std::scoped_lock const lock(mutex_);
+      stopping_ = true;
+    }
+    available_.notify_all();
+    for (auto & worker : workers_) { worker.join(); }
+  }
+
+  void ThreadPool::submit(std::function<void()> job) {
+    {
+      std::scoped_lock const lock(mutex_);
+      queue_.push_back(std::move(job));
+    }
+    available_.notify_one();
+  }
+
+  void ThreadPool::workerLoop() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock lock(mutex_);
+        available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) { return; }
+        job = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      job();
+    }
+  }
+
+  void ThreadPool::parallelFor(std::size_t const begin, std::size_t const end,
+                               RangeTask const & task, std::size_t const grain) {
+    if (begin >= end) { return; }
+
+    std::size_t const count    = end - begin;
+    std::size_t const maxChunk = std::max<std::size_t>(1, count / (size() * CHUNKS_PER_THREAD));
+    runChunks(begin, end, task, std::max(std::max<std::size_t>(1, grain), maxChunk));
+  }
+
+  void ThreadPool::parallelForEach(std::size_t const begin, std::size_t const end,
+                                   IndexTask const & task) {
+    RangeTask const range = [&task](std::size_t const first, std::size_t const last) {
+      for (std::size_t index = first; index < last; ++index) { task(index); }
+    };
+    runChunks(begin, end, range, 1);
+  }
+
+  void ThreadPool::runChunks(std::size_t const begin, std::size_t const end,
+                             RangeTask const & task, std::size_t const chunk) {
+    if (begin >= end) { return; }
+
+    std::size_t const count = end - begin;
+    if (workers_.empty() || chunk >= count) {
+      task(begin, end);
+      return;
+    }
+
+    auto job       = std::make_shared<RangeJob>();
+    job->task      = &task;
+    job->begin     = begin;
+    job->end       = end;
+    job->chunkSize = chunk;
+    job->chunks    = (count + chunk - 1) / chunk;
+
+    std::size_t const helpers = std::min<std::size_t>(workers_.size(), job->chunks - 1);
+    for (std::size_t i = 0; i < helpers; ++i) {
+      submit([job] { job->run(); });
+    }
+    job->run();
+
+    std::unique_lock lock(job->mutex);
+    job->finished.wait(lock, [&job] { return job->finishedChunks == job->chunks; });
+    if (job->error) { std::rethrow_exception(job->error); }
+  }
+
+  void setThreadCount(unsigned const threads) {
+    std::scoped_lock const lock(sharedMutex);
+    requestedThreads         = threads;
+    unsigned const effective = threads != 0 ? threads : defaultThreadCount();
+    if (sharedPool && sharedPool->size() != effective) { sharedPool.reset(); }
+  }
+
+  unsigned threadCount() {
+    std::scoped_lock const lock(sharedMutex);
+    return requestedThreads != 0 ? requestedThreads : defaultThreadCount();
+  }
+
+  ThreadPool & shared() {
+    std::scoped_lock const lock(sharedMutex);
+    if (!sharedPool) {
+      sharedPool = std::make_unique<ThreadPool>(requestedThreads != 0 ? requestedThreads
+                                                                      : defaultThreadCount());
+    }
+    return *sharedPool;
+  }
+}  // namespace threadpool
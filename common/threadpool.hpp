@@ -0,0 +1,67 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace threadpool {
+  using RangeTask = std::function<void(std::size_t first, std::size_t last)>;
+  using IndexTask = std::function<void(std::size_t index)>;
+
+  // Conjunto fijo de hilos trabajadores. El hilo que llama a parallelFor también procesa bloques,
+  // por lo que las llamadas anidadas desde una tarea no bloquean el pool.
+  class ThreadPool {
+    public:
+      explicit ThreadPool(unsigned threads);
+      ~ThreadPool();
+      ThreadPool(ThreadPool const &)             = delete;
+      ThreadPool & operator=(ThreadPool const &) = delete;
+      ThreadPool(ThreadPool &&)                  = delete;
+      ThreadPool & operator=(ThreadPool &&)      = delete;
+
+      // Número total de hilos que ejecutan trabajo, incluido el llamante
+      [[nodiscard]] unsigned size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+      // Reparte [begin, end) en bloques de al menos `grain` elementos y espera a que terminen.
+      // Si alguna tarea lanza una excepción, se relanza en el hilo llamante.
+      void parallelFor(std::size_t begin, std::size_t end, RangeTask const & task,
+                       std::size_t grain = 1);
+
+      // Reparte los índices de [begin, end) de uno en uno: cada hilo toma el siguiente índice libre
+      // al terminar el anterior. Para tareas de coste muy desigual, como los trabajos de un lote,
+      // donde los bloques de parallelFor dejarían hilos parados al final.
+      void parallelForEach(std::size_t begin, std::size_t end, IndexTask const & task);
+
+    private:
+      void runChunks(std::size_t begin, std::size_t end, RangeTask const & task,
+                     std::size_t chunk);
+      void submit(std::function<void()> job);
+      void workerLoop();
+
+      std::vector<std::thread> workers_;
+      std::deque<std::function<void()>> queue_;
+      std::mutex mutex_;
+      std::condition_variable available_;
+      bool stopping_ = false;
+  };
+
+  // Pool compartido por todas las operaciones. Por defecto usa todos los núcleos disponibles;
+  // setThreadCount (opción --threads) lo redimensiona.
+  void setThreadCount(unsigned threads);
+  [[nodiscard]] unsigned threadCount();
+  [[nodiscard]] ThreadPool & shared();
+
+  inline void parallelFor(std::size_t const begin, std::size_t const end, RangeTask const & task,
+                          std::size_t const grain = 1) {
+    shared().parallelFor(begin, end, task, grain);
+  }
+
+  inline void parallelForEach(std::size_t const begin, std::size_t const end,
+                              IndexTask const & task) {
+    shared().parallelForEach(begin, end, task);
+  }
+}  // namespace threadpool
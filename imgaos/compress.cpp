@@ -1,27 +1,20 @@
-#include <algorithm>
+#include <common/bitpack.hpp>
+#include <common/colorindex.hpp>
+#include <common/compressed.hpp>
+#include <common/labelmap.hpp>
+#include <common/threadpool.hpp>
 #include <fstream>
 #include <imgaos/imageaos.hpp>
 #include <iostream>
-#include <ranges>
-#include <unordered_map>
+#include <stdexcept>
 #include <vector>
 
-template <>
-struct std::hash<imageaos::Pixel> {
-    std::size_t operator()(imageaos::Pixel const & pixel) const noexcept {
-      std::size_t const hash1 = std::hash<unsigned short>{}(pixel.red);
-      std::size_t const hash2 = std::hash<unsigned short>{}(pixel.green);
-      std::size_t const hash3 = std::hash<unsigned short>{}(pixel.blue);
-
-      return hash1 ^ (hash2 << 1) ^ (hash3 << 3);
-    }
-};
-
 namespace imageaos {
   namespace {
     constexpr unsigned short COLOR_TABLE_SIZE_8  = 8;
     constexpr unsigned short COLOR_TABLE_SIZE_16 = 16;
     constexpr unsigned short COLOR_TABLE_SIZE_32 = 32;
+    constexpr std::size_t ENCODE_GRAIN           = std::size_t{1} << 16;
 
     unsigned short getPixelByteSize(unsigned long const colorTableSize) {
       if (colorTableSize <= (1UL << COLOR_TABLE_SIZE_8)) { return 1; }
@@ -31,7 +24,8 @@ namespace imageaos {
     }
   }  // namespace
 
-  bool Image::saveToFileCompress(std::string const & filePath) const {
+  bool Image::saveToFileCompress(std::string const & filePath,
+                                 image::CompressFormat const format) const {
     std::ofstream file(filePath, std::ios::binary);
     if (!file.is_open()) {
       std::cerr << "Failed to open file: " << filePath << '\n';
@@ -39,7 +33,7 @@ namespace imageaos {
     }
 
     auto const colorTable = getColorTable();
-    if (!writeHeaderCompress(file, colorTable.size())) {
+    if (!writeHeaderCompress(file, colorTable.size(), format)) {
       file.close();
       return false;
     }
@@ -49,7 +43,7 @@ namespace imageaos {
       return false;
     }
 
-    if (!writePixelDataCompress(file, colorTable)) {
+    if (!writePixelDataCompress(file, colorTable, format)) {
       file.close();
       return false;
     }
@@ -58,82 +52,85 @@ namespace imageaos {
     return true;
   }
 
-  std::unordered_map<Pixel, unsigned long> Image::getColorTable() const {
-    constexpr unsigned long maxColors = 1UL << 32;
-    std::unordered_map<Pixel, unsigned long> colorTable;
-    colorTable.reserve(pixels_.size());
+  image::ColorLabels Image::labelColors() const { return image::labelColors(getChannels()); }
 
-    unsigned long index = 0;
-    for (auto const & pixel : pixels_) {
-      if (auto const [fst, snd] = colorTable.insert({pixel, index}); snd) { ++index; }
+  // Con las etiquetas ya calculadas, la tabla de colores es la lista de colores por etiqueta y
+  // los índices de píxel son las propias etiquetas
+  bool Image::saveToFileCompress(std::string const & filePath,
+                                 image::ColorLabels const & labels,
+                                 image::CompressFormat const format) const {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) {
+      std::cerr << "Failed to open file: " << filePath << '\n';
+      return false;
     }
 
-    if (colorTable.size() > maxColors) {
-      throw std::overflow_error("Color table exceeds 2^32 unique colors.");
+    if (labels.colors.size() > image::MAX_INDEXED_COLORS) {
+      throw std::overflow_error("Color table exceeds 2^32 - 1 unique colors.");
     }
+    if (!writeHeaderCompress(file, labels.colors.size(), format)) { return false; }
+    return image::writeLabeledCompress(file, labels, getMaxColorValue(), format);
+  }
 
+  image::ColorIndexTable Image::getColorTable() const {
+    image::ColorIndexTable colorTable(getChannels(), getMaxColorValue());
+    if (colorTable.size() > image::MAX_INDEXED_COLORS) {
+      throw std::overflow_error("Color table exceeds 2^32 - 1 unique colors.");
+    }
     return colorTable;
   }
 
   bool Image::writeColorTable(std::ofstream & file,
-                              std::unordered_map<Pixel, unsigned long> const & colorTable) const {
-    unsigned char const scaleFactor = getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT ? 2 : 1;
-    std::vector<std::pair<Pixel, unsigned long>> sortedColorTable(colorTable.begin(),
-                                                                  colorTable.end());
-    std::ranges::sort(sortedColorTable, [](auto const & lhs, auto const & rhs) {
-      return lhs.second < rhs.second;
-    });
-    std::vector<char> buffer;
-    buffer.reserve(sortedColorTable.size() * 3 * scaleFactor);
-
-    if (scaleFactor == 2) {
-      for (auto const & [red, green, blue] : sortedColorTable | std::views::keys) {
-        buffer.push_back(static_cast<char>(red >> BYTE_SHIFT));
-        buffer.push_back(static_cast<char>(red & BYTE_MASK));
-        buffer.push_back(static_cast<char>(green >> BYTE_SHIFT));
-        buffer.push_back(static_cast<char>(green & BYTE_MASK));
-        buffer.push_back(static_cast<char>(blue >> BYTE_SHIFT));
-        buffer.push_back(static_cast<char>(blue & BYTE_MASK));
-      }
-    } else {
-      for (auto const & [red, green, blue] : sortedColorTable | std::views::keys) {
-        buffer.push_back(static_cast<char>(red));
-        buffer.push_back(static_cast<char>(green));
-        buffer.push_back(static_cast<char>(blue));
-      }
-    }
-
-    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-    return file.good();
+                              image::ColorIndexTable const & colorTable) const {
+    return image::writeCompressColorTable(file, colorTable.colors(), getMaxColorValue());
   }
 
-  bool Image::writePixelDataCompress(
-      std::ofstream & file, std::unordered_map<Pixel, unsigned long> const & colorTable) const {
+  // Cada píxel ocupa byteSize bytes en una posición fija del buffer, así que los índices se
+  // codifican en paralelo sobre el buffer ya reservado. La variante empaquetada usa packIndices.
+  bool Image::writePixelDataCompress(std::ofstream & file,
+                                     image::ColorIndexTable const & colorTable,
+                                     image::CompressFormat const format) const {
+    image::PixelChannels const channels = getChannels();
+    if (format == image::CompressFormat::BitPacked) {
+      std::vector<char> const packed = image::packIndices(
+          channels.count, image::indexBitWidth(colorTable.size()),
+          [&](std::size_t const first, std::span<std::uint32_t> indices) {
+            for (std::size_t i = 0; i < indices.size(); ++i) {
+              indices[i] = colorTable.indexAt(channels, first + i);
+            }
+          });
+      file.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+      return file.good();
+    }
+
     unsigned short const byteSize = getPixelByteSize(colorTable.size());
 
-    std::vector<char> buffer;
-    buffer.reserve(getHeight() * getWidth() * byteSize);
-
-    for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        Pixel const & pixel   = getPixel(xPos, yPos);
-        auto const colorIndex = colorTable.at(pixel);
-
-        if (byteSize == 1) {
-          buffer.push_back(static_cast<char>(colorIndex & BYTE_MASK));
-        } else if (byteSize == 2) {
-          buffer.push_back(static_cast<char>(colorIndex & BYTE_MASK));
-          buffer.push_back(static_cast<char>(colorIndex >> COLOR_TABLE_SIZE_8 & BYTE_MASK));
-        } else if (byteSize == 4) {
-          buffer.push_back(static_cast<char>(colorIndex & BYTE_MASK));
-          buffer.push_back(static_cast<char>(colorIndex >> COLOR_TABLE_SIZE_8 & BYTE_MASK));
-          buffer.push_back(static_cast<char>(colorIndex >> COLOR_TABLE_SIZE_16 & BYTE_MASK));
-          buffer.push_back(static_cast<char>(colorIndex >> COLOR_TABLE_SIZE_32 & BYTE_MASK));
-        }
-      }
-    }
+    std::vector<char> buffer(channels.count * byteSize);
+    threadpool::parallelFor(
+        0, channels.count,
+        [&](std::size_t const first, std::size_t const last) {
+          for (std::size_t pixel = first; pixel < last; ++pixel) {
+            auto const colorIndex = colorTable.indexAt(channels, pixel);
+            for (unsigned short byte = 0; byte < byteSize; ++byte) {
+              buffer[(pixel * byteSize) + byte] =
+                  static_cast<char>(colorIndex >> (byte * COLOR_TABLE_SIZE_8) & BYTE_MASK);
+            }
+          }
+        },
+        ENCODE_GRAIN);
 
     file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
     return file.good();
   }
+
+  bool Image::loadFromFileCompress(std::string const & filePath) {
+    image::CompressedImage compressed;
+    if (!image::readCompressed(filePath, compressed)) { return false; }
+
+    setWidth(compressed.header.getWidth());
+    setHeight(compressed.header.getHeight());
+    setMaxColorValue(compressed.header.getMaxColorValue());
+    pixels_.assign(compressed.pixelCount(), Pixel{});
+    return image::expandCompressed(compressed, getWritableChannels());
+  }
 }  // namespace imageaos
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <common/colorsearch.hpp>
+#include <common/histogram.hpp>
+#include <common/labelmap.hpp>
+#include <common/replacement.hpp>
 #include <cstdint>
 #include <imgaos/imageaos.hpp>
 #include <limits>
@@ -10,26 +14,21 @@
 #include <vector>
 
 namespace imageaos {
-  // Función para contar la frecuencia de colores
-  std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> Image::countColorFrequencies() const {
-    std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> colorFrequency;
-    for (Pixel const & pixel : pixels_) {
-      auto color = std::make_tuple(pixel.red, pixel.green, pixel.blue);
-      colorFrequency[color]++;
-    }
-    return colorFrequency;
+  // Función para contar la frecuencia de colores con el histograma de colores empaquetados
+  std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
+      Image::countColorFrequencies() const {
+    return image::unpackFrequencies(image::countColors(getChannels(), getMaxColorValue()));
   }
 
-  // Función que crea un vector de colores ordenado por frecuencia
+  // Función que ordena los colores por frecuencia y, a igual frecuencia, por color
   std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
       Image::sortColorsByFrequency(
-          std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> const & colorFrequency) {
-    std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> colorFreqVector(
-        colorFrequency.begin(), colorFrequency.end());
-    std::ranges::sort(colorFreqVector, [](auto const & colorFreq1, auto const & colorFreq2) {
-      return colorFreq1.second < colorFreq2.second;
+          std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> colorFrequency) {
+    std::ranges::sort(colorFrequency, [](auto const & colorFreq1, auto const & colorFreq2) {
+      return std::tie(colorFreq1.second, colorFreq1.first) <
+             std::tie(colorFreq2.second, colorFreq2.first);
     });
-    return colorFreqVector;
+    return colorFrequency;
   }
 
   // Función para separar los colores en dos grupos: los colores menos frecuentes y los que deben
@@ -58,15 +57,18 @@ namespace imageaos {
   std::tuple<uint16_t, uint16_t, uint16_t> Image::findClosestColor(
       std::tuple<uint16_t, uint16_t, uint16_t> const & colorToRemove,
       std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> const & remainingColors) {
-    auto [r1, g1, b1]      = colorToRemove;
-    int minDistanceSquared = std::numeric_limits<int>::max();
+    auto [r1, g1, b1]               = colorToRemove;
+    std::int64_t minDistanceSquared = std::numeric_limits<std::int64_t>::max();
     std::tuple<uint16_t, uint16_t, uint16_t> closestColor;
 
     for (auto const & color : remainingColors) {
-      auto [r2, g2, b2]         = color;
-      int const distanceSquared = ((static_cast<int>(r1) - r2) * (static_cast<int>(r1) - r2)) +
-                                  ((static_cast<int>(g1) - g2) * (static_cast<int>(g1) - g2)) +
-                                  ((static_cast<int>(b1) - b2) * (static_cast<int>(b1) - b2));
+      auto [r2, g2, b2]             = color;
+      std::int64_t const deltaRed   = static_cast<std::int64_t>(r1) - r2;
+      std::int64_t const deltaGreen = static_cast<std::int64_t>(g1) - g2;
+      std::int64_t const deltaBlue  = static_cast<std::int64_t>(b1) - b2;
+
+      std::int64_t const distanceSquared =
+          (deltaRed * deltaRed) + (deltaGreen * deltaGreen) + (deltaBlue * deltaBlue);
 
       if (distanceSquared < minDistanceSquared) {
         minDistanceSquared = distanceSquared;
@@ -87,34 +89,45 @@ namespace imageaos {
     auto const & colorsToRemove  = colors.first;
     auto const & remainingColors = colors.second;
 
-    for (auto const & colorToRemove : colorsToRemove) {
-      replacementMap[colorToRemove] = findClosestColor(colorToRemove, remainingColors);
+    // Misma elección que findClosestColor, pero con un árbol k-d y las búsquedas en paralelo
+    auto const replacements = image::nearestColors(remainingColors, colorsToRemove);
+    for (std::size_t i = 0; i < colorsToRemove.size(); ++i) {
+      replacementMap[colorsToRemove[i]] = replacements[i];
     }
     return replacementMap;
   }
 
-  // Función para sustituir los colores con menor frecuencia
+  // Función para sustituir los colores con menor frecuencia: el mapa se pasa a una tabla plana y
+  // los píxeles se recorren en paralelo
   void Image::replaceColors(
       std::map<std::tuple<uint16_t, uint16_t, uint16_t>,
                std::tuple<uint16_t, uint16_t, uint16_t>> const & replacementMap) {
-    for (Pixel & pixel : pixels_) {
-      auto color = std::make_tuple(pixel.red, pixel.green, pixel.blue);
-      if (replacementMap.contains(color)) {
-        auto [newRed, newGreen, newBlue] = replacementMap.at(color);
-        pixel.red                        = newRed;
-        pixel.green                      = newGreen;
-        pixel.blue                       = newBlue;
-      }
-    }
+    image::replacementTable(replacementMap).apply(getWritableChannels());
   }
 
-  // Función cutfreq
+  // Función cutfreq: elimina los mismos colores que sortColorsByFrequency y splitColors, pero sin
+  // ordenar el histograma
   void Image::cutfreq(std::uint32_t n) {
-    auto colorFrequency                    = countColorFrequencies();
-    auto sortedColors                      = sortColorsByFrequency(colorFrequency);
-    auto [colorsToRemove, remainingColors] = splitColors(sortedColors, n);
-    auto replacementMap = buildReplacementMap(std::make_pair(colorsToRemove, remainingColors));
+    auto const colors = image::splitLeastFrequent(
+        image::countColors(getChannels(), getMaxColorValue()), n);
+    replaceColors(buildReplacementMap(colors));
+  }
+
+  // cutfreq a partir de las etiquetas de labelColors: el histograma sale de sus contadores y la
+  // sustitución se resuelve una vez por etiqueta
+  void Image::cutfreq(std::uint32_t n, image::ColorLabels const & labels) {
+    auto const colors = image::splitLeastFrequent(image::labeledHistogram(labels), n);
+    image::replaceLabeledColors(getWritableChannels(), labels,
+                                image::replacementTable(buildReplacementMap(colors)));
+  }
 
-    replaceColors(replacementMap);
+  // Los sustitutos solo se buscan en las celdas vecinas de una rejilla RGB y se aplican sin pasar
+  // por el mapa ordenado de buildReplacementMap
+  std::int64_t Image::cutfreqApproximate(std::uint32_t n) {
+    auto const [colorsToRemove, remainingColors] = image::splitLeastFrequent(
+        image::countColors(getChannels(), getMaxColorValue()), n);
+    auto const replacements = image::approximateNearestColors(remainingColors, colorsToRemove);
+    image::replacementTable(colorsToRemove, replacements.colors).apply(getWritableChannels());
+    return replacements.maxError;
   }
 }
\ No newline at end of file
@@ -1,42 +1,47 @@
+#include <common/pixelio.hpp>
 #include <fstream>
 #include <imgaos/imageaos.hpp>
 #include <iostream>
+#include <span>
 #include <string>
+#include <utility>
 
 namespace imageaos {
-  bool Image::readPixelData(std::ifstream & file) {
+  bool Image::readPixelData(image::PixelSource & source) {
+    // Tras un resize, el búfer con más capacidad puede ser el de reserva
+    if (spare_.capacity() > pixels_.capacity()) { std::swap(pixels_, spare_); }
     pixels_.resize(getWidth() * getHeight());
 
-    unsigned char const scaleFactor = getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT ? 2 : 1;
+    std::size_t const sampleBytes = image::bytesPerSample(getMaxColorValue());
+    std::size_t const rowBytes    = getWidth() * image::CHANNELS * sampleBytes;
 
     for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        Pixel & pixel = getPixel(xPos, yPos);
-
-        unsigned short const red =
-            scaleFactor == 2 ? static_cast<unsigned short>(file.get() << BYTE_SHIFT | file.get())
-                             : static_cast<unsigned short>(file.get());
-        unsigned short const green =
-            scaleFactor == 2 ? static_cast<unsigned short>(file.get() << BYTE_SHIFT | file.get())
-                             : static_cast<unsigned short>(file.get());
-        unsigned short const blue =
-            scaleFactor == 2 ? static_cast<unsigned short>(file.get() << BYTE_SHIFT | file.get())
-                             : static_cast<unsigned short>(file.get());
-
-        if (file.eof()) {
-          std::cerr << "Unexpected end of file while reading pixel data.\n";
-          return false;
-        }
-
-        pixel.setRed(red);
-        pixel.setGreen(green);
-        pixel.setBlue(blue);
+      std::span<unsigned char const> const row = source.next(rowBytes);
+      if (row.size() != rowBytes) {
+        std::cerr << "Unexpected end of file while reading pixel data.\n";
+        return false;
       }
+
+      std::span<Pixel> const pixelRow = std::span(pixels_).subspan(yPos * getWidth(), getWidth());
+      image::decodeRow(row, sampleBytes,
+                       [pixelRow](std::size_t const xPos, unsigned short const red,
+                                  unsigned short const green, unsigned short const blue) {
+                         pixelRow[xPos] = {.red = red, .green = green, .blue = blue};
+                       });
     }
 
     return true;
   }
 
+  void Image::trimBuffers(std::size_t const maxBytes) {
+    if ((pixels_.capacity() + spare_.capacity()) * sizeof(Pixel) <= maxBytes) { return; }
+    spare_ = std::vector<Pixel>();
+    if (pixels_.capacity() * sizeof(Pixel) <= maxBytes) { return; }
+    pixels_ = std::vector<Pixel>();
+    setWidth(0);
+    setHeight(0);
+  }
+
   bool Image::loadFromFile(std::string const & filePath) {
     std::ifstream file(filePath, std::ios::binary);
     if (!file.is_open()) {
@@ -49,35 +54,23 @@ namespace imageaos {
       return false;
     }
 
-    bool const pixelDataRead = readPixelData(file);
-    file.close();
-
-    return pixelDataRead;
+    image::PixelSource source(file, filePath);
+    return readPixelData(source);
   }
 
   bool Image::writePixelData(std::ofstream & file) const {
-    unsigned char const scaleFactor = getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT ? 2 : 1;
-
-    for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        auto const & [red, green, blue] = getPixel(xPos, yPos);
-
-        if (scaleFactor == 2) {
-          file.put(static_cast<char>(red >> BYTE_SHIFT));
-          file.put(static_cast<char>(red & BYTE_MASK));
-          file.put(static_cast<char>(green >> BYTE_SHIFT));
-          file.put(static_cast<char>(green & BYTE_MASK));
-          file.put(static_cast<char>(blue >> BYTE_SHIFT));
-          file.put(static_cast<char>(blue & BYTE_MASK));
-        } else {
-          file.put(static_cast<char>(red));
-          file.put(static_cast<char>(green));
-          file.put(static_cast<char>(blue));
-        }
-      }
-    }
-
-    return file.good();
+    std::size_t const sampleBytes = image::bytesPerSample(getMaxColorValue());
+    std::size_t const rowBytes    = getWidth() * image::CHANNELS * sampleBytes;
+    std::span<unsigned short const> const samples = getSamples();
+
+    return image::writeRows(file, rowBytes, getHeight(),
+                            [this, samples, sampleBytes](std::size_t const yPos,
+                                                         std::span<unsigned char> const out) {
+                              image::encodeSamples(samples.subspan(yPos * getWidth() *
+                                                                       image::CHANNELS,
+                                                                   getWidth() * image::CHANNELS),
+                                                   sampleBytes, out);
+                            });
   }
 
   bool Image::saveToFile(std::string const & filePath) const {
@@ -98,6 +91,34 @@ namespace imageaos {
     return pixelDataWritten;
   }
 
+  std::span<unsigned short const> Image::getSamples() const {
+    static_assert(sizeof(Pixel) == image::CHANNELS * sizeof(unsigned short));
+    return {reinterpret_cast<unsigned short const *>(pixels_.data()),  // NOLINT
+            pixels_.size() * image::CHANNELS};
+  }
+
+  std::span<unsigned short> Image::getSamples() {
+    return {reinterpret_cast<unsigned short *>(pixels_.data()),  // NOLINT
+            pixels_.size() * image::CHANNELS};
+  }
+
+  // Los canales verde y azul empiezan una muestra más allá; sin píxeles las vistas quedan vacías
+  image::PixelChannels Image::getChannels() const {
+    if (pixels_.empty()) { return {.channels = {}, .stride = image::CHANNELS, .count = 0}; }
+    std::span<unsigned short const> const samples = getSamples();
+    return {.channels = {samples, samples.subspan(1), samples.subspan(2)},
+            .stride   = image::CHANNELS,
+            .count    = pixels_.size()};
+  }
+
+  image::WritablePixelChannels Image::getWritableChannels() {
+    if (pixels_.empty()) { return {.channels = {}, .stride = image::CHANNELS, .count = 0}; }
+    std::span<unsigned short> const samples = getSamples();
+    return {.channels = {samples, samples.subspan(1), samples.subspan(2)},
+            .stride   = image::CHANNELS,
+            .count    = pixels_.size()};
+  }
+
   Pixel & Image::getPixel(unsigned long const xPos, unsigned long const yPos) {
     return pixels_.at((yPos * getWidth()) + xPos);
   }
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <common/colorindex.hpp>
 #include <common/image.hpp>
+#include <common/labelmap.hpp>
+#include <common/leveltable.hpp>
+#include <common/pixelio.hpp>
+#include <common/resample.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <map>
+#include <span>
 #include <string>
 #include <tuple>
-#include <unordered_map>
 #include <vector>
 
 namespace imageaos {
@@ -68,33 +74,72 @@ namespace imageaos {
 
       Pixel & getPixel(unsigned long xPos, unsigned long yPos);
       [[nodiscard]] Pixel const & getPixel(unsigned long xPos, unsigned long yPos) const;
+      // Vista de los píxeles como muestras RGB entrelazadas
+      [[nodiscard]] std::span<unsigned short const> getSamples() const;
+      [[nodiscard]] std::span<unsigned short> getSamples();
+      // Vista de los tres canales para las operaciones comunes (histograma, etiquetas...)
+      [[nodiscard]] image::PixelChannels getChannels() const;
+      [[nodiscard]] image::WritablePixelChannels getWritableChannels();
 
       bool loadFromFile(std::string const & filePath);
       [[nodiscard]] bool saveToFile(std::string const & filePath) const;
       void displayMetadata() const;
       void modifyMaxLevel(unsigned short newMaxColorValue);
+      // maxlevel con una tabla ya calculada, p. ej. la composición de varios maxlevel
+      void modifyMaxLevel(image::LevelTable const & levels, unsigned short newMaxColorValue);
       void setPixel(unsigned long xPos, unsigned long yPos, Pixel const & pixel);
 
       void resize(unsigned long new_width, unsigned long new_height);
+      // resize y maxlevel en una sola pasada: cada fila de destino pasa por `levels` en el mismo
+      // bucle que la calcula
+      void resize(unsigned long new_width, unsigned long new_height,
+                  image::LevelTable const & levels, unsigned short newMaxColorValue);
+      // Bilineal en punto fijo, con el mismo redondeo que la versión SOA
+      void resizeFixed(unsigned long new_width, unsigned long new_height);
+      // Remuestreo separable con el filtro indicado
+      void resample(unsigned long new_width, unsigned long new_height,
+                    image::ResampleFilter filter);
       [[nodiscard]] Pixel interpolate(DimensionsResize dims) const;
       [[nodiscard]] Pixel interpolate2(InterpolateArgs const & interpolate_args) const;
-      [[nodiscard]] bool saveToFileCompress(std::string const & filePath) const;
+      // Cuando el mismo objeto procesa varios ficheros (lotes y servidor), resize conserva el búfer
+      // de origen para la siguiente carga o resize. Con una sola imagen no hace falta y subiría el
+      // pico de memoria de la cadena de operaciones.
+      void setRecycleBuffers(bool const recycle) { recycleBuffers_ = recycle; }
+      // Tras un trabajo reciclado: libera spare_ y, si aún no basta, los píxeles cuando entre los
+      // dos reservan más de `maxBytes`. Si libera los píxeles, la imagen queda vacía.
+      void trimBuffers(std::size_t maxBytes);
+      // Carga un fichero C6 o C6v2 expandiendo sus índices con la tabla de colores
+      bool loadFromFileCompress(std::string const & filePath);
+      // Con CompressFormat::BitPacked escribe la variante C6v2 de índices empaquetados
+      [[nodiscard]] bool saveToFileCompress(
+          std::string const & filePath,
+          image::CompressFormat format = image::CompressFormat::ByteAligned) const;
       void cutfreq(std::uint32_t n);
-
-      bool readPixelData(std::ifstream & file);
+      // Etiqueta de color de cada píxel; las versiones de compress y cutfreq que la reciben no
+      // vuelven a buscar el color de cada píxel
+      [[nodiscard]] image::ColorLabels labelColors() const;
+      [[nodiscard]] bool saveToFileCompress(
+          std::string const & filePath, image::ColorLabels const & labels,
+          image::CompressFormat format = image::CompressFormat::ByteAligned) const;
+      void cutfreq(std::uint32_t n, image::ColorLabels const & labels);
+      // cutfreq aproximado (ColorGrid); devuelve la cota del error en distancia al cuadrado
+      std::int64_t cutfreqApproximate(std::uint32_t n);
+
+      bool readPixelData(image::PixelSource & source);
       bool writePixelData(std::ofstream & file) const;
-      [[nodiscard]] std::unordered_map<Pixel, unsigned long> getColorTable() const;
-      bool writeColorTable(std::ofstream & file,
-                           std::unordered_map<Pixel, unsigned long> const & colorTable) const;
-      bool
-          writePixelDataCompress(std::ofstream & file,
-                                 std::unordered_map<Pixel, unsigned long> const & colorTable) const;
-
-      [[nodiscard]] std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int>
+      // Índice de cada color por orden de primera aparición, en una tabla plana
+      [[nodiscard]] image::ColorIndexTable getColorTable() const;
+      bool writeColorTable(std::ofstream & file, image::ColorIndexTable const & colorTable) const;
+      bool writePixelDataCompress(
+          std::ofstream & file, image::ColorIndexTable const & colorTable,
+          image::CompressFormat format = image::CompressFormat::ByteAligned) const;
+
+      // Frecuencia de cada color, ordenada por color
+      [[nodiscard]] std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
           countColorFrequencies() const;
       [[nodiscard]] static std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
           sortColorsByFrequency(
-              std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> const & colorFrequency);
+              std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> colorFrequency);
       [[nodiscard]] static std::pair<std::vector<std::tuple<uint16_t, uint16_t, uint16_t>>,
                                      std::vector<std::tuple<uint16_t, uint16_t, uint16_t>>>
           splitColors(std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> const &
@@ -112,5 +157,15 @@ namespace imageaos {
       void replaceColors(std::map<std::tuple<uint16_t, uint16_t, uint16_t>,
                                   std::tuple<uint16_t, uint16_t, uint16_t>> const & replacementMap);
       std::vector<Pixel> pixels_;
+      // Destino de resize, que lo intercambia con pixels_. Con recycleBuffers_ conserva la memoria
+      // de la imagen anterior para la siguiente carga o resize; si no, se libera tras el resize.
+      std::vector<Pixel> spare_;
+      bool recycleBuffers_ = false;
   };
+
+  // resize por bandas de filas, leyendo y escribiendo los ficheros sin cargar la imagen completa;
+  // escribe los mismos píxeles que Image::resize. `memoryLimit` acota los búferes de cada banda.
+  [[nodiscard]] bool resizeStream(std::string const & inputPath, std::string const & outputPath,
+                                  unsigned long new_width, unsigned long new_height,
+                                  std::size_t memoryLimit);
 }  // namespace imageaos
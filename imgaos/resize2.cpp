@@ -1,5 +1,11 @@
+#include <algorithm>
 #include <cmath>
+#include <common/leveltable.hpp>
+#include <common/resample.hpp>
+#include <common/rowstream.hpp>
+#include <common/threadpool.hpp>
 #include <imgaos/imageaos.hpp>
+#include <utility>
 #include <vector>
 
 namespace imageaos {
@@ -15,57 +21,189 @@ namespace imageaos {
       result.blue  = static_cast<unsigned short>(lerp(pixel0.blue, pixel1.blue, t_factor));
       return result;
     }
-  }  // namespace
 
-  Pixel Image::interpolate2(InterpolateArgs const & interpolate_args) const {
-    auto [x, y]        = interpolate_args;
-    float const x_low  = std::floor(x);
-    float const x_high = std::ceil(x);
-    float const y_low  = std::floor(y);
-    float const y_high = std::ceil(y);
+    // Interpolación de interpolate2 a partir de las filas de origen floor(y) y ceil(y)
+    Pixel interpolateRows(std::span<Pixel const> low_row, std::span<Pixel const> high_row,
+                          InterpolateArgs const & interpolate_args) {
+      auto [x, y]        = interpolate_args;
+      float const x_low  = std::floor(x);
+      float const x_high = std::ceil(x);
+      float const y_low  = std::floor(y);
+      float const y_high = std::ceil(y);
 
-    Pixel const p00 =
-        getPixel(static_cast<unsigned long>(x_low), static_cast<unsigned long>(y_low));
-    Pixel const p10 =
-        getPixel(static_cast<unsigned long>(x_high), static_cast<unsigned long>(y_low));
-    Pixel const p01 =
-        getPixel(static_cast<unsigned long>(x_low), static_cast<unsigned long>(y_high));
-    Pixel const p11 =
-        getPixel(static_cast<unsigned long>(x_high), static_cast<unsigned long>(y_high));
+      Pixel const p00 = low_row[static_cast<unsigned long>(x_low)];
+      Pixel const p10 = low_row[static_cast<unsigned long>(x_high)];
+      Pixel const p01 = high_row[static_cast<unsigned long>(x_low)];
+      Pixel const p11 = high_row[static_cast<unsigned long>(x_high)];
 
-    float t_factor_x = 0.0F;
-    float t_factor_y = 0.0F;
+      float t_factor_x = 0.0F;
+      float t_factor_y = 0.0F;
 
-    if (x_high != x_low) { t_factor_x = (x - x_low) / (x_high - x_low); }
-    if (y_high != y_low) { t_factor_y = (y - y_low) / (y_high - y_low); }
+      if (x_high != x_low) { t_factor_x = (x - x_low) / (x_high - x_low); }
+      if (y_high != y_low) { t_factor_y = (y - y_low) / (y_high - y_low); }
 
-    Pixel const topPixel    = interpolatePixel(p00, p10, t_factor_x);
-    Pixel const bottomPixel = interpolatePixel(p01, p11, t_factor_x);
+      Pixel const topPixel    = interpolatePixel(p00, p10, t_factor_x);
+      Pixel const bottomPixel = interpolatePixel(p01, p11, t_factor_x);
 
-    Pixel const result = interpolatePixel(topPixel, bottomPixel, t_factor_y);
+      return interpolatePixel(topPixel, bottomPixel, t_factor_y);
+    }
 
-    return result;
-  }
+    // Razones y límites de las coordenadas de origen de resize
+    struct ResizeRatios {
+        float x_ratio;
+        float y_ratio;
+        float x_max;
+        float y_max;
+    };
 
-  void Image::resize(unsigned long const new_width, unsigned long const new_height) {
-    std::vector<Pixel> new_pixels(new_width * new_height);
+    ResizeRatios resizeRatios(image::Image const & source, unsigned long const new_width,
+                              unsigned long const new_height) {
+      // El redondeo de float puede dejar la última coordenada ligeramente fuera de la imagen
+      return {.x_ratio = new_width > 1 ? static_cast<float>(source.getWidth() - 1) /
+                                             static_cast<float>(new_width - 1)
+                                       : 0.0F,
+              .y_ratio = new_height > 1 ? static_cast<float>(source.getHeight() - 1) /
+                                              static_cast<float>(new_height - 1)
+                                        : 0.0F,
+              .x_max   = static_cast<float>(source.getWidth() - 1),
+              .y_max   = static_cast<float>(source.getHeight() - 1)};
+    }
+
+    // Cada hilo calcula un bloque de filas de destino; los píxeles son independientes entre sí,
+    // así que el resultado no depende del número de hilos. Con `levels`, cada fila pasa por la
+    // tabla en cuanto se calcula, mientras sigue en caché.
+    void resizePixels(Image const & image, unsigned long const new_width,
+                      unsigned long const new_height, image::LevelTable const * levels,
+                      std::vector<Pixel> & new_pixels) {
+      new_pixels.resize(new_width * new_height);
+      auto const [x_ratio, y_ratio, x_max, y_max] = resizeRatios(image, new_width, new_height);
+      std::span<unsigned short> const samples(
+          reinterpret_cast<unsigned short *>(new_pixels.data()),  // NOLINT
+          new_pixels.size() * image::CHANNELS);
+
+      threadpool::parallelFor(0, new_height, [&](std::size_t const first, std::size_t const last) {
+        for (unsigned long new_y = first; new_y < last; new_y++) {
+          float const y_original = std::min(static_cast<float>(new_y) * y_ratio, y_max);
+          for (unsigned long new_x = 0; new_x < new_width; new_x++) {
+            float const x_original = std::min(static_cast<float>(new_x) * x_ratio, x_max);
 
-    float const x_ratio = static_cast<float>(getWidth() - 1) / static_cast<float>(new_width - 1);
-    float const y_ratio = static_cast<float>(getHeight() - 1) / static_cast<float>(new_height - 1);
+            auto const interpolate_args             = InterpolateArgs(x_original, y_original);
+            Pixel const new_pixel                   = image.interpolate2(interpolate_args);
+            new_pixels[(new_y * new_width) + new_x] = new_pixel;
+          }
+          if (levels != nullptr) {
+            levels->applyRow(samples.subspan(new_y * new_width * image::CHANNELS,
+                                             new_width * image::CHANNELS));
+          }
+        }
+      });
+    }
 
-    for (unsigned long new_y = 0; new_y < new_height; new_y++) {
-      for (unsigned long new_x = 0; new_x < new_width; new_x++) {
-        float const x_original = static_cast<float>(new_x) * x_ratio;
-        float const y_original = static_cast<float>(new_y) * y_ratio;
+    std::span<Pixel const> pixelRow(std::span<unsigned short const> samples) {
+      return {reinterpret_cast<Pixel const *>(samples.data()),  // NOLINT
+              samples.size() / image::CHANNELS};
+    }
 
-        auto const interpolate_args             = InterpolateArgs(x_original, y_original);
-        Pixel const new_pixel                   = interpolate2(interpolate_args);
-        new_pixels[(new_y * new_width) + new_x] = new_pixel;
-      }
+    // Canales entrelazados de origen y destino para el motor de remuestreo común
+    image::ChannelPlanes interleavedPlanes(std::span<unsigned short const> source,
+                                           std::vector<Pixel> & target_pixels) {
+      std::span<unsigned short> const target(
+          reinterpret_cast<unsigned short *>(target_pixels.data()),  // NOLINT
+          target_pixels.size() * image::CHANNELS);
+      return {.source = {source, source.subspan(1), source.subspan(2)},
+              .target = {target, target.subspan(1), target.subspan(2)},
+              .stride = image::CHANNELS};
     }
 
+    image::ResampleGeometry resampleGeometry(Image const & image, unsigned long new_width,
+                                             unsigned long new_height) {
+      return {.sourceWidth  = image.getWidth(),
+              .sourceHeight = image.getHeight(),
+              .targetWidth  = new_width,
+              .targetHeight = new_height};
+    }
+  }  // namespace
+
+  Pixel Image::interpolate2(InterpolateArgs const & interpolate_args) const {
+    std::span<Pixel const> const pixels(pixels_);
+    auto const row = [this, pixels](float const y_pos) {
+      return pixels.subspan(static_cast<unsigned long>(y_pos) * getWidth(), getWidth());
+    };
+    return interpolateRows(row(std::floor(interpolate_args.y)), row(std::ceil(interpolate_args.y)),
+                           interpolate_args);
+  }
+
+  void Image::resize(unsigned long const new_width, unsigned long const new_height) {
+    resizePixels(*this, new_width, new_height, nullptr, spare_);
+    std::swap(pixels_, spare_);
+    if (!recycleBuffers_) { spare_ = std::vector<Pixel>(); }
+    setWidth(new_width);
+    setHeight(new_height);
+  }
+
+  void Image::resize(unsigned long const new_width, unsigned long const new_height,
+                     image::LevelTable const & levels, unsigned short const newMaxColorValue) {
+    resizePixels(*this, new_width, new_height, &levels, spare_);
+    std::swap(pixels_, spare_);
+    if (!recycleBuffers_) { spare_ = std::vector<Pixel>(); }
+    setWidth(new_width);
+    setHeight(new_height);
+    setMaxColorValue(newMaxColorValue);
+  }
+
+  void Image::resizeFixed(unsigned long const new_width, unsigned long const new_height) {
+    std::vector<Pixel> new_pixels(new_width * new_height);
+    image::resizeBilinearFixed(interleavedPlanes(getSamples(), new_pixels),
+                               resampleGeometry(*this, new_width, new_height));
+    setWidth(new_width);
+    setHeight(new_height);
+    pixels_ = std::move(new_pixels);
+  }
+
+  void Image::resample(unsigned long const new_width, unsigned long const new_height,
+                       image::ResampleFilter const filter) {
+    std::vector<Pixel> new_pixels(new_width * new_height);
+    image::resample(interleavedPlanes(getSamples(), new_pixels),
+                    resampleGeometry(*this, new_width, new_height), filter, getMaxColorValue());
     setWidth(new_width);
     setHeight(new_height);
-    pixels_ = new_pixels;
+    pixels_ = std::move(new_pixels);
+  }
+
+  bool resizeStream(std::string const & inputPath, std::string const & outputPath,
+                    unsigned long const new_width, unsigned long const new_height,
+                    std::size_t const memoryLimit) {
+    image::RowReader reader;
+    if (!reader.open(inputPath)) { return false; }
+    ResizeRatios const ratios = resizeRatios(reader.header(), new_width, new_height);
+    auto const sourceY        = [&ratios](std::size_t const new_y) {
+      return std::min(static_cast<float>(new_y) * ratios.y_ratio, ratios.y_max);
+    };
+
+    image::RowResize resize{
+      .width      = new_width,
+      .height     = new_height,
+      .layout     = image::RowLayout::Interleaved,
+      .sourceRows = std::vector<image::SourceRows>(new_height),
+      .kernel     = [&ratios, &sourceY, new_width](std::size_t const new_y,
+                                                   std::span<unsigned short const> low,
+                                                   std::span<unsigned short const> high,
+                                                   std::span<unsigned short> out) {
+        float const y_original = sourceY(new_y);
+        std::span<Pixel> const target(reinterpret_cast<Pixel *>(out.data()),  // NOLINT
+                                      new_width);
+        for (unsigned long new_x = 0; new_x < new_width; new_x++) {
+          float const x_original =
+              std::min(static_cast<float>(new_x) * ratios.x_ratio, ratios.x_max);
+          target[new_x] = interpolateRows(pixelRow(low), pixelRow(high),
+                                          InterpolateArgs(x_original, y_original));
+        }
+      }};
+    for (std::size_t new_y = 0; new_y < new_height; ++new_y) {
+      float const y_original   = sourceY(new_y);
+      resize.sourceRows[new_y] = {.low  = static_cast<std::size_t>(std::floor(y_original)),
+                                  .high = static_cast<std::size_t>(std::ceil(y_original))};
+    }
+    return image::streamResize(reader, outputPath, resize, memoryLimit);
   }
-}  // namespace imageaos
\ No newline at end of file
+}  // namespace imageaos
@@ -1,32 +1,36 @@
 #include <algorithm>
 #include <cmath>
+#include <common/colorsearch.hpp>
+#include <common/histogram.hpp>
 #include <common/image.hpp>
+#include <common/labelmap.hpp>
+#include <common/replacement.hpp>
 #include <imgsoa/imagesoa.hpp>
 
 namespace imagesoa {
-  // Cuenta la frecuencia de cada color en la imagen
-  std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int>
+  // Cuenta la frecuencia de cada color en la imagen, recorriendo los tres planos a la vez
+  std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
       imagesoa::Image::countColorFrequencies() const {
-    std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> colorFrequency;
-    for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        auto color = std::make_tuple(getRed(xPos, yPos), getGreen(xPos, yPos), getBlue(xPos, yPos));
-        colorFrequency[color]++;
-      }
-    }
+    return image::unpackFrequencies(image::countColors(getChannels(), getMaxColorValue()));
+  }
+
+  // Ordena los colores por frecuencia, de menor a mayor; a igual frecuencia, por color
+  std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
+      Image::sortColorsByFrequency(
+          std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> colorFrequency) {
+    std::ranges::sort(colorFrequency, [](auto const & colorFreq1, auto const & colorFreq2) {
+      return std::tie(colorFreq1.second, colorFreq1.first) <
+             std::tie(colorFreq2.second, colorFreq2.first);
+    });
     return colorFrequency;
   }
 
-  // Ordena los colores por frecuencia, de menor a mayor
   std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
       Image::sortColorsByFrequency(
           std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> const & colorFrequency) {
-    std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> colorFreqVector(
-        colorFrequency.begin(), colorFrequency.end());
-    std::ranges::sort(colorFreqVector, [](auto const & colorFreq1, auto const & colorFreq2) {
-      return colorFreq1.second < colorFreq2.second;
-    });
-    return colorFreqVector;
+    return sortColorsByFrequency(
+        std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>(
+            colorFrequency.begin(), colorFrequency.end()));
   }
 
   // Divide los colores en dos grupos: los menos frecuentes para eliminar y el resto para conservar
@@ -53,16 +57,19 @@ namespace imagesoa {
   std::tuple<uint16_t, uint16_t, uint16_t> Image::findClosestColor(
       std::tuple<uint16_t, uint16_t, uint16_t> const & colorToRemove,
       std::vector<std::tuple<uint16_t, uint16_t, uint16_t>> const & remainingColors) {
-    auto [r1, g1, b1]      = colorToRemove;
-    int minDistanceSquared = std::numeric_limits<int>::max();
+    auto [r1, g1, b1]               = colorToRemove;
+    std::int64_t minDistanceSquared = std::numeric_limits<std::int64_t>::max();
     std::tuple<uint16_t, uint16_t, uint16_t> closestColor;
 
     for (auto const & color : remainingColors) {
       auto [r2, g2, b2] = color;
       // Calculamos la distancia euclidiana al cuadrado, sin la raíz cuadrada para optimizar
-      int const distanceSquared = ((static_cast<int>(r1) - r2) * (static_cast<int>(r1) - r2)) +
-                                  ((static_cast<int>(g1) - g2) * (static_cast<int>(g1) - g2)) +
-                                  ((static_cast<int>(b1) - b2) * (static_cast<int>(b1) - b2));
+      std::int64_t const deltaRed   = static_cast<std::int64_t>(r1) - r2;
+      std::int64_t const deltaGreen = static_cast<std::int64_t>(g1) - g2;
+      std::int64_t const deltaBlue  = static_cast<std::int64_t>(b1) - b2;
+
+      std::int64_t const distanceSquared =
+          (deltaRed * deltaRed) + (deltaGreen * deltaGreen) + (deltaBlue * deltaBlue);
 
       if (distanceSquared < minDistanceSquared) {
         minDistanceSquared = distanceSquared;
@@ -82,37 +89,46 @@ namespace imagesoa {
     auto const & colorsToRemove  = colors.first;
     auto const & remainingColors = colors.second;
 
-    for (auto const & colorToRemove : colorsToRemove) {
-      replacementMap[colorToRemove] = findClosestColor(colorToRemove, remainingColors);
+    // Misma elección que findClosestColor, pero con un árbol k-d y las búsquedas en paralelo
+    auto const replacements = image::nearestColors(remainingColors, colorsToRemove);
+    for (std::size_t i = 0; i < colorsToRemove.size(); ++i) {
+      replacementMap[colorsToRemove[i]] = replacements[i];
     }
     return replacementMap;
   }
 
-  // Reemplaza los colores menos frecuentes en la imagen utilizando el mapa de reemplazo
+  // Reemplaza los colores menos frecuentes en la imagen utilizando el mapa de reemplazo, pasado a
+  // una tabla plana que se aplica a los tres planos en paralelo
   void Image::replaceColors(
       std::map<std::tuple<uint16_t, uint16_t, uint16_t>,
                std::tuple<uint16_t, uint16_t, uint16_t>> const & replacementMap) {
-    for (unsigned long y_pos = 0; y_pos < getHeight(); ++y_pos) {
-      for (unsigned long x_pos = 0; x_pos < getWidth(); ++x_pos) {
-        auto color =
-            std::make_tuple(getRed(x_pos, y_pos), getGreen(x_pos, y_pos), getBlue(x_pos, y_pos));
-        if (replacementMap.contains(color)) {
-          auto [newRed, newGreen, newBlue] = replacementMap.at(color);
-          setRed(x_pos, y_pos, newRed);
-          setGreen(x_pos, y_pos, newGreen);
-          setBlue(x_pos, y_pos, newBlue);
-        }
-      }
-    }
+    image::replacementTable(replacementMap).apply(getWritableChannels());
   }
 
-  // Realiza el proceso completo de eliminación de colores menos frecuentes y reemplazo en la imagen
+  // Realiza el proceso completo de eliminación de colores menos frecuentes y reemplazo en la imagen.
+  // Elimina los mismos colores que sortColorsByFrequency y splitColors, pero sin ordenar el
+  // histograma
   void Image::cutfreq(uint32_t n) {
-    auto colorFrequency                    = countColorFrequencies();
-    auto sortedColors                      = sortColorsByFrequency(colorFrequency);
-    auto [colorsToRemove, remainingColors] = splitColors(sortedColors, n);
-    auto replacementMap = buildReplacementMap(std::make_pair(colorsToRemove, remainingColors));
+    auto const colors = image::splitLeastFrequent(
+        image::countColors(getChannels(), getMaxColorValue()), n);
+    replaceColors(buildReplacementMap(colors));
+  }
+
+  // cutfreq a partir de las etiquetas de labelColors: el histograma sale de sus contadores y la
+  // sustitución se resuelve una vez por etiqueta
+  void Image::cutfreq(std::uint32_t n, image::ColorLabels const & labels) {
+    auto const colors = image::splitLeastFrequent(image::labeledHistogram(labels), n);
+    image::replaceLabeledColors(getWritableChannels(), labels,
+                                image::replacementTable(buildReplacementMap(colors)));
+  }
 
-    replaceColors(replacementMap);
+  // Los sustitutos solo se buscan en las celdas vecinas de una rejilla RGB y se aplican sin pasar
+  // por el mapa ordenado de buildReplacementMap
+  std::int64_t Image::cutfreqApproximate(uint32_t n) {
+    auto const [colorsToRemove, remainingColors] = image::splitLeastFrequent(
+        image::countColors(getChannels(), getMaxColorValue()), n);
+    auto const replacements = image::approximateNearestColors(remainingColors, colorsToRemove);
+    image::replacementTable(colorsToRemove, replacements.colors).apply(getWritableChannels());
+    return replacements.maxError;
   }
 }
\ No newline at end of file
@@ -1,43 +1,65 @@
 #include <common/image.hpp>
+#include <common/pixelio.hpp>
 #include <fstream>
 #include <imgsoa/imagesoa.hpp>
 #include <iostream>
+#include <span>
+#include <utility>
 
 namespace imagesoa {
-  bool Image::readPixelData(std::ifstream & file) {
+  bool Image::readPixelData(image::PixelSource & source) {
+    // Tras un resize, los planos con más capacidad pueden ser los de reserva
+    if (spare_[0].capacity() > red_.capacity()) {
+      std::swap(red_, spare_[0]);
+      std::swap(green_, spare_[1]);
+      std::swap(blue_, spare_[2]);
+    }
     red_.resize(getWidth() * getHeight());
     green_.resize(getWidth() * getHeight());
     blue_.resize(getWidth() * getHeight());
 
-    unsigned char const scaleFactor = getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT ? 2 : 1;
+    std::size_t const sampleBytes = image::bytesPerSample(getMaxColorValue());
+    std::size_t const rowBytes    = getWidth() * image::CHANNELS * sampleBytes;
 
     for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        unsigned long const index = (yPos * getWidth()) + xPos;
-
-        unsigned short const red =
-            scaleFactor == 2 ? static_cast<unsigned short>(file.get() << BYTE_SHIFT | file.get())
-                             : static_cast<unsigned short>(file.get());
-        unsigned short const green =
-            scaleFactor == 2 ? static_cast<unsigned short>(file.get() << BYTE_SHIFT | file.get())
-                             : static_cast<unsigned short>(file.get());
-        unsigned short const blue =
-            scaleFactor == 2 ? static_cast<unsigned short>(file.get() << BYTE_SHIFT | file.get())
-                             : static_cast<unsigned short>(file.get());
-
-        if (file.eof()) {
-          std::cerr << "Unexpected end of file while reading pixel data.\n";
-          return false;
-        }
-
-        red_[index]   = red;
-        green_[index] = green;
-        blue_[index]  = blue;
+      std::span<unsigned char const> const row = source.next(rowBytes);
+      if (row.size() != rowBytes) {
+        std::cerr << "Unexpected end of file while reading pixel data.\n";
+        return false;
       }
+
+      // Desentrelaza la fila directamente sobre los tres planos
+      std::span<unsigned short> const redRow   = std::span(red_).subspan(yPos * getWidth());
+      std::span<unsigned short> const greenRow = std::span(green_).subspan(yPos * getWidth());
+      std::span<unsigned short> const blueRow  = std::span(blue_).subspan(yPos * getWidth());
+      image::decodeRow(row, sampleBytes,
+                       [redRow, greenRow, blueRow](std::size_t const xPos, unsigned short const red,
+                                                   unsigned short const green,
+                                                   unsigned short const blue) {
+                         redRow[xPos]   = red;
+                         greenRow[xPos] = green;
+                         blueRow[xPos]  = blue;
+                       });
     }
     return true;
   }
 
+  void Image::trimBuffers(std::size_t const maxBytes) {
+    auto const bytes = [](std::vector<unsigned short> const & plane) {
+      return plane.capacity() * sizeof(unsigned short);
+    };
+    std::size_t const imageBytes = bytes(red_) + bytes(green_) + bytes(blue_);
+    std::size_t const spareBytes = bytes(spare_[0]) + bytes(spare_[1]) + bytes(spare_[2]);
+    if (imageBytes + spareBytes <= maxBytes) { return; }
+    spare_ = {};
+    if (imageBytes <= maxBytes) { return; }
+    red_   = std::vector<unsigned short>();
+    green_ = std::vector<unsigned short>();
+    blue_  = std::vector<unsigned short>();
+    setWidth(0);
+    setHeight(0);
+  }
+
   bool Image::loadFromFile(std::string const & filePath) {
     std::ifstream file(filePath, std::ios::binary);
     if (!file.is_open()) {
@@ -50,34 +72,23 @@ namespace imagesoa {
       return false;
     }
 
-    bool const pixelDataRead = readPixelData(file);
-    file.close();
-
-    return pixelDataRead;
+    image::PixelSource source(file, filePath);
+    return readPixelData(source);
   }
 
   bool Image::writePixelData(std::ofstream & file) const {
-    unsigned char const scaleFactor = getMaxColorValue() > image::MAX_COLOR_VALUE_8BIT ? 2 : 1;
-
-    for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        unsigned long const index = (yPos * getWidth()) + xPos;
-
-        if (scaleFactor == 2) {
-          file.put(static_cast<char>(red_[index] >> BYTE_SHIFT));
-          file.put(static_cast<char>(red_[index] & BYTE_MASK));
-          file.put(static_cast<char>(green_[index] >> BYTE_SHIFT));
-          file.put(static_cast<char>(green_[index] & BYTE_MASK));
-          file.put(static_cast<char>(blue_[index] >> BYTE_SHIFT));
-          file.put(static_cast<char>(blue_[index] & BYTE_MASK));
-        } else {
-          file.put(static_cast<char>(red_[index]));
-          file.put(static_cast<char>(green_[index]));
-          file.put(static_cast<char>(blue_[index]));
-        }
-      }
-    }
-    return file.good();
+    std::size_t const sampleBytes = image::bytesPerSample(getMaxColorValue());
+    std::size_t const rowBytes    = getWidth() * image::CHANNELS * sampleBytes;
+
+    return image::writeRows(
+        file, rowBytes, getHeight(),
+        [this, sampleBytes](std::size_t const yPos, std::span<unsigned char> const out) {
+          std::size_t const offset = yPos * getWidth();
+          image::encodePlanes({.red   = std::span(red_).subspan(offset, getWidth()),
+                               .green = std::span(green_).subspan(offset, getWidth()),
+                               .blue  = std::span(blue_).subspan(offset, getWidth())},
+                              sampleBytes, out);
+        });
   }
 
   bool Image::saveToFile(std::string const & filePath) const {
@@ -97,4 +108,14 @@ namespace imagesoa {
 
     return pixelDataWritten;
   }
+
+  image::PixelChannels Image::getChannels() const {
+    return {.channels = {std::span<unsigned short const>(red_), green_, blue_},
+            .stride   = 1,
+            .count    = red_.size()};
+  }
+
+  image::WritablePixelChannels Image::getWritableChannels() {
+    return {.channels = {red_, green_, blue_}, .stride = 1, .count = red_.size()};
+  }
 }  // namespace imagesoa
@@ -1,10 +1,16 @@
 #pragma once
 
+#include <array>
+#include <common/colorindex.hpp>
 #include <common/image.hpp>
+#include <common/labelmap.hpp>
+#include <common/leveltable.hpp>
+#include <common/pixelio.hpp>
+#include <common/resample.hpp>
+#include <cstddef>
 #include <cstdint>
 #include <map>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace imagesoa {
@@ -46,28 +52,73 @@ namespace imagesoa {
       [[nodiscard]] bool saveToFile(std::string const & filePath) const;
       void displayMetadata() const;
       void modifyMaxLevel(unsigned short newMaxColorValue);
+      // maxlevel con una tabla ya calculada, p. ej. la composición de varios maxlevel
+      void modifyMaxLevel(image::LevelTable const & levels, unsigned short newMaxColorValue);
       void resize(unsigned long new_width, unsigned long new_height);
+      // resize y maxlevel en una sola pasada: cada fila de destino pasa por `levels` en el mismo
+      // bucle que la calcula
+      void resize(unsigned long new_width, unsigned long new_height,
+                  image::LevelTable const & levels, unsigned short newMaxColorValue);
+      // Bilineal en punto fijo, con el mismo redondeo que la versión AOS
+      void resizeFixed(unsigned long new_width, unsigned long new_height);
+      // Remuestreo separable con el filtro indicado
+      void resample(unsigned long new_width, unsigned long new_height,
+                    image::ResampleFilter filter);
       [[nodiscard]] unsigned short calculatePixelColor(InterpolationCoords const & coords,
                                                        char channel) const;
-      [[nodiscard]] bool saveToFileCompress(std::string const & filePath) const;
+      // Cuando el mismo objeto procesa varios ficheros (lotes y servidor), resize conserva los
+      // planos de origen para la siguiente carga o resize. Con una sola imagen no hace falta y
+      // subiría el pico de memoria de la cadena de operaciones.
+      void setRecycleBuffers(bool const recycle) { recycleBuffers_ = recycle; }
+      // Tras un trabajo reciclado: libera los planos de reserva y, si aún no basta, los de la
+      // imagen cuando entre todos reservan más de `maxBytes`. Si libera los de la imagen, esta
+      // queda vacía.
+      void trimBuffers(std::size_t maxBytes);
+      // Carga un fichero C6 o C6v2 expandiendo sus índices con la tabla de colores
+      bool loadFromFileCompress(std::string const & filePath);
+      // Con CompressFormat::BitPacked escribe la variante C6v2 de índices empaquetados
+      [[nodiscard]] bool saveToFileCompress(
+          std::string const & filePath,
+          image::CompressFormat format = image::CompressFormat::ByteAligned) const;
       void cutfreq(uint32_t n);
-
-      bool readPixelData(std::ifstream & file);
+      // Etiqueta de color de cada píxel; las versiones de compress y cutfreq que la reciben no
+      // vuelven a buscar el color de cada píxel
+      [[nodiscard]] image::ColorLabels labelColors() const;
+      [[nodiscard]] bool saveToFileCompress(
+          std::string const & filePath, image::ColorLabels const & labels,
+          image::CompressFormat format = image::CompressFormat::ByteAligned) const;
+      void cutfreq(uint32_t n, image::ColorLabels const & labels);
+      // cutfreq aproximado (ColorGrid); devuelve la cota del error en distancia al cuadrado
+      std::int64_t cutfreqApproximate(uint32_t n);
+
+      // Vista de los tres planos para las operaciones comunes (histograma, etiquetas...)
+      [[nodiscard]] image::PixelChannels getChannels() const;
+      [[nodiscard]] image::WritablePixelChannels getWritableChannels();
+
+      bool readPixelData(image::PixelSource & source);
       bool writePixelData(std::ofstream & file) const;
-      [[nodiscard]] std::unordered_map<image::Pixel, unsigned long> getColorTable() const;
-      bool
-          writeColorTable(std::ofstream & file,
-                          std::unordered_map<image::Pixel, unsigned long> const & colorTable) const;
+      // Índice de cada color por orden de primera aparición, en una tabla plana
+      [[nodiscard]] image::ColorIndexTable getColorTable() const;
+      bool writeColorTable(std::ofstream & file, image::ColorIndexTable const & colorTable) const;
       bool writePixelDataCompress(
-          std::ofstream & file,
-          std::unordered_map<image::Pixel, unsigned long> const & colorTable) const;
+          std::ofstream & file, image::ColorIndexTable const & colorTable,
+          image::CompressFormat format = image::CompressFormat::ByteAligned) const;
 
       std::vector<unsigned short> red_;
       std::vector<unsigned short> green_;
       std::vector<unsigned short> blue_;
-
-      [[nodiscard]] std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int>
+      // Planos de destino de resize, que los intercambia con los de la imagen. Con
+      // recycleBuffers_ conservan la memoria de la imagen anterior para la siguiente carga o
+      // resize; si no, se liberan tras el resize.
+      std::array<std::vector<unsigned short>, image::CHANNELS> spare_;
+      bool recycleBuffers_ = false;
+
+      // Frecuencia de cada color, ordenada por color
+      [[nodiscard]] std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
           countColorFrequencies() const;
+      static std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
+          sortColorsByFrequency(
+              std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>> colorFrequency);
       static std::vector<std::pair<std::tuple<uint16_t, uint16_t, uint16_t>, int>>
           sortColorsByFrequency(
               std::map<std::tuple<uint16_t, uint16_t, uint16_t>, int> const & colorFrequency);
@@ -88,6 +139,12 @@ namespace imagesoa {
                                   std::tuple<uint16_t, uint16_t, uint16_t>> const & replacementMap);
   };
 
+  // resize por bandas de filas, leyendo y escribiendo los ficheros sin cargar la imagen completa;
+  // escribe los mismos píxeles que Image::resize. `memoryLimit` acota los búferes de cada banda.
+  [[nodiscard]] bool resizeStream(std::string const & inputPath, std::string const & outputPath,
+                                  unsigned long new_width, unsigned long new_height,
+                                  std::size_t memoryLimit);
+
   inline unsigned short Image::getRed(unsigned long const xPos, unsigned long const yPos) const {
     return red_[(yPos * getWidth()) + xPos];
   }
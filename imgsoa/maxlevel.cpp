@@ -1,22 +1,18 @@
 #include <common/image.hpp>
+#include <common/leveltable.hpp>
 #include <imgsoa/imagesoa.hpp>
 
 namespace imagesoa {
   void Image::modifyMaxLevel(unsigned short const newMaxColorValue) {
-    // Calcular la proporción una vez
-    float const scale =
-        static_cast<float>(newMaxColorValue) / static_cast<float>(getMaxColorValue());
-
-    for (unsigned long yPos = 0; yPos < getHeight(); ++yPos) {
-      for (unsigned long xPos = 0; xPos < getWidth(); ++xPos) {
-        unsigned long const index = (yPos * getWidth()) + xPos;
+    // La tabla se calcula una vez y se aplica a cada plano por separado
+    modifyMaxLevel(image::LevelTable(getMaxColorValue(), newMaxColorValue), newMaxColorValue);
+  }
 
-        // Aplicar la proporción precomputada
-        red_[index]   = static_cast<unsigned short>(static_cast<float>(red_[index]) * scale);
-        green_[index] = static_cast<unsigned short>(static_cast<float>(green_[index]) * scale);
-        blue_[index]  = static_cast<unsigned short>(static_cast<float>(blue_[index]) * scale);
-      }
-    }
+  void Image::modifyMaxLevel(image::LevelTable const & levels,
+                             unsigned short const newMaxColorValue) {
+    levels.apply(red_);
+    levels.apply(green_);
+    levels.apply(blue_);
 
     // Actualizar el valor máximo de color
     setMaxColorValue(newMaxColorValue);
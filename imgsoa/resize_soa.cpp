@@ -2,8 +2,19 @@
 #include "imagesoa.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <common/cpu.hpp>
+#include <common/leveltable.hpp>
+#include <common/resample.hpp>
+#include <common/rowstream.hpp>
+#include <common/threadpool.hpp>
 #include <cstdint>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <immintrin.h>
+#endif
 
 namespace imagesoa {
   namespace {
@@ -12,17 +23,6 @@ namespace imagesoa {
       return (value1 * (1.0 - weight)) + (value2 * weight);
     }
 
-    InterpolationCoords calculateCoords(double x_real, double y_real) {
-      auto x_l              = static_cast<std::uint32_t>(std::floor(x_real));
-      auto y_l              = static_cast<std::uint32_t>(std::floor(y_real));
-      auto x_h              = static_cast<std::uint32_t>(std::ceil(x_real));
-      auto y_h              = static_cast<std::uint32_t>(std::ceil(y_real));
-      double const x_weight = x_real - x_l;
-      double const y_weight = y_real - y_l;
-      return {
-        .x_l = x_l, .y_l = y_l, .x_h = x_h, .y_h = y_h, .x_weight = x_weight, .y_weight = y_weight};
-    }
-
     struct InterpolationData {
         unsigned short ll, hl, lh, hh;
         double x_weight, y_weight;
@@ -36,6 +36,251 @@ namespace imagesoa {
       return static_cast<unsigned short>(
           std::clamp(std::round(color), 0.0, static_cast<double>(max_value)));
     }
+
+    // Coordenadas de origen (x_l/x_h y peso) de cada columna o fila de destino
+    struct AxisTable {
+        std::vector<std::uint32_t> low;
+        std::vector<std::uint32_t> high;
+        std::vector<double> weight;
+        // Primera posición de destino cuya muestra alta es la última del eje de origen
+        std::size_t firstEdge;
+    };
+
+    AxisTable makeAxisTable(std::size_t const newSize, double const ratio,
+                            std::size_t const sourceSize) {
+      AxisTable table{.low       = std::vector<std::uint32_t>(newSize),
+                      .high      = std::vector<std::uint32_t>(newSize),
+                      .weight    = std::vector<double>(newSize),
+                      .firstEdge = newSize};
+      for (std::size_t i = 0; i < newSize; ++i) {
+        double const real = static_cast<std::uint32_t>(i) * ratio;
+        table.low[i]      = static_cast<std::uint32_t>(std::floor(real));
+        table.high[i]     = static_cast<std::uint32_t>(std::ceil(real));
+        table.weight[i]   = real - table.low[i];
+        if (table.firstEdge == newSize && table.high[i] + 1 >= sourceSize) { table.firstEdge = i; }
+      }
+      return table;
+    }
+
+    struct ResizeTables {
+        AxisTable columns;
+        AxisTable rows;
+    };
+
+    ResizeTables makeResizeTables(image::Image const & source, unsigned long const new_width,
+                                  unsigned long const new_height) {
+      double const x_ratio = (new_width > 1) ? static_cast<double>(source.getWidth() - 1) /
+                                                   static_cast<double>(new_width - 1)
+                                             : 0.0;
+      double const y_ratio = (new_height > 1) ? static_cast<double>(source.getHeight() - 1) /
+                                                    static_cast<double>(new_height - 1)
+                                              : 0.0;
+
+      // Las coordenadas de origen se calculan una sola vez por columna y por fila de destino
+      return {.columns = makeAxisTable(new_width, x_ratio, source.getWidth()),
+              .rows    = makeAxisTable(new_height, y_ratio, source.getHeight())};
+    }
+
+    // Una fila de un plano de destino y las dos filas de origen de las que se interpola
+    struct PlaneRowJob {
+        std::span<unsigned short const> low;
+        std::span<unsigned short const> high;
+        std::span<unsigned short> out;
+        double yWeight;
+        unsigned short maxValue;
+    };
+
+    void resizeRowScalar(PlaneRowJob const & job, AxisTable const & columns, std::size_t first) {
+      for (std::size_t x_prime = first; x_prime < job.out.size(); ++x_prime) {
+        std::uint32_t const x_l = columns.low[x_prime];
+        std::uint32_t const x_h = columns.high[x_prime];
+        job.out[x_prime]        = interpolateColorComponent({.ll       = job.low[x_l],
+                                                             .hl       = job.low[x_h],
+                                                             .lh       = job.high[x_l],
+                                                             .hh       = job.high[x_h],
+                                                             .x_weight = columns.weight[x_prime],
+                                                             .y_weight = job.yWeight},
+                                                            job.maxValue);
+      }
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    constexpr std::size_t AVX2_LANES = 4;
+    constexpr std::size_t AVX2_BLOCK = 16;
+    constexpr int SAMPLE_LOW_BITS    = 0xFFFF;
+    constexpr double ROUNDING_HALF   = 0.5;
+
+    // Lee cuatro muestras de 16 bits con un gather de 32 bits; el llamador garantiza que la
+    // palabra siguiente a cada muestra sigue dentro del plano
+    [[gnu::target("avx2")]] __m256d gatherSamples(std::span<unsigned short const> row,
+                                                  std::span<std::uint32_t const> columns) {
+      __m128i const index =
+          _mm_loadu_si128(reinterpret_cast<__m128i const *>(columns.data()));  // NOLINT
+      __m128i const words =
+          _mm_i32gather_epi32(reinterpret_cast<int const *>(row.data()), index, 2);  // NOLINT
+      return _mm256_cvtepi32_pd(_mm_and_si128(words, _mm_set1_epi32(SAMPLE_LOW_BITS)));
+    }
+
+    // Mismas operaciones y en el mismo orden que Interpolate, para obtener resultados idénticos
+    [[gnu::target("avx2")]] __m256d interpolateLanes(__m256d value1, __m256d value2,
+                                                     __m256d weight) {
+      return _mm256_add_pd(_mm256_mul_pd(value1, _mm256_sub_pd(_mm256_set1_pd(1.0), weight)),
+                           _mm256_mul_pd(value2, weight));
+    }
+
+    // std::round (mitad hacia arriba, los valores nunca son negativos) y recorte a [0, max]
+    [[gnu::target("avx2")]] __m128i roundAndClamp(__m256d color, __m256d maxValue) {
+      __m256d const floor = _mm256_floor_pd(color);
+      __m256d const carry =
+          _mm256_cmp_pd(_mm256_sub_pd(color, floor), _mm256_set1_pd(ROUNDING_HALF), _CMP_GE_OQ);
+      __m256d const rounded = _mm256_add_pd(floor, _mm256_and_pd(carry, _mm256_set1_pd(1.0)));
+      return _mm256_cvttpd_epi32(
+          _mm256_min_pd(_mm256_max_pd(rounded, _mm256_setzero_pd()), maxValue));
+    }
+
+    [[gnu::target("avx2")]] __m128i resizeLanes(PlaneRowJob const & job, AxisTable const & columns,
+                                                std::size_t xPos) {
+      auto const low       = std::span(columns.low).subspan(xPos, AVX2_LANES);
+      auto const high      = std::span(columns.high).subspan(xPos, AVX2_LANES);
+      __m256d const weight = _mm256_loadu_pd(std::span(columns.weight).subspan(xPos).data());
+      __m256d const top    = interpolateLanes(gatherSamples(job.low, low),
+                                              gatherSamples(job.low, high), weight);
+      __m256d const bottom = interpolateLanes(gatherSamples(job.high, low),
+                                              gatherSamples(job.high, high), weight);
+      return roundAndClamp(interpolateLanes(top, bottom, _mm256_set1_pd(job.yWeight)),
+                           _mm256_set1_pd(job.maxValue));
+    }
+
+    // Calcula bloques de 16 píxeles hasta `limit` y devuelve la primera columna pendiente
+    [[gnu::target("avx2")]] std::size_t resizeRowAvx2(PlaneRowJob const & job,
+                                                      AxisTable const & columns,
+                                                      std::size_t limit) {
+      std::size_t xPos = 0;
+      for (; xPos + AVX2_BLOCK <= limit; xPos += AVX2_BLOCK) {
+        for (std::size_t half = 0; half < AVX2_BLOCK; half += 2 * AVX2_LANES) {
+          std::size_t const lane = xPos + half;
+          __m128i const packed   = _mm_packus_epi32(resizeLanes(job, columns, lane),
+                                                    resizeLanes(job, columns, lane + AVX2_LANES));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(job.out.subspan(lane).data()),  // NOLINT
+                           packed);
+        }
+      }
+      return xPos;
+    }
+#endif
+
+    // Filas de origen y de destino de los tres planos para una fila de destino
+    struct RowPlanes {
+        std::array<std::span<unsigned short const>, image::CHANNELS> low;
+        std::array<std::span<unsigned short const>, image::CHANNELS> high;
+        std::array<std::span<unsigned short>, image::CHANNELS> out;
+    };
+
+    void resizeRowPlanes(RowPlanes const & row, ResizeTables const & tables,
+                         std::size_t const y_prime, unsigned short const maxValue) {
+      AxisTable const & columns = tables.columns;
+      AxisTable const & rows    = tables.rows;
+      // En la última fila de origen el gather no puede leer más allá de la última muestra
+      std::size_t const limit = y_prime >= rows.firstEdge ? columns.firstEdge : columns.low.size();
+      for (std::size_t channel = 0; channel < image::CHANNELS; ++channel) {
+        PlaneRowJob const job{.low      = row.low.at(channel),
+                              .high     = row.high.at(channel),
+                              .out      = row.out.at(channel),
+                              .yWeight  = rows.weight[y_prime],
+                              .maxValue = maxValue};
+        std::size_t first = 0;
+#if defined(__x86_64__) || defined(__i386__)
+        if (image::cpuHasAvx2()) { first = resizeRowAvx2(job, columns, limit); }
+#endif
+        resizeRowScalar(job, columns, first);
+      }
+    }
+
+    struct PlaneSet {
+        std::array<std::span<unsigned short const>, image::CHANNELS> sources;
+        std::array<std::vector<unsigned short>, image::CHANNELS> resized;
+        std::size_t sourceWidth;
+        unsigned short maxValue;
+    };
+
+    void resizeRow(PlaneSet & planes, ResizeTables const & tables, std::size_t y_prime) {
+      std::size_t const width     = tables.columns.low.size();
+      std::size_t const sourceRow = planes.sourceWidth;
+      RowPlanes row{};
+      for (std::size_t channel = 0; channel < image::CHANNELS; ++channel) {
+        std::span<unsigned short const> const source = planes.sources.at(channel);
+        std::span<unsigned short> const target       = planes.resized.at(channel);
+        row.low.at(channel)  = source.subspan(tables.rows.low[y_prime] * sourceRow, sourceRow);
+        row.high.at(channel) = source.subspan(tables.rows.high[y_prime] * sourceRow, sourceRow);
+        row.out.at(channel)  = target.subspan(y_prime * width, width);
+      }
+      resizeRowPlanes(row, tables, y_prime, planes.maxValue);
+    }
+
+    // Reparto por filas de destino entre los hilos del pool; cada fila procesa los tres planos y,
+    // con `levels`, los pasa por la tabla antes de seguir con la siguiente fila
+    void resizePlanes(Image & image, unsigned long const new_width,
+                      unsigned long const new_height, image::LevelTable const * levels) {
+      ResizeTables const tables = makeResizeTables(image, new_width, new_height);
+
+      PlaneSet planes{
+        .sources     = {std::span<unsigned short const>(image.red_), image.green_, image.blue_},
+        .resized     = std::move(image.spare_),
+        .sourceWidth = image.getWidth(),
+        .maxValue    = image.getMaxColorValue(),
+      };
+      for (auto & plane : planes.resized) { plane.resize(new_width * new_height); }
+
+      threadpool::parallelFor(0, new_height, [&](std::size_t const first, std::size_t const last) {
+        for (std::size_t y_prime = first; y_prime < last; ++y_prime) {
+          resizeRow(planes, tables, y_prime);
+          if (levels == nullptr) { continue; }
+          for (auto & plane : planes.resized) {
+            levels->applyRow(std::span(plane).subspan(y_prime * new_width, new_width));
+          }
+        }
+      });
+
+      std::swap(image.red_, planes.resized[0]);
+      std::swap(image.green_, planes.resized[1]);
+      std::swap(image.blue_, planes.resized[2]);
+      if (image.recycleBuffers_) { image.spare_ = std::move(planes.resized); }
+      image.setWidth(new_width);
+      image.setHeight(new_height);
+    }
+
+    // Fila de destino del flujo por bandas, con los planos de cada fila uno tras otro
+    void resizeStreamRow(ResizeTables const & tables, std::size_t const sourceWidth,
+                         unsigned short const maxValue, std::size_t const y_prime,
+                         std::span<unsigned short const> low, std::span<unsigned short const> high,
+                         std::span<unsigned short> out) {
+      std::size_t const width = tables.columns.low.size();
+      RowPlanes row{};
+      for (std::size_t channel = 0; channel < image::CHANNELS; ++channel) {
+        row.low.at(channel)  = low.subspan(channel * sourceWidth, sourceWidth);
+        row.high.at(channel) = high.subspan(channel * sourceWidth, sourceWidth);
+        row.out.at(channel)  = out.subspan(channel * width, width);
+      }
+      resizeRowPlanes(row, tables, y_prime, maxValue);
+    }
+
+    // Planos de destino del motor de remuestreo común
+    struct ResampledPlanes {
+        explicit ResampledPlanes(std::size_t const pixels)
+          : red(pixels), green(pixels), blue(pixels) { }
+
+        image::ChannelPlanes planes(std::span<unsigned short const> source_red,
+                                    std::span<unsigned short const> source_green,
+                                    std::span<unsigned short const> source_blue) {
+          return {.source = {source_red, source_green, source_blue},
+                  .target = {red, green, blue},
+                  .stride = 1};
+        }
+
+        std::vector<unsigned short> red;
+        std::vector<unsigned short> green;
+        std::vector<unsigned short> blue;
+    };
   }  // namespace
 
   unsigned short Image::calculatePixelColor(InterpolationCoords const & coords,
@@ -66,34 +311,70 @@ namespace imagesoa {
   }
 
   void Image::resize(unsigned long new_width, unsigned long new_height) {
-    std::vector<unsigned short> new_red(new_width * new_height);
-    std::vector<unsigned short> new_green(new_width * new_height);
-    std::vector<unsigned short> new_blue(new_width * new_height);
-
-    double const x_ratio =
-        (new_width > 1) ? static_cast<double>(getWidth() - 1) / static_cast<double>(new_width - 1)
-                        : 0.0;
-    double const y_ratio = (new_height > 1) ? static_cast<double>(getHeight() - 1) /
-                                                  static_cast<double>(new_height - 1)
-                                            : 0.0;
-
-    for (std::uint32_t y_prime = 0; y_prime < new_height; ++y_prime) {
-      for (std::uint32_t x_prime = 0; x_prime < new_width; ++x_prime) {
-        double const x_real = x_prime * x_ratio;
-        double const y_real = y_prime * y_ratio;
-
-        InterpolationCoords const coords = calculateCoords(x_real, y_real);
-
-        new_red[(y_prime * new_width) + x_prime]   = calculatePixelColor(coords, 'r');
-        new_green[(y_prime * new_width) + x_prime] = calculatePixelColor(coords, 'g');
-        new_blue[(y_prime * new_width) + x_prime]  = calculatePixelColor(coords, 'b');
-      }
-    }
+    resizePlanes(*this, new_width, new_height, nullptr);
+  }
+
+  void Image::resize(unsigned long new_width, unsigned long new_height,
+                     image::LevelTable const & levels, unsigned short newMaxColorValue) {
+    resizePlanes(*this, new_width, new_height, &levels);
+    setMaxColorValue(newMaxColorValue);
+  }
 
-    red_   = std::move(new_red);
-    green_ = std::move(new_green);
-    blue_  = std::move(new_blue);
+  void Image::resizeFixed(unsigned long new_width, unsigned long new_height) {
+    ResampledPlanes resized(new_width * new_height);
+    image::resizeBilinearFixed(resized.planes(red_, green_, blue_),
+                               {.sourceWidth  = getWidth(),
+                                .sourceHeight = getHeight(),
+                                .targetWidth  = new_width,
+                                .targetHeight = new_height});
+    red_   = std::move(resized.red);
+    green_ = std::move(resized.green);
+    blue_  = std::move(resized.blue);
     setWidth(new_width);
     setHeight(new_height);
   }
+
+  void Image::resample(unsigned long new_width, unsigned long new_height,
+                       image::ResampleFilter filter) {
+    ResampledPlanes resized(new_width * new_height);
+    image::resample(resized.planes(red_, green_, blue_),
+                    {.sourceWidth  = getWidth(),
+                     .sourceHeight = getHeight(),
+                     .targetWidth  = new_width,
+                     .targetHeight = new_height},
+                    filter, getMaxColorValue());
+    red_   = std::move(resized.red);
+    green_ = std::move(resized.green);
+    blue_  = std::move(resized.blue);
+    setWidth(new_width);
+    setHeight(new_height);
+  }
+
+  bool resizeStream(std::string const & inputPath, std::string const & outputPath,
+                    unsigned long const new_width, unsigned long const new_height,
+                    std::size_t const memoryLimit) {
+    image::RowReader reader;
+    if (!reader.open(inputPath)) { return false; }
+    image::Image const & source   = reader.header();
+    ResizeTables const tables     = makeResizeTables(source, new_width, new_height);
+    std::size_t const sourceWidth = source.getWidth();
+    unsigned short const maxValue = source.getMaxColorValue();
+
+    image::RowResize resize{
+      .width      = new_width,
+      .height     = new_height,
+      .layout     = image::RowLayout::Planar,
+      .sourceRows = std::vector<image::SourceRows>(new_height),
+      .kernel     = [&tables, sourceWidth, maxValue](std::size_t const y_prime,
+                                                 std::span<unsigned short const> low,
+                                                 std::span<unsigned short const> high,
+                                                 std::span<unsigned short> out) {
+        resizeStreamRow(tables, sourceWidth, maxValue, y_prime, low, high, out);
+      }};
+    for (std::size_t y_prime = 0; y_prime < new_height; ++y_prime) {
+      resize.sourceRows[y_prime] = {.low  = tables.rows.low[y_prime],
+                                    .high = tables.rows.high[y_prime]};
+    }
+    return image::streamResize(reader, outputPath, resize, memoryLimit);
+  }
 }  // namespace imagesoa
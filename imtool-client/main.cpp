@@ -0,0 +1,50 @@
+#include <common/server.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Cliente de pruebas de --serve. Con argumentos envía un único trabajo; sin ellos, cada línea de
+// la entrada estándar (un manifiesto de --batch, por ejemplo). Imprime cada respuesta y termina
+// con error si alguna no es "ok".
+//   imtool-client <socket> [entrada salida operación args...]
+//   imtool-client <socket> shutdown
+int main(int const argc, char * argv[]) {
+  std::vector<std::string> const args(argv, argv + argc);
+  if (args.size() < 2) {
+    std::cerr << "Usage: imtool-client <socket> [input output operation args...]\n";
+    return -1;
+  }
+
+  server::FileDescriptor const connection = server::connectUnixSocket(args[1]);
+  if (!connection.isValid()) {
+    std::cerr << "Failed to connect to socket: " << args[1] << '\n';
+    return -1;
+  }
+
+  std::vector<std::string> jobs;
+  if (args.size() > 2) {
+    std::string job = args[2];
+    for (std::size_t arg = 3; arg < args.size(); ++arg) { job += ' ' + args[arg]; }
+    jobs.push_back(job);
+  } else {
+    for (std::string line; std::getline(std::cin, line);) {
+      if (line.find_first_not_of(" \t\r") != std::string::npos && !line.starts_with('#')) {
+        jobs.push_back(line);
+      }
+    }
+  }
+
+  server::LineReader replies(connection.get());
+  bool allOk = true;
+  for (std::string const & job : jobs) {
+    std::string reply;
+    if (!server::writeLine(connection.get(), server::withAbsolutePaths(job)) ||
+        !replies.next(reply)) {
+      std::cerr << "Connection closed by server\n";
+      return -1;
+    }
+    std::cout << reply << '\n';
+    allOk = allOk && reply.starts_with("ok");
+  }
+  return allOk ? 0 : -1;
+}
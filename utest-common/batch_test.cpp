@@ -0,0 +1,90 @@
+#include <common/batch.hpp>
+#include <common/progargs.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+  std::vector<image::BatchJob> readJobs(std::string const & text) {
+    std::istringstream manifest(text);
+    return image::readManifest(manifest);
+  }
+}  // namespace
+
+// T1-Cada línea es un trabajo con la sintaxis de la línea de órdenes; las vacías y los
+// comentarios se ignoran y las no válidas conservan su número de línea y su error
+TEST(BatchTest, ReadsManifestLines) {
+  auto const jobs = readJobs("# miniaturas\n"
+                             "a.ppm a_small.ppm resize 64 64 + maxlevel 255\n"
+                             "\n"
+                             "  b.ppm b.cppm compress --packed\n"
+                             "c.ppm c_out.ppm maxlevel abc\n"
+                             "d.ppm d_out.ppm info\n"
+                             "e.ppm e_out.ppm maxlevel 100 --threads 2\n");
+  ASSERT_EQ(jobs.size(), 5U);
+
+  EXPECT_EQ(jobs[0].line, 2U);
+  EXPECT_TRUE(jobs[0].error.empty());
+  EXPECT_EQ(jobs[0].args.operation, progargs::Resize);
+  EXPECT_EQ(jobs[0].args.nextStages.size(), 1U);
+
+  EXPECT_EQ(jobs[1].line, 4U);
+  EXPECT_TRUE(jobs[1].error.empty());
+  EXPECT_EQ(jobs[1].args.inputFilePath, "b.ppm");
+  EXPECT_TRUE(jobs[1].args.options.packed);
+
+  EXPECT_EQ(jobs[2].line, 5U);
+  EXPECT_EQ(jobs[2].error, "Invalid maxlevel: abc");
+  EXPECT_FALSE(jobs[3].error.empty());
+  EXPECT_FALSE(jobs[4].error.empty());
+}
+
+// T2-Todos los trabajos válidos se ejecutan una vez; los fallidos y los no válidos cuentan como
+// fallos en el resumen
+TEST(BatchTest, RunsEveryValidJobOnce) {
+  std::string text;
+  for (int job = 0; job < 40; ++job) {
+    text += "in" + std::to_string(job) + ".ppm out" + std::to_string(job) + ".ppm maxlevel 255\n";
+  }
+  text += "bad.ppm bad_out.ppm resize 0 10\n";
+  auto const jobs = readJobs(text);
+
+  std::mutex mutex;
+  std::multiset<std::string> ran;
+  std::ostringstream out;
+  image::BatchSummary const summary =
+      image::runBatch(jobs, [&](progargs::ParsedOperationArgs const & args) {
+        std::scoped_lock const lock(mutex);
+        ran.insert(args.inputFilePath);
+        return args.inputFilePath != "in7.ppm";
+      }, out);
+
+  EXPECT_EQ(ran.size(), 40U);
+  EXPECT_EQ(std::set<std::string>(ran.begin(), ran.end()).size(), 40U);
+  EXPECT_EQ(summary.succeeded, 39U);
+  EXPECT_EQ(summary.failed, 2U);
+  EXPECT_NE(out.str().find("Batch: 39 ok, 2 failed"), std::string::npos);
+  EXPECT_NE(out.str().find("invalid line 41"), std::string::npos);
+}
+
+// T3-Un fichero que escribe un trabajo no puede ser la salida ni la entrada de otro, aunque la
+// ruta se escriba de otra forma; sí la entrada del mismo trabajo
+TEST(BatchTest, RejectsOverlappingPaths) {
+  auto const jobs = readJobs("a.ppm out/a.ppm maxlevel 100\n"
+                             "b.ppm out/../out/a.ppm maxlevel 100\n"
+                             "out/a.ppm c.ppm maxlevel 100\n"
+                             "d.ppm d.ppm maxlevel 100\n"
+                             "e.ppm ./e.cppm compress\n"
+                             "e.cppm e_out.ppm decompress\n");
+  ASSERT_EQ(jobs.size(), 6U);
+  EXPECT_TRUE(jobs[0].error.empty());
+  EXPECT_EQ(jobs[1].error, "Output already written by line 1");
+  EXPECT_EQ(jobs[2].error, "Input is written by line 1");
+  EXPECT_TRUE(jobs[3].error.empty());
+  EXPECT_TRUE(jobs[4].error.empty());
+  EXPECT_EQ(jobs[5].error, "Input is written by line 5");
+}
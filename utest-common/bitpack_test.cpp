@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <common/bitpack.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <span>
+#include <vector>
+
+namespace {
+  std::vector<std::uint32_t> makeIndices(std::size_t const count, unsigned const bits) {
+    std::uint64_t const limit = std::uint64_t{1} << bits;
+    std::vector<std::uint32_t> indices(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      indices[i] = static_cast<std::uint32_t>((i * i * 2654435761U + i) % limit);
+    }
+    return indices;
+  }
+
+  std::vector<char> pack(std::vector<std::uint32_t> const & indices, unsigned const bits) {
+    return image::packIndices(indices.size(), bits,
+                              [&](std::size_t const first, std::span<std::uint32_t> block) {
+                                std::copy_n(indices.begin() + static_cast<std::ptrdiff_t>(first),
+                                            block.size(), block.begin());
+                              });
+  }
+
+  // Índice `index` leído bit a bit del flujo little endian
+  std::uint32_t readBits(std::vector<char> const & packed, std::size_t const index,
+                         unsigned const bits) {
+    std::uint32_t value = 0;
+    for (unsigned bit = 0; bit < bits; ++bit) {
+      std::size_t const position = (index * bits) + bit;
+      auto const byte            = static_cast<unsigned char>(packed[position / 8]);
+      value |= static_cast<std::uint32_t>((byte >> (position % 8)) & 1U) << bit;
+    }
+    return value;
+  }
+}  // namespace
+
+// T1-Los bits por índice son ceil(log2(colores))
+TEST(BitPackTest, IndexBitWidth) {
+  EXPECT_EQ(image::indexBitWidth(1), 0U);
+  EXPECT_EQ(image::indexBitWidth(2), 1U);
+  EXPECT_EQ(image::indexBitWidth(256), 8U);
+  EXPECT_EQ(image::indexBitWidth(257), 9U);
+  EXPECT_EQ(image::indexBitWidth(300), 9U);
+  EXPECT_EQ(image::indexBitWidth(std::size_t{1} << 32), 32U);
+}
+
+// T2-Cada índice ocupa exactamente sus bits en orden little endian y se recupera al desempaquetar
+TEST(BitPackTest, RoundTripEveryWidth) {
+  constexpr std::size_t count = 40013;
+  for (unsigned bits = 0; bits <= 32; ++bits) {
+    std::vector<std::uint32_t> const indices = makeIndices(count, bits);
+    std::vector<char> const packed           = pack(indices, bits);
+    ASSERT_EQ(packed.size(), image::packedByteSize(count, bits));
+    for (std::size_t i = 0; i < count; i += 997) {
+      ASSERT_EQ(readBits(packed, i, bits), indices[i]) << bits << " bits, index " << i;
+    }
+
+    std::vector<std::uint32_t> unpacked(count);
+    image::unpackIndices(packed, bits, unpacked);
+    EXPECT_EQ(unpacked, indices) << bits << " bits";
+  }
+}
+
+// T3-El flujo no depende del número de hilos
+TEST(BitPackTest, IndependentOfThreadCount) {
+  std::vector<std::uint32_t> const indices = makeIndices(100003, 9);
+  threadpool::setThreadCount(1);
+  std::vector<char> const serial = pack(indices, 9);
+  threadpool::setThreadCount(8);
+  std::vector<char> const parallel = pack(indices, 9);
+  threadpool::setThreadCount(0);
+  EXPECT_EQ(parallel, serial);
+}
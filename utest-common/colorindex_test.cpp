@@ -0,0 +1,90 @@
+#include <common/colorindex.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+  struct TestPlanes {
+      std::vector<unsigned short> red;
+      std::vector<unsigned short> green;
+      std::vector<unsigned short> blue;
+
+      [[nodiscard]] image::PixelChannels channels() const {
+        return {.channels = {std::span<unsigned short const>(red), green, blue},
+                .stride   = 1,
+                .count    = red.size()};
+      }
+
+      [[nodiscard]] image::PackedColor at(std::size_t const pixel) const {
+        return image::packColor(red[pixel], green[pixel], blue[pixel]);
+      }
+  };
+
+  TestPlanes makePlanes(std::size_t const pixels, unsigned const modulus) {
+    TestPlanes planes{.red   = std::vector<unsigned short>(pixels),
+                      .green = std::vector<unsigned short>(pixels),
+                      .blue  = std::vector<unsigned short>(pixels)};
+    for (std::size_t i = 0; i < pixels; ++i) {
+      std::size_t const seed = (i * i * 2654435761U) % 8191;
+      planes.red[i]          = static_cast<unsigned short>((seed * 7) % modulus);
+      planes.green[i]        = static_cast<unsigned short>((seed * 13) % modulus);
+      planes.blue[i]         = static_cast<unsigned short>((seed * 31) % modulus);
+    }
+    return planes;
+  }
+
+  // Comprueba que los índices siguen el orden de primera aparición de cada color
+  void expectFirstOccurrence(TestPlanes const & planes, unsigned short const maxColorValue) {
+    image::ColorIndexTable const table(planes.channels(), maxColorValue);
+    std::map<image::PackedColor, std::uint32_t> reference;
+    for (std::size_t i = 0; i < planes.red.size(); ++i) {
+      auto const [found, added] =
+          reference.try_emplace(planes.at(i), static_cast<std::uint32_t>(reference.size()));
+      ASSERT_EQ(table.indexAt(planes.channels(), i), found->second) << "pixel " << i;
+    }
+    ASSERT_EQ(table.size(), reference.size());
+    for (auto const & [color, index] : reference) { EXPECT_EQ(table.colors()[index], color); }
+  }
+}  // namespace
+
+// T1-Con la tabla hash los índices siguen el orden de primera aparición
+TEST(ColorIndexTest, HashedFollowsFirstOccurrence) {
+  expectFirstOccurrence(makePlanes(100003, 65536), 65535);
+}
+
+// T2-Con el array directo de 8 bits los índices siguen el orden de primera aparición
+TEST(ColorIndexTest, DirectFollowsFirstOccurrence) {
+  expectFirstOccurrence(makePlanes(std::size_t{1} << 20, 256), 255);
+}
+
+// T3-Si una muestra no cabe en 8 bits se usa la tabla hash aunque maxval sea 255
+TEST(ColorIndexTest, DirectFallsBackToHashed) {
+  TestPlanes planes = makePlanes(std::size_t{1} << 20, 256);
+  planes.blue.back() = 256;
+  expectFirstOccurrence(planes, 255);
+}
+
+// T4-La estimación de colores distintos queda entre los colores vistos y el número de píxeles
+TEST(ColorIndexTest, EstimateWithinBounds) {
+  TestPlanes const few = makePlanes(500000, 4);
+  EXPECT_LE(image::estimateUniqueColors(few.channels()), 64U);
+  TestPlanes const many = makePlanes(500000, 65536);
+  image::ColorIndexTable const table(many.channels(), 65535);
+  std::size_t const estimate = image::estimateUniqueColors(many.channels());
+  EXPECT_GE(estimate, table.size() / 2);
+  EXPECT_LE(estimate, many.red.size());
+}
+
+// T5-Con varios hilos el orden de los índices es el mismo que con un recorrido secuencial
+TEST(ColorIndexTest, IndependentOfThreadCount) {
+  TestPlanes const hashed = makePlanes(300007, 65536);
+  TestPlanes const direct = makePlanes(std::size_t{1} << 20, 256);
+  for (unsigned const threads : {1U, 3U, 8U}) {
+    threadpool::setThreadCount(threads);
+    expectFirstOccurrence(hashed, 65535);
+    expectFirstOccurrence(direct, 255);
+  }
+  threadpool::setThreadCount(0);
+}
@@ -0,0 +1,157 @@
+#include <common/colorsearch.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+namespace {
+  std::int64_t distanceSquared(image::ColorTuple const & first, image::ColorTuple const & second) {
+    auto const [red, green, blue]                = first;
+    auto const [otherRed, otherGreen, otherBlue] = second;
+    std::int64_t const deltaRed                  = red - otherRed;
+    std::int64_t const deltaGreen                = green - otherGreen;
+    std::int64_t const deltaBlue                 = blue - otherBlue;
+    return (deltaRed * deltaRed) + (deltaGreen * deltaGreen) + (deltaBlue * deltaBlue);
+  }
+
+  // Recorrido lineal de referencia: se queda con el primer color a distancia mínima
+  image::ColorTuple linearNearest(std::vector<image::ColorTuple> const & palette,
+                                  image::ColorTuple const & query) {
+    std::int64_t best = std::numeric_limits<std::int64_t>::max();
+    image::ColorTuple nearest{};
+    for (auto const & color : palette) {
+      std::int64_t const distance = distanceSquared(color, query);
+      if (distance < best) {
+        best    = distance;
+        nearest = color;
+      }
+    }
+    return nearest;
+  }
+
+  std::vector<image::ColorTuple> makeColors(std::size_t const count, unsigned const modulus,
+                                            std::uint32_t seed) {
+    std::vector<image::ColorTuple> colors;
+    auto const next = [&seed, modulus] {
+      seed = (seed * 1664525U) + 1013904223U;
+      return static_cast<std::uint16_t>((seed >> 8U) % modulus);
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+      std::uint16_t const red   = next();
+      std::uint16_t const green = next();
+      std::uint16_t const blue  = next();
+      colors.emplace_back(red, green, blue);
+    }
+    return colors;
+  }
+
+  void expectPlanarMatchesLinear(std::vector<image::ColorTuple> const & palette,
+                                 std::vector<image::ColorTuple> const & queries) {
+    image::PlanarPalette const planar(palette);
+    std::vector<std::uint32_t> indices(queries.size());
+    planar.nearest(queries, indices);
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      EXPECT_EQ(palette[indices[i]], linearNearest(palette, queries[i])) << "query " << i;
+    }
+  }
+
+  void expectMatchesLinear(std::vector<image::ColorTuple> const & palette,
+                           std::vector<image::ColorTuple> const & queries) {
+    auto const nearest = image::nearestColors(palette, queries);
+    ASSERT_EQ(nearest.size(), queries.size());
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      EXPECT_EQ(nearest[i], linearNearest(palette, queries[i])) << "query " << i;
+    }
+  }
+
+  // El color elegido por la búsqueda aproximada no se aleja del más cercano más que la cota
+  // devuelta; devuelve el número de consultas resueltas de forma exacta
+  std::size_t expectWithinBound(std::vector<image::ColorTuple> const & palette,
+                                std::vector<image::ColorTuple> const & queries) {
+    auto const approximate = image::approximateNearestColors(palette, queries);
+    EXPECT_GE(approximate.maxError, 0);
+    std::size_t exact = 0;
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+      std::int64_t const excess = distanceSquared(approximate.colors[i], queries[i]) -
+                                  distanceSquared(linearNearest(palette, queries[i]), queries[i]);
+      EXPECT_LE(excess, approximate.maxError) << "query " << i;
+      if (excess == 0) { ++exact; }
+    }
+    return exact;
+  }
+}  // namespace
+
+// T1-Paleta de 16 bits aleatoria, con varios hilos
+TEST(ColorSearchTest, WidePaletteMatchesLinearScan) {
+  threadpool::setThreadCount(4);
+  expectMatchesLinear(makeColors(5000, 65536, 1), makeColors(3000, 65536, 2));
+  threadpool::setThreadCount(0);
+}
+
+// T2-Paleta con muy pocos valores por canal: muchos empates que deben resolverse como el
+// recorrido lineal, quedándose con el color que aparece antes
+TEST(ColorSearchTest, TiesResolveToFirstPaletteEntry) {
+  expectMatchesLinear(makeColors(2000, 5, 3), makeColors(2000, 6, 4));
+}
+
+// T3-Paleta en rejilla regular: las consultas a medio camino están a igual distancia de varios
+TEST(ColorSearchTest, GridPaletteMatchesLinearScan) {
+  std::vector<image::ColorTuple> palette;
+  // El rojo va de mayor a menor para que el orden de la paleta no sea el de los colores
+  for (int blue = 0; blue <= 40; blue += 10) {
+    for (int red = 40; red >= 0; red -= 10) {
+      for (int green = 0; green <= 40; green += 10) {
+        palette.emplace_back(red, green, blue);
+      }
+    }
+  }
+  expectMatchesLinear(palette, makeColors(1000, 45, 5));
+}
+
+// T4-Búsqueda exhaustiva con canales pequeños (carriles de 32 bits); los tamaños no son múltiplos
+// del ancho vectorial ni del bloque de consultas
+TEST(ColorSearchTest, PlanarNarrowPaletteMatchesLinearScan) {
+  expectPlanarMatchesLinear(makeColors(1003, 256, 7), makeColors(1001, 256, 8));
+  expectPlanarMatchesLinear(makeColors(5, 256, 9), makeColors(3, 256, 10));
+  expectPlanarMatchesLinear(makeColors(300, 4, 11), makeColors(299, 5, 12));
+}
+
+// T5-Búsqueda exhaustiva con canales de 16 bits (carriles de 64 bits)
+TEST(ColorSearchTest, PlanarWidePaletteMatchesLinearScan) {
+  expectPlanarMatchesLinear(makeColors(1002, 65536, 13), makeColors(1003, 65536, 14));
+  // Paleta de 8 bits con consultas de 16 bits: el bloque debe pasar a carriles de 64 bits
+  expectPlanarMatchesLinear(makeColors(77, 256, 15), makeColors(9, 65536, 16));
+}
+
+// T6-Sin colores en la paleta todas las consultas devuelven el negro
+TEST(ColorSearchTest, EmptyPaletteGivesBlack) {
+  auto const nearest = image::nearestColors({}, makeColors(3, 256, 6));
+  EXPECT_EQ(nearest, std::vector<image::ColorTuple>(3));
+}
+
+// T7-Con la paleta repartida por todo el espacio casi todas las consultas encuentran el más cercano
+// en su vecindad, y ninguna se aleja más de la cota
+TEST(ColorSearchTest, ApproximateWithinBound) {
+  threadpool::setThreadCount(3);
+  auto const queries = makeColors(2000, 65536, 17);
+  EXPECT_GT(expectWithinBound(makeColors(20000, 65536, 18), queries), queries.size() * 9 / 10);
+  threadpool::setThreadCount(0);
+  expectWithinBound(makeColors(3000, 256, 19), makeColors(1000, 256, 20));
+}
+
+// T8-Consultas lejos de todos los colores de la paleta (celdas vecinas vacías) y fuera de la
+// rejilla: se resuelven en los niveles gruesos sin superar la cota
+TEST(ColorSearchTest, ApproximateFarQueriesWithinBound) {
+  std::vector<image::ColorTuple> palette = makeColors(5000, 1024, 21);
+  for (auto & [red, green, blue] : palette) { red = static_cast<std::uint16_t>(red + 30000); }
+  expectWithinBound(palette, makeColors(1000, 65536, 22));
+  expectWithinBound({{7, 7, 7}}, makeColors(10, 256, 23));
+}
+
+// T9-Con la paleta vacía la búsqueda aproximada también devuelve el negro
+TEST(ColorSearchTest, ApproximateEmptyPaletteGivesBlack) {
+  auto const approximate = image::approximateNearestColors({}, makeColors(3, 256, 24));
+  EXPECT_EQ(approximate.colors, std::vector<image::ColorTuple>(3));
+  EXPECT_EQ(approximate.maxError, 0);
+}
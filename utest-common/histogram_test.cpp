@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <common/histogram.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace {
+  struct TestPlanes {
+      std::vector<unsigned short> red;
+      std::vector<unsigned short> green;
+      std::vector<unsigned short> blue;
+
+      [[nodiscard]] image::PixelChannels channels() const {
+        return {.channels = {std::span<unsigned short const>(red), green, blue},
+                .stride   = 1,
+                .count    = red.size()};
+      }
+  };
+
+  // Colores con repeticiones, para que haya frecuencias mayores que 1
+  TestPlanes makePlanes(std::size_t const pixels, unsigned const modulus) {
+    TestPlanes planes{.red = std::vector<unsigned short>(pixels),
+                      .green = std::vector<unsigned short>(pixels),
+                      .blue = std::vector<unsigned short>(pixels)};
+    for (std::size_t i = 0; i < pixels; ++i) {
+      std::size_t const seed = (i * i * 2654435761U) % 4099;
+      planes.red[i]          = static_cast<unsigned short>((seed * 7) % modulus);
+      planes.green[i]        = static_cast<unsigned short>((seed * 13) % modulus);
+      planes.blue[i]         = static_cast<unsigned short>((seed * 31) % modulus);
+    }
+    return planes;
+  }
+
+  std::vector<image::ColorFrequency> referenceHistogram(TestPlanes const & planes) {
+    std::map<image::PackedColor, std::uint32_t> counts;
+    for (std::size_t i = 0; i < planes.red.size(); ++i) {
+      ++counts[image::packColor(planes.red[i], planes.green[i], planes.blue[i])];
+    }
+    std::vector<image::ColorFrequency> histogram;
+    for (auto const & [color, count] : counts) {
+      histogram.push_back({.color = color, .count = count});
+    }
+    return histogram;
+  }
+}  // namespace
+
+// T1-El orden de los colores empaquetados coincide con el de las tuplas (r, g, b)
+TEST(HistogramTest, PackedColorsKeepTupleOrder) {
+  EXPECT_LT(image::packColor(1, 0, 0), image::packColor(1, 0, 1));
+  EXPECT_LT(image::packColor(0, 65535, 65535), image::packColor(1, 0, 0));
+  EXPECT_EQ(image::unpackColor(image::packColor(65535, 2, 300)),
+            std::make_tuple(std::uint16_t{65535}, std::uint16_t{2}, std::uint16_t{300}));
+}
+
+// T2-Imágenes de 16 bits (tablas hash parciales) con varios hilos
+TEST(HistogramTest, WideSamplesMatchOrderedMap) {
+  TestPlanes const planes = makePlanes(200003, 65536);
+  threadpool::setThreadCount(4);
+  auto const histogram = image::countColors(planes.channels(), 65535);
+  threadpool::setThreadCount(0);
+  EXPECT_EQ(histogram, referenceHistogram(planes));
+}
+
+// T3-Imágenes de 8 bits grandes (array directo) con varios hilos
+TEST(HistogramTest, NarrowSamplesMatchOrderedMap) {
+  TestPlanes const planes = makePlanes(std::size_t{1} << 21, 256);
+  threadpool::setThreadCount(3);
+  auto const histogram = image::countColors(planes.channels(), 255);
+  threadpool::setThreadCount(0);
+  EXPECT_EQ(histogram, referenceHistogram(planes));
+}
+
+// T4-Si una imagen declarada de 8 bits tiene muestras mayores, se cuenta con tablas hash
+TEST(HistogramTest, OutOfRangeSamplesFallBackToHashing) {
+  TestPlanes planes  = makePlanes(std::size_t{1} << 20, 256);
+  planes.blue.back() = 1000;
+  EXPECT_EQ(image::countColors(planes.channels(), 255), referenceHistogram(planes));
+}
+
+// T5-La tabla plana sigue encontrando todos los colores tras crecer
+TEST(HistogramTest, FlatColorMapGrows) {
+  image::FlatColorMap<std::uint32_t> map;
+  constexpr std::uint32_t colors = 5000;
+  for (std::uint32_t i = 0; i < colors; ++i) {
+    map[image::packColor(0, 0, static_cast<unsigned short>(i))] = i;
+  }
+  ASSERT_EQ(map.size(), colors);
+  for (std::uint32_t i = 0; i < colors; ++i) {
+    auto const * value = map.get(image::packColor(0, 0, static_cast<unsigned short>(i)));
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, i);
+  }
+  EXPECT_EQ(map.get(image::packColor(1, 0, 0)), nullptr);
+}
+
+// T5-splitLeastFrequent elimina los mismos colores que ordenar por (frecuencia, color) y conserva
+// el orden por color en los dos grupos, con muchos empates y varios hilos
+TEST(HistogramTest, SplitMatchesFullSort) {
+  auto const histogram = referenceHistogram(makePlanes(300007, 65536));
+  auto sorted          = histogram;
+  std::ranges::sort(sorted, [](auto const & first, auto const & second) {
+    return std::tie(first.count, first.color) < std::tie(second.count, second.color);
+  });
+  threadpool::setThreadCount(3);
+  for (std::size_t const n : {std::size_t{1}, histogram.size() / 3, histogram.size() - 1}) {
+    std::vector<image::PackedColor> removed;
+    for (std::size_t i = 0; i < n; ++i) { removed.push_back(sorted[i].color); }
+    std::ranges::sort(removed);
+    std::vector<image::ColorTuple> expectedRemoved;
+    std::vector<image::ColorTuple> expectedKept;
+    for (auto const & [color, count] : histogram) {
+      bool const remove = std::ranges::binary_search(removed, color);
+      (remove ? expectedRemoved : expectedKept).push_back(image::unpackColor(color));
+    }
+    auto const [colorsToRemove, remainingColors] = image::splitLeastFrequent(histogram, n);
+    EXPECT_EQ(colorsToRemove, expectedRemoved) << "n = " << n;
+    EXPECT_EQ(remainingColors, expectedKept) << "n = " << n;
+  }
+  threadpool::setThreadCount(0);
+}
+
+// T6-Con n = 0 se conservan todos los colores y con n >= número de colores se eliminan todos
+TEST(HistogramTest, SplitEdgeCases) {
+  auto const histogram   = referenceHistogram(makePlanes(1000, 256));
+  auto const [none, all] = image::splitLeastFrequent(histogram, 0);
+  EXPECT_TRUE(none.empty());
+  EXPECT_EQ(all.size(), histogram.size());
+  auto const [removed, kept] = image::splitLeastFrequent(histogram, histogram.size() + 5);
+  EXPECT_EQ(removed.size(), histogram.size());
+  EXPECT_TRUE(kept.empty());
+  EXPECT_TRUE(image::splitLeastFrequent({}, 3).first.empty());
+}
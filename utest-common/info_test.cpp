@@ -0,0 +1,79 @@
+#include <common/info.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace {
+  std::filesystem::path writeFile(std::string const & name, std::string const & header,
+                                  std::size_t payloadBytes) {
+    auto const path = std::filesystem::temp_directory_path() / ("imtool-info-" + name);
+    std::ofstream out(path, std::ios::binary);
+    out << header << std::string(payloadBytes, '\0');
+    return path;
+  }
+}  // namespace
+
+// T1-Una imagen completa se reconoce sin leer sus píxeles
+TEST(ProbeFileTest, ReportsCompleteImage) {
+  auto const path = writeFile("ok.ppm", "P6\n4 2\n65535\n", 4 * 2 * 3 * 2);
+  auto const info = image::probeFile(path.string());
+
+  EXPECT_EQ(info.status, image::PayloadStatus::Ok);
+  EXPECT_EQ(info.header.getWidth(), 4);
+  EXPECT_EQ(info.header.getHeight(), 2);
+  EXPECT_EQ(info.header.getMaxColorValue(), 65535);
+  EXPECT_EQ(info.fileSize, info.expectedSize);
+  std::filesystem::remove(path);
+}
+
+// T2-Los ficheros con menos o más datos de los que indica la cabecera se detectan
+TEST(ProbeFileTest, DetectsPayloadSizeMismatch) {
+  auto const shortPath = writeFile("short.ppm", "P6\n4 2\n255\n", 4 * 2 * 3 - 1);
+  auto const longPath  = writeFile("long.ppm", "P6\n4 2\n255\n", 4 * 2 * 3 + 1);
+
+  EXPECT_EQ(image::probeFile(shortPath.string()).status, image::PayloadStatus::Truncated);
+  EXPECT_EQ(image::probeFile(longPath.string()).status, image::PayloadStatus::TrailingData);
+  std::filesystem::remove(shortPath);
+  std::filesystem::remove(longPath);
+}
+
+// T3-Una cabecera no soportada o un fichero inexistente se marcan como inválidos
+TEST(ProbeFileTest, RejectsInvalidFiles) {
+  auto const path = writeFile("p3.ppm", "P3\n4 2\n255\n", 0);
+
+  EXPECT_EQ(image::probeFile(path.string()).status, image::PayloadStatus::Invalid);
+  EXPECT_EQ(image::probeFile(path.string() + ".missing").status, image::PayloadStatus::Invalid);
+  std::filesystem::remove(path);
+}
+
+// T4-El modo multifichero imprime una línea JSON por fichero
+TEST(ProbeFileTest, PrintsOneJsonLinePerFile) {
+  auto const path = writeFile("json \"1\".ppm", "P6\n1 1\n255\n", 3);
+
+  std::ostringstream out;
+  EXPECT_TRUE(image::printFileInfos(out, {path.string(), path.string()}, true));
+
+  std::string const expected = R"({"file":")" + std::filesystem::temp_directory_path().string() +
+                               R"(/imtool-info-json \"1\".ppm","width":1,"height":1,)" +
+                               R"("maxColorValue":255,"fileSize":14,"expectedSize":14,)" +
+                               R"("status":"ok"})" + "\n";
+  EXPECT_EQ(out.str(), expected + expected);
+  std::filesystem::remove(path);
+}
+
+// T5-Con un fichero comprimido se espera el tamaño de la tabla de colores y de los índices
+TEST(ProbeFileTest, ReportsCompressedImage) {
+  // Tres colores de 8 bits: 9 bytes de tabla y 5 píxeles de 2 bits en 2 bytes
+  auto const packedPath  = writeFile("packed.cppm", "C6v2 5 1 255 3\n", 9 + 2);
+  auto const alignedPath = writeFile("aligned.cppm", "C6 5 1 65535 3\n", 18 + 5 - 1);
+
+  auto const info = image::probeFile(packedPath.string());
+  EXPECT_EQ(info.status, image::PayloadStatus::Ok);
+  EXPECT_EQ(info.header.getWidth(), 5);
+  EXPECT_EQ(info.header.getMaxColorValue(), 255);
+  EXPECT_EQ(image::probeFile(alignedPath.string()).status, image::PayloadStatus::Truncated);
+  std::filesystem::remove(packedPath);
+  std::filesystem::remove(alignedPath);
+}
@@ -0,0 +1,102 @@
+#include <common/labelmap.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+  struct TestPlanes {
+      std::vector<unsigned short> red;
+      std::vector<unsigned short> green;
+      std::vector<unsigned short> blue;
+
+      [[nodiscard]] image::PixelChannels channels() const {
+        return {.channels = {std::span<unsigned short const>(red), green, blue},
+                .stride   = 1,
+                .count    = red.size()};
+      }
+
+      [[nodiscard]] image::WritablePixelChannels writable() {
+        return {.channels = {red, green, blue}, .stride = 1, .count = red.size()};
+      }
+
+      [[nodiscard]] image::PackedColor at(std::size_t const pixel) const {
+        return image::packColor(red[pixel], green[pixel], blue[pixel]);
+      }
+  };
+
+  TestPlanes makePlanes(std::size_t const pixels, unsigned const modulus) {
+    TestPlanes planes{.red   = std::vector<unsigned short>(pixels),
+                      .green = std::vector<unsigned short>(pixels),
+                      .blue  = std::vector<unsigned short>(pixels)};
+    for (std::size_t i = 0; i < pixels; ++i) {
+      std::size_t const seed = (i * i * 2654435761U) % 8191;
+      planes.red[i]          = static_cast<unsigned short>((seed * 7) % modulus);
+      planes.green[i]        = static_cast<unsigned short>((seed * 13) % modulus);
+      planes.blue[i]         = static_cast<unsigned short>((seed * 31) % modulus);
+    }
+    return planes;
+  }
+
+  image::ColorLabels labelWithThreads(TestPlanes const & planes, unsigned const threads) {
+    threadpool::setThreadCount(threads);
+    image::ColorLabels labels = image::labelColors(planes.channels());
+    threadpool::setThreadCount(0);
+    return labels;
+  }
+}  // namespace
+
+// T1-Las etiquetas siguen el orden de primera aparición aunque se etiquete con varios hilos
+TEST(LabelMapTest, LabelsFollowFirstOccurrence) {
+  TestPlanes const planes         = makePlanes(300007, 65536);
+  image::ColorLabels const labels = labelWithThreads(planes, 3);
+  std::map<image::PackedColor, std::uint32_t> reference;
+  ASSERT_EQ(labels.labels.size(), planes.red.size());
+  for (std::size_t i = 0; i < planes.red.size(); ++i) {
+    auto const [found, added] =
+        reference.try_emplace(planes.at(i), static_cast<std::uint32_t>(reference.size()));
+    ASSERT_EQ(labels.labels[i], found->second) << "pixel " << i;
+  }
+  EXPECT_EQ(labels.colors.size(), reference.size());
+  for (auto const & [color, label] : reference) { EXPECT_EQ(labels.colors[label], color); }
+}
+
+// T2-Las frecuencias de las etiquetas dan el mismo histograma que countColors
+TEST(LabelMapTest, HistogramMatchesCountColors) {
+  TestPlanes const planes         = makePlanes(200003, 256);
+  image::ColorLabels const labels = labelWithThreads(planes, 2);
+  auto const labeled              = image::labeledHistogram(labels);
+  auto const counted              = image::countColors(planes.channels(), 255);
+  ASSERT_EQ(labeled.size(), counted.size());
+  for (std::size_t i = 0; i < labeled.size(); ++i) {
+    EXPECT_EQ(labeled[i].color, counted[i].color);
+    EXPECT_EQ(labeled[i].count, counted[i].count);
+  }
+}
+
+// T3-Sustituir por etiquetas da el mismo resultado que ReplacementTable::apply
+TEST(LabelMapTest, ReplacementMatchesTable) {
+  TestPlanes const before = makePlanes(100003, 1024);
+  image::ReplacementTable table;
+  for (std::size_t i = 1; i < before.red.size(); i += 5) {
+    image::ColorTuple const from{before.red[i], before.green[i], before.blue[i]};
+    table.add(from, {before.red[0], before.green[0], before.blue[0]});
+  }
+  TestPlanes expected = before;
+  table.apply(expected.writable());
+
+  TestPlanes labeled = before;
+  image::replaceLabeledColors(labeled.writable(), image::labelColors(before.channels()), table);
+  EXPECT_EQ(labeled.red, expected.red);
+  EXPECT_EQ(labeled.green, expected.green);
+  EXPECT_EQ(labeled.blue, expected.blue);
+}
+
+// T4-Una imagen sin píxeles no tiene etiquetas ni colores
+TEST(LabelMapTest, EmptyImage) {
+  image::ColorLabels const labels = image::labelColors(TestPlanes{}.channels());
+  EXPECT_TRUE(labels.labels.empty());
+  EXPECT_TRUE(labels.colors.empty());
+  EXPECT_TRUE(image::labeledHistogram(labels).empty());
+}
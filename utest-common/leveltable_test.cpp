@@ -0,0 +1,62 @@
+#include <common/leveltable.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+// T1-Cada nivel se convierte en floor(v * nuevo / anterior), calculado sin error de coma flotante
+TEST(LevelTableTest, ScalesWithExactIntegerFloor) {
+  for (auto const & [oldMax, newMax] : {std::pair<unsigned short, unsigned short>{255, 100},
+                                      {1000, 65535}, {65535, 255}, {255, 255}, {300, 1}}) {
+    image::LevelTable const levels(oldMax, newMax);
+    for (std::uint32_t level = 0; level <= oldMax; ++level) {
+      ASSERT_EQ(levels[static_cast<unsigned short>(level)], level * newMax / oldMax)
+          << oldMax << " -> " << newMax << " at " << level;
+    }
+  }
+
+  // 51 * 100 / 255 es exactamente 20; con el factor en float salía 19
+  EXPECT_EQ(image::LevelTable(255, 100)[51], 20);
+}
+
+// T2-Los niveles por encima del máximo anterior se recortan al nuevo máximo
+TEST(LevelTableTest, ClampsOutOfRangeLevels) {
+  image::LevelTable const levels(100, 1000);
+  EXPECT_EQ(levels[100], 1000);
+  EXPECT_EQ(levels[101], 1000);
+  EXPECT_EQ(levels[65535], 1000);
+}
+
+// T3-La aplicación vectorial y por bloques coincide con la búsqueda muestra a muestra
+TEST(LevelTableTest, ApplyMatchesLookup) {
+  image::LevelTable const levels(65535, 1023);
+  std::vector<unsigned short> samples(100003);
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = static_cast<unsigned short>(i * 40503U);
+  }
+  samples.back() = 65535;
+
+  std::vector<unsigned short> const original = samples;
+  levels.apply(samples);
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    ASSERT_EQ(samples[i], levels[original[i]]) << "at " << i;
+  }
+}
+
+// T4-La tabla compuesta equivale a aplicar las dos tablas una tras otra, también por filas
+TEST(LevelTableTest, ComposedTableMatchesSequentialLookup) {
+  image::LevelTable const first(65535, 1000);
+  image::LevelTable const second(1000, 255);
+  image::LevelTable const composed(first, second);
+  for (std::uint32_t level = 0; level <= 65535; ++level) {
+    auto const sample = static_cast<unsigned short>(level);
+    ASSERT_EQ(composed[sample], second[first[sample]]) << "at " << level;
+  }
+
+  std::vector<unsigned short> row(1001);
+  for (std::size_t i = 0; i < row.size(); ++i) { row[i] = static_cast<unsigned short>(i * 65); }
+  std::vector<unsigned short> const original = row;
+  composed.applyRow(row);
+  for (std::size_t i = 0; i < row.size(); ++i) {
+    ASSERT_EQ(row[i], composed[original[i]]) << "at " << i;
+  }
+}
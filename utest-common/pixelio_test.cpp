@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <array>
+#include <common/image.hpp>
+#include <common/pixelio.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+namespace {
+  std::string const HEADER_16BIT = "P6\n# comentario\n2 1\n65535\n";
+  std::vector<unsigned char> const PAYLOAD_16BIT{0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+                                                 0xFF, 0xFE, 0x00, 0x10, 0x80, 0x00};
+
+  std::filesystem::path tempPath(std::string const & name) {
+    return std::filesystem::temp_directory_path() / ("imtool-pixelio-" + name);
+  }
+
+  void writeFile(std::filesystem::path const & path, std::string const & header,
+                 std::vector<unsigned char> const & payload) {
+    std::ofstream out(path, std::ios::binary);
+    out << header;
+    for (unsigned char const byte : payload) { out.put(static_cast<char>(byte)); }
+  }
+
+  struct DecodedPixel {
+      unsigned short red;
+      unsigned short green;
+      unsigned short blue;
+
+      bool operator==(DecodedPixel const & other) const = default;
+  };
+
+  std::vector<DecodedPixel> decodeAll(std::span<unsigned char const> row, std::size_t sampleBytes) {
+    std::vector<DecodedPixel> pixels;
+    image::decodeRow(row, sampleBytes,
+                     [&pixels](std::size_t, unsigned short red, unsigned short green,
+                               unsigned short blue) { pixels.push_back({red, green, blue}); });
+    return pixels;
+  }
+}  // namespace
+
+// T1-Los datos de un fichero regular se proyectan en memoria a partir del final de la cabecera
+TEST(PixelSourceTest, MapsRegularFileAfterHeader) {
+  auto const path = tempPath("regular.ppm");
+  writeFile(path, HEADER_16BIT, PAYLOAD_16BIT);
+
+  std::ifstream file(path, std::ios::binary);
+  image::Image header;
+  ASSERT_TRUE(header.readHeader(file));
+
+  image::PixelSource source(file, path.string());
+  EXPECT_TRUE(source.isMapped());
+
+  auto const row = source.next(PAYLOAD_16BIT.size());
+  ASSERT_EQ(row.size(), PAYLOAD_16BIT.size());
+  EXPECT_TRUE(std::equal(row.begin(), row.end(), PAYLOAD_16BIT.begin()));
+  EXPECT_TRUE(source.next(1).empty());
+
+  std::filesystem::remove(path);
+}
+
+// T2-Las tuberías se leen por bloques y producen los mismos bytes
+TEST(PixelSourceTest, FallsBackToReadForPipes) {
+  auto const path = tempPath("fifo.ppm");
+  std::filesystem::remove(path);
+  ASSERT_EQ(mkfifo(path.c_str(), S_IRUSR | S_IWUSR), 0);
+
+  std::thread writer([&path] { writeFile(path, HEADER_16BIT, PAYLOAD_16BIT); });
+
+  std::ifstream file(path, std::ios::binary);
+  image::Image header;
+  ASSERT_TRUE(header.readHeader(file));
+
+  image::PixelSource source(file, path.string());
+  EXPECT_FALSE(source.isMapped());
+
+  auto const row = source.next(PAYLOAD_16BIT.size());
+  ASSERT_EQ(row.size(), PAYLOAD_16BIT.size());
+  EXPECT_TRUE(std::equal(row.begin(), row.end(), PAYLOAD_16BIT.begin()));
+  EXPECT_TRUE(source.next(1).empty());
+
+  writer.join();
+  std::filesystem::remove(path);
+}
+
+// T3-Las muestras de 16 bits se leen en orden big-endian
+TEST(PixelSourceTest, DecodesBigEndianSamples) {
+  auto const pixels = decodeAll(PAYLOAD_16BIT, 2);
+
+  ASSERT_EQ(pixels.size(), 2);
+  EXPECT_EQ(pixels[0], (DecodedPixel{0x0102, 0x0304, 0x0506}));
+  EXPECT_EQ(pixels[1], (DecodedPixel{0xFFFE, 0x0010, 0x8000}));
+}
+
+// T4-Las muestras de 8 bits se amplían sin escalar
+TEST(PixelSourceTest, WidensEightBitSamples) {
+  std::array<unsigned char, 6> const payload{0, 127, 255, 1, 2, 3};
+  auto const pixels = decodeAll(payload, 1);
+
+  ASSERT_EQ(pixels.size(), 2);
+  EXPECT_EQ(pixels[0], (DecodedPixel{0, 127, 255}));
+  EXPECT_EQ(pixels[1], (DecodedPixel{1, 2, 3}));
+}
+
+// T5-La codificación entrelazada (AOS) y por planos (SOA) produce los mismos bytes que la
+// decodificación consume, incluyendo la cola que no llena un bloque vectorial
+TEST(PixelSourceTest, EncodersRoundTripThroughDecoder) {
+  constexpr std::size_t width = 37;
+  for (std::size_t const sampleBytes : {std::size_t{1}, std::size_t{2}}) {
+    unsigned const modulus = sampleBytes == 2 ? 65536U : 256U;
+    std::vector<unsigned short> samples(width * image::CHANNELS);
+    std::vector<unsigned short> red(width);
+    std::vector<unsigned short> green(width);
+    std::vector<unsigned short> blue(width);
+    for (std::size_t i = 0; i < width; ++i) {
+      red[i]   = static_cast<unsigned short>((i * 7919U) % modulus);
+      green[i] = static_cast<unsigned short>((i * 104729U + 13U) % modulus);
+      blue[i]  = static_cast<unsigned short>((i * 1299709U + 101U) % modulus);
+      samples[i * image::CHANNELS]       = red[i];
+      samples[(i * image::CHANNELS) + 1] = green[i];
+      samples[(i * image::CHANNELS) + 2] = blue[i];
+    }
+
+    std::vector<unsigned char> interleaved(samples.size() * sampleBytes);
+    std::vector<unsigned char> planar(samples.size() * sampleBytes);
+    image::encodeSamples(samples, sampleBytes, interleaved);
+    image::encodePlanes({.red = red, .green = green, .blue = blue}, sampleBytes, planar);
+    EXPECT_EQ(interleaved, planar);
+
+    auto const decoded = decodeAll(interleaved, sampleBytes);
+    ASSERT_EQ(decoded.size(), width);
+    for (std::size_t i = 0; i < width; ++i) {
+      EXPECT_EQ(decoded[i], (DecodedPixel{red[i], green[i], blue[i]}));
+    }
+  }
+}
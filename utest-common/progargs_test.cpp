@@ -0,0 +1,32 @@
+#include <common/progargs.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+  // Error de parseJob para la línea de órdenes; vacío si es válida
+  std::string jobError(std::vector<std::string> const & args) {
+    try {
+      [[maybe_unused]] auto const parsed = progargs::parseJob(args);
+    } catch (progargs::ArgumentError const & error) {
+      return error.what();
+    }
+    return {};
+  }
+}  // namespace
+
+// T1-La búsqueda aproximada de cutfreq no admite --labels, tampoco dentro de una cadena
+TEST(ProgArgsTest, RejectsLabelsWithApproximateCutFreq) {
+  std::string const rejected = "--labels cannot be combined with approximate cutfreq";
+  EXPECT_EQ(jobError({"imtool", "a.ppm", "a_out.ppm", "cutfreq", "10", "approx", "--labels"}),
+            rejected);
+  EXPECT_EQ(jobError({"imtool", "b.ppm", "b_out.cppm", "cutfreq", "10", "approx", "+", "compress",
+                      "--labels"}),
+            rejected);
+  EXPECT_EQ(jobError({"imtool", "c.ppm", "c_out.ppm", "cutfreq", "10", "exact", "--labels"}), "");
+
+  progargs::ParsedOperationArgs const parsed =
+      progargs::parseJob({"imtool", "d.ppm", "d_out.ppm", "cutfreq", "10", "approx"});
+  EXPECT_EQ(parsed.cutFreqMethod, progargs::CutFreqMethod::Approximate);
+  EXPECT_FALSE(parsed.options.labels);
+}
@@ -0,0 +1,104 @@
+#include <common/replacement.hpp>
+#include <common/threadpool.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+  using ColorMap = std::map<image::ColorTuple, image::ColorTuple>;
+
+  struct TestPlanes {
+      std::vector<unsigned short> red;
+      std::vector<unsigned short> green;
+      std::vector<unsigned short> blue;
+
+      [[nodiscard]] image::ColorTuple at(std::size_t const pixel) const {
+        return {red[pixel], green[pixel], blue[pixel]};
+      }
+  };
+
+  TestPlanes makePlanes(std::size_t const pixels, unsigned const modulus) {
+    TestPlanes planes{.red   = std::vector<unsigned short>(pixels),
+                      .green = std::vector<unsigned short>(pixels),
+                      .blue  = std::vector<unsigned short>(pixels)};
+    for (std::size_t i = 0; i < pixels; ++i) {
+      std::size_t const seed = (i * 2654435761U) % 1021;
+      planes.red[i]          = static_cast<unsigned short>((seed * 3) % modulus);
+      planes.green[i]        = static_cast<unsigned short>((seed * 5) % modulus);
+      planes.blue[i]         = static_cast<unsigned short>((seed * 7) % modulus);
+    }
+    return planes;
+  }
+
+  // Sustituye uno de cada tres colores presentes por el color del píxel 0
+  ColorMap everyThirdColor(TestPlanes const & planes) {
+    ColorMap replacements;
+    for (std::size_t i = 1; i < planes.red.size(); i += 3) {
+      if (planes.at(i) != planes.at(0)) { replacements[planes.at(i)] = planes.at(0); }
+    }
+    return replacements;
+  }
+
+  void expectReplaced(TestPlanes const & before, TestPlanes const & after,
+                      ColorMap const & replacements) {
+    for (std::size_t i = 0; i < before.red.size(); ++i) {
+      auto const found = replacements.find(before.at(i));
+      EXPECT_EQ(after.at(i), found == replacements.end() ? before.at(i) : found->second)
+          << "pixel " << i;
+    }
+  }
+
+  void applyPlanar(image::ReplacementTable const & table, TestPlanes & planes) {
+    table.apply({.channels = {planes.red, planes.green, planes.blue},
+                 .stride   = 1,
+                 .count    = planes.red.size()});
+  }
+}  // namespace
+
+// T1-Planos separados de 8 bits con varios hilos; el número de píxeles no es múltiplo del bloque
+// vectorial
+TEST(ReplacementTest, NarrowPlanesMatchMap) {
+  TestPlanes const before     = makePlanes(200003, 256);
+  ColorMap const replacements = everyThirdColor(before);
+  TestPlanes after            = before;
+  threadpool::setThreadCount(3);
+  applyPlanar(image::replacementTable(replacements), after);
+  threadpool::setThreadCount(0);
+  expectReplaced(before, after, replacements);
+}
+
+// T2-Una tabla de 8 bits ignora los píxeles con muestras mayores, aunque compartan bloque con
+// píxeles que sí se sustituyen
+TEST(ReplacementTest, NarrowTableSkipsWideSamples) {
+  TestPlanes before           = makePlanes(1000, 256);
+  ColorMap const replacements = everyThirdColor(before);
+  before.green[1]             = 300;
+  before.red[17]              = 65535;
+  TestPlanes after            = before;
+  applyPlanar(image::replacementTable(replacements), after);
+  expectReplaced(before, after, replacements);
+}
+
+// T3-Colores de 16 bits con las muestras intercaladas (AOS)
+TEST(ReplacementTest, WideInterleavedSamplesMatchMap) {
+  TestPlanes const before     = makePlanes(50001, 65536);
+  ColorMap const replacements = everyThirdColor(before);
+  std::vector<unsigned short> samples;
+  for (std::size_t i = 0; i < before.red.size(); ++i) {
+    samples.insert(samples.end(), {before.red[i], before.green[i], before.blue[i]});
+  }
+  std::span<unsigned short> const view(samples);
+  image::replacementTable(replacements)
+      .apply({.channels = {view, view.subspan(1), view.subspan(2)},
+              .stride   = 3,
+              .count    = before.red.size()});
+
+  TestPlanes after = before;
+  for (std::size_t i = 0; i < before.red.size(); ++i) {
+    after.red[i]   = samples[3 * i];
+    after.green[i] = samples[(3 * i) + 1];
+    after.blue[i]  = samples[(3 * i) + 2];
+  }
+  expectReplaced(before, after, replacements);
+}
@@ -0,0 +1,178 @@
+#include <array>
+#include <common/resample.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+  struct Planes {
+      std::array<std::vector<unsigned short>, image::CHANNELS> channels;
+  };
+
+  Planes makePlanes(std::size_t const pixels, unsigned const seed) {
+    Planes planes;
+    for (std::size_t channel = 0; channel < image::CHANNELS; ++channel) {
+      planes.channels.at(channel).resize(pixels);
+      for (std::size_t i = 0; i < pixels; ++i) {
+        planes.channels.at(channel)[i] =
+            static_cast<unsigned short>((i * 7919U) + (channel * 104729U) + seed);
+      }
+    }
+    return planes;
+  }
+
+  Planes resizePlanar(Planes const & source, image::ResampleGeometry const & geometry) {
+    Planes target;
+    for (auto & plane : target.channels) {
+      plane.resize(geometry.targetWidth * geometry.targetHeight);
+    }
+    image::resizeBilinearFixed({.source = {std::span<unsigned short const>(source.channels[0]),
+                                           source.channels[1], source.channels[2]},
+                                .target = {target.channels[0], target.channels[1],
+                                           target.channels[2]},
+                                .stride = 1},
+                               geometry);
+    return target;
+  }
+
+  Planes resamplePlanar(Planes const & source, image::ResampleGeometry const & geometry,
+                        image::ResampleFilter const filter, unsigned short const maxColorValue) {
+    Planes target;
+    for (auto & plane : target.channels) {
+      plane.resize(geometry.targetWidth * geometry.targetHeight);
+    }
+    image::resample({.source = {std::span<unsigned short const>(source.channels[0]),
+                                source.channels[1], source.channels[2]},
+                     .target = {target.channels[0], target.channels[1], target.channels[2]},
+                     .stride = 1},
+                    geometry, filter, maxColorValue);
+    return target;
+  }
+
+  constexpr std::array<image::ResampleFilter, 4> ALL_FILTERS{
+    image::ResampleFilter::Box, image::ResampleFilter::Bilinear, image::ResampleFilter::Bicubic,
+    image::ResampleFilter::Lanczos3};
+}  // namespace
+
+// T1-Con las mismas dimensiones la imagen no cambia
+TEST(ResampleTest, FixedIdentityKeepsSamples) {
+  image::ResampleGeometry const geometry{
+    .sourceWidth = 13, .sourceHeight = 7, .targetWidth = 13, .targetHeight = 7};
+  Planes const source = makePlanes(geometry.sourceWidth * geometry.sourceHeight, 3);
+  EXPECT_EQ(resizePlanar(source, geometry).channels, source.channels);
+}
+
+// T2-El punto medio entre dos muestras se redondea hacia arriba
+TEST(ResampleTest, FixedRoundsHalfUp) {
+  image::ResampleGeometry const geometry{
+    .sourceWidth = 2, .sourceHeight = 1, .targetWidth = 3, .targetHeight = 1};
+  Planes source;
+  for (auto & plane : source.channels) { plane = {0, 1}; }
+  source.channels[2] = {65534, 65535};
+
+  Planes const target = resizePlanar(source, geometry);
+  EXPECT_EQ(target.channels[0], (std::vector<unsigned short>{0, 1, 1}));
+  EXPECT_EQ(target.channels[2], (std::vector<unsigned short>{65534, 65535, 65535}));
+}
+
+// T3-Las muestras entrelazadas (AOS) producen exactamente lo mismo que los planos (SOA)
+TEST(ResampleTest, FixedInterleavedMatchesPlanar) {
+  image::ResampleGeometry const geometry{
+    .sourceWidth = 29, .sourceHeight = 17, .targetWidth = 41, .targetHeight = 9};
+  std::size_t const sourcePixels = geometry.sourceWidth * geometry.sourceHeight;
+  std::size_t const targetPixels = geometry.targetWidth * geometry.targetHeight;
+  Planes const source            = makePlanes(sourcePixels, 11);
+
+  std::vector<unsigned short> interleaved(sourcePixels * image::CHANNELS);
+  for (std::size_t i = 0; i < interleaved.size(); ++i) {
+    interleaved[i] = source.channels.at(i % image::CHANNELS)[i / image::CHANNELS];
+  }
+  std::vector<unsigned short> resized(targetPixels * image::CHANNELS);
+  std::span<unsigned short const> const input(interleaved);
+  std::span<unsigned short> const output(resized);
+  image::resizeBilinearFixed({.source = {input, input.subspan(1), input.subspan(2)},
+                              .target = {output, output.subspan(1), output.subspan(2)},
+                              .stride = image::CHANNELS},
+                             geometry);
+
+  Planes const planar = resizePlanar(source, geometry);
+  for (std::size_t i = 0; i < resized.size(); ++i) {
+    ASSERT_EQ(resized[i], planar.channels.at(i % image::CHANNELS)[i / image::CHANNELS]);
+  }
+}
+
+// T4-Al reducir, box promedia todas las muestras que cubre cada píxel de destino
+TEST(ResampleTest, BoxDownscaleAveragesArea) {
+  image::ResampleGeometry const geometry{
+    .sourceWidth = 4, .sourceHeight = 2, .targetWidth = 2, .targetHeight = 1};
+  Planes source;
+  for (auto & plane : source.channels) { plane = {0, 2, 4, 6, 2, 4, 6, 8}; }
+
+  Planes const target = resamplePlanar(source, geometry, image::ResampleFilter::Box, 255);
+  for (auto const & plane : target.channels) {
+    EXPECT_EQ(plane, (std::vector<unsigned short>{2, 6}));
+  }
+}
+
+// T5-Una imagen uniforme sigue siendo uniforme con cualquier filtro y escala
+TEST(ResampleTest, FiltersPreserveFlatImages) {
+  image::ResampleGeometry const shrink{
+    .sourceWidth = 23, .sourceHeight = 19, .targetWidth = 5, .targetHeight = 7};
+  image::ResampleGeometry const grow{
+    .sourceWidth = 5, .sourceHeight = 3, .targetWidth = 17, .targetHeight = 11};
+  for (auto const & geometry : {shrink, grow}) {
+    Planes source;
+    for (auto & plane : source.channels) {
+      plane.assign(geometry.sourceWidth * geometry.sourceHeight, 1234);
+    }
+    for (auto const filter : ALL_FILTERS) {
+      Planes const target = resamplePlanar(source, geometry, filter, 65535);
+      for (auto const & plane : target.channels) {
+        EXPECT_EQ(plane, std::vector<unsigned short>(plane.size(), 1234));
+      }
+    }
+  }
+}
+
+// T6-Los lóbulos negativos de bicubic y Lanczos no se salen de [0, max]
+TEST(ResampleTest, FiltersClampToMaxColorValue) {
+  constexpr unsigned short maxColorValue = 255;
+  image::ResampleGeometry const geometry{
+    .sourceWidth = 8, .sourceHeight = 1, .targetWidth = 29, .targetHeight = 1};
+  Planes source;
+  for (auto & plane : source.channels) { plane = {0, 0, 0, 0, 255, 255, 255, 255}; }
+
+  for (auto const filter : {image::ResampleFilter::Bicubic, image::ResampleFilter::Lanczos3}) {
+    Planes const target = resamplePlanar(source, geometry, filter, maxColorValue);
+    EXPECT_EQ(target.channels[0].front(), 0);
+    EXPECT_EQ(target.channels[0].back(), maxColorValue);
+    for (unsigned short const value : target.channels[0]) { EXPECT_LE(value, maxColorValue); }
+  }
+}
+
+// T7-El remuestreador separable da el mismo resultado con muestras entrelazadas y por planos
+TEST(ResampleTest, SeparableInterleavedMatchesPlanar) {
+  image::ResampleGeometry const geometry{
+    .sourceWidth = 31, .sourceHeight = 13, .targetWidth = 12, .targetHeight = 27};
+  std::size_t const sourcePixels = geometry.sourceWidth * geometry.sourceHeight;
+  Planes const source            = makePlanes(sourcePixels, 5);
+
+  std::vector<unsigned short> interleaved(sourcePixels * image::CHANNELS);
+  for (std::size_t i = 0; i < interleaved.size(); ++i) {
+    interleaved[i] = source.channels.at(i % image::CHANNELS)[i / image::CHANNELS];
+  }
+  std::span<unsigned short const> const input(interleaved);
+  for (auto const filter : ALL_FILTERS) {
+    std::vector<unsigned short> resized(geometry.targetWidth * geometry.targetHeight *
+                                        image::CHANNELS);
+    std::span<unsigned short> const output(resized);
+    image::resample({.source = {input, input.subspan(1), input.subspan(2)},
+                     .target = {output, output.subspan(1), output.subspan(2)},
+                     .stride = image::CHANNELS},
+                    geometry, filter, 65535);
+
+    Planes const planar = resamplePlanar(source, geometry, filter, 65535);
+    for (std::size_t i = 0; i < resized.size(); ++i) {
+      ASSERT_EQ(resized[i], planar.channels.at(i % image::CHANNELS)[i / image::CHANNELS]);
+    }
+  }
+}
@@ -0,0 +1,104 @@
+#include <common/leveltable.hpp>
+#include <common/rowstream.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+  constexpr std::size_t WIDTH  = 5;
+  constexpr std::size_t HEIGHT = 4;
+
+  std::filesystem::path writePpm(std::string const & name, std::size_t const width,
+                                 std::size_t const height) {
+    auto const path = std::filesystem::temp_directory_path() / ("imtool-rowstream-" + name);
+    std::ofstream out(path, std::ios::binary);
+    out << "P6\n" << width << ' ' << height << "\n255\n";
+    for (std::size_t sample = 0; sample < width * height * 3; ++sample) {
+      out.put(static_cast<char>((sample * 37) % 256));
+    }
+    return path;
+  }
+
+  std::string readFile(std::filesystem::path const & path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  }
+}  // namespace
+
+// T1-maxlevel por bandas de una fila aplica la LevelTable a cada muestra
+TEST(RowStreamTest, MaxLevelMatchesLevelTable) {
+  auto const input  = writePpm("maxlevel-in.ppm", WIDTH, HEIGHT);
+  auto const output = std::filesystem::temp_directory_path() / "imtool-rowstream-maxlevel.ppm";
+  // Una fila: muestras, bytes de entrada (8 bits) y bytes de salida (16 bits)
+  constexpr std::size_t oneRow = (WIDTH * 3 * 2) + (WIDTH * 3) + (WIDTH * 3 * 2);
+  ASSERT_TRUE(image::streamMaxLevel(input.string(), output.string(), 1000, oneRow));
+
+  image::LevelTable const levels(255, 1000);
+  std::string expected = "P6\n5 4\n1000\n";
+  for (std::size_t sample = 0; sample < WIDTH * HEIGHT * 3; ++sample) {
+    unsigned short const level = levels[static_cast<unsigned short>((sample * 37) % 256)];
+    expected.push_back(static_cast<char>(level >> 8));
+    expected.push_back(static_cast<char>(level & 0xFF));
+  }
+  EXPECT_EQ(readFile(output), expected);
+  std::filesystem::remove(input);
+  std::filesystem::remove(output);
+}
+
+// T2-Un límite en el que no cabe ni una fila se rechaza
+TEST(RowStreamTest, RejectsTooSmallMemoryLimit) {
+  auto const input  = writePpm("small-in.ppm", WIDTH, HEIGHT);
+  auto const output = std::filesystem::temp_directory_path() / "imtool-rowstream-small.ppm";
+  EXPECT_FALSE(image::streamMaxLevel(input.string(), output.string(), 1000, 10));
+  std::filesystem::remove(input);
+  std::filesystem::remove(output);
+}
+
+// T3-Las filas de origen compartidas entre bandas se conservan y las no usadas se saltan
+TEST(RowStreamTest, ResizeKeepsSharedSourceRows) {
+  constexpr std::size_t sourceHeight = 9;
+  auto const input  = writePpm("resize-in.ppm", WIDTH, sourceHeight);
+  auto const output = std::filesystem::temp_directory_path() / "imtool-rowstream-resize.ppm";
+  std::vector<image::SourceRows> const sourceRows = {
+    {.low = 0, .high = 1},
+    {.low = 0, .high = 1},
+    {.low = 1, .high = 2},
+    {.low = 4, .high = 5},
+    {.low = 5, .high = 5},
+    {.low = 5, .high = 6},
+    {.low = 8, .high = 8}
+  };
+
+  for (std::size_t const memoryLimit : {std::size_t{200}, std::size_t{1} << 20}) {
+    image::RowReader reader;
+    ASSERT_TRUE(reader.open(input.string()));
+    // Cada muestra de destino es la media de las dos filas de origen
+    image::RowResize const resize{
+      .width      = WIDTH,
+      .height     = sourceRows.size(),
+      .layout     = image::RowLayout::Interleaved,
+      .sourceRows = sourceRows,
+      .kernel     = [](std::size_t /*yPrime*/, std::span<unsigned short const> low,
+                   std::span<unsigned short const> high, std::span<unsigned short> out) {
+        for (std::size_t i = 0; i < out.size(); ++i) {
+          out[i] = static_cast<unsigned short>((low[i] + high[i]) / 2);
+        }
+      }};
+    ASSERT_TRUE(image::streamResize(reader, output.string(), resize, memoryLimit));
+
+    std::string expected = "P6\n5 7\n255\n";
+    for (auto const & rows : sourceRows) {
+      for (std::size_t i = 0; i < WIDTH * 3; ++i) {
+        std::size_t const low  = (((rows.low * WIDTH * 3) + i) * 37) % 256;
+        std::size_t const high = (((rows.high * WIDTH * 3) + i) * 37) % 256;
+        expected.push_back(static_cast<char>((low + high) / 2));
+      }
+    }
+    EXPECT_EQ(readFile(output), expected);
+  }
+  std::filesystem::remove(input);
+  std::filesystem::remove(output);
+}
@@ -0,0 +1,208 @@
+#include <atomic>
+#include <common/progargs.hpp>
+#include <common/server.hpp>
+#include <condition_variable>
+#include <csignal>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+  std::string socketPath() {
+    return (std::filesystem::temp_directory_path() /
+            ("imtool-server-test-" + std::to_string(getpid()) + ".sock"))
+        .string();
+  }
+
+  // Envía una línea y devuelve la respuesta del servidor
+  std::string request(server::FileDescriptor const & connection, std::string const & line) {
+    server::LineReader reader(connection.get());
+    std::string reply;
+    EXPECT_TRUE(server::writeLine(connection.get(), line));
+    EXPECT_TRUE(reader.next(reply));
+    return reply;
+  }
+}  // namespace
+
+// T1-Cada línea recibe su respuesta: ok, failed o invalid con el error de los argumentos; la
+// orden shutdown detiene el servidor y borra el socket
+TEST(ServerTest, RepliesToEachJob) {
+  std::string const path = socketPath();
+  server::JobServer jobServer({.socketPath = path, .queueDepth = 4, .workers = 2},
+                              [](progargs::ParsedOperationArgs const & args) {
+                                return args.inputFilePath != "fail.ppm";
+                              });
+  ASSERT_TRUE(jobServer.isListening());
+  bool served = false;
+  std::thread serving([&] { served = jobServer.serve(); });
+
+  server::FileDescriptor const connection = server::connectUnixSocket(path);
+  ASSERT_TRUE(connection.isValid());
+  EXPECT_TRUE(request(connection, "a.ppm b.ppm maxlevel 255").starts_with("ok "));
+  EXPECT_TRUE(request(connection, "fail.ppm b.ppm resize 8 8 + maxlevel 3").starts_with("failed "));
+  EXPECT_EQ(request(connection, "a.ppm b.ppm maxlevel x"), "invalid: Invalid maxlevel: x");
+  EXPECT_EQ(request(connection, "a.ppm b.ppm info"), "invalid: Operation not allowed in a job");
+  EXPECT_EQ(request(connection, "shutdown"), "ok shutting down");
+
+  serving.join();
+  EXPECT_TRUE(served);
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+// T2-Al parar, los trabajos en curso terminan y reciben su respuesta antes de que serve() vuelva
+TEST(ServerTest, ShutdownFinishesRunningJobs) {
+  std::string const path = socketPath();
+  std::mutex mutex;
+  std::condition_variable changed;
+  int started   = 0;
+  bool released = false;
+  server::JobServer jobServer({.socketPath = path, .queueDepth = 1, .workers = 2},
+                              [&](progargs::ParsedOperationArgs const &) {
+                                std::unique_lock lock(mutex);
+                                ++started;
+                                changed.notify_all();
+                                changed.wait(lock, [&] { return released; });
+                                return true;
+                              });
+  ASSERT_TRUE(jobServer.isListening());
+  std::thread serving([&] { EXPECT_TRUE(jobServer.serve()); });
+
+  std::string firstReply;
+  std::string secondReply;
+  std::thread first([&] {
+    firstReply = request(server::connectUnixSocket(path), "a.ppm b.ppm maxlevel 255");
+  });
+  std::thread second([&] {
+    secondReply = request(server::connectUnixSocket(path), "c.ppm d.ppm maxlevel 255");
+  });
+  {
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [&] { return started == 2; });
+  }
+
+  server::FileDescriptor const control = server::connectUnixSocket(path);
+  EXPECT_EQ(request(control, "shutdown"), "ok shutting down");
+  EXPECT_EQ(request(control, "e.ppm f.ppm maxlevel 255"), "unavailable: shutting down");
+  {
+    std::scoped_lock const lock(mutex);
+    released = true;
+  }
+  changed.notify_all();
+
+  first.join();
+  second.join();
+  serving.join();
+  EXPECT_TRUE(firstReply.starts_with("ok "));
+  EXPECT_TRUE(secondReply.starts_with("ok "));
+}
+
+// T3-Con la cola llena la línea recibe "busy" sin ejecutarse, y las conexiones que pasan del
+// límite reciben "busy" y se cierran
+TEST(ServerTest, RepliesBusyWhenFull) {
+  std::string const path = socketPath();
+  std::mutex mutex;
+  std::condition_variable changed;
+  int started   = 0;
+  bool released = false;
+  server::JobServer jobServer(
+      {.socketPath = path, .queueDepth = 1, .workers = 1, .maxConnections = 4},
+      [&](progargs::ParsedOperationArgs const &) {
+        std::unique_lock lock(mutex);
+        ++started;
+        changed.notify_all();
+        changed.wait(lock, [&] { return released; });
+        return true;
+      });
+  ASSERT_TRUE(jobServer.isListening());
+  std::thread serving([&] { EXPECT_TRUE(jobServer.serve()); });
+
+  std::string runningReply;
+  std::thread running([&] {
+    runningReply = request(server::connectUnixSocket(path), "a.ppm b.ppm maxlevel 255");
+  });
+  {
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [&] { return started == 1; });
+  }
+
+  // Con el único hilo ocupado, de dos líneas más una entra en la cola y la otra no cabe. Las
+  // conexiones siguen abiertas para ocupar el límite.
+  std::vector<server::FileDescriptor> connections;
+  connections.push_back(server::connectUnixSocket(path));
+  connections.push_back(server::connectUnixSocket(path));
+  std::vector<std::string> replies;
+  std::vector<std::thread> waiting;
+  for (server::FileDescriptor const & connection : connections) {
+    waiting.emplace_back([&] {
+      std::string reply = request(connection, "c.ppm d.ppm maxlevel 255");
+      std::scoped_lock const lock(mutex);
+      replies.push_back(reply);
+      changed.notify_all();
+    });
+  }
+  {
+    std::unique_lock lock(mutex);
+    changed.wait(lock, [&] { return !replies.empty(); });
+    EXPECT_EQ(replies.front(), "busy: queue full");
+  }
+
+  server::FileDescriptor const control = server::connectUnixSocket(path);
+  server::FileDescriptor const refused = server::connectUnixSocket(path);
+  server::LineReader refusedReader(refused.get());
+  std::string reply;
+  EXPECT_TRUE(refusedReader.next(reply));
+  EXPECT_EQ(reply, "busy: too many connections");
+  EXPECT_FALSE(refusedReader.next(reply));
+
+  EXPECT_EQ(request(control, "shutdown"), "ok shutting down");
+  {
+    std::scoped_lock const lock(mutex);
+    released = true;
+  }
+  changed.notify_all();
+  running.join();
+  for (auto & thread : waiting) { thread.join(); }
+  serving.join();
+  EXPECT_TRUE(runningReply.starts_with("ok "));
+  ASSERT_EQ(replies.size(), 2U);
+  EXPECT_TRUE(replies.back().starts_with("ok "));
+}
+
+// T4-Al destruir el servidor, SIGINT y SIGTERM recuperan las acciones de antes de handleSignals
+TEST(ServerTest, RestoresSignalActions) {
+  struct sigaction ignore {};
+  ignore.sa_handler = SIG_IGN;
+  sigemptyset(&ignore.sa_mask);
+  struct sigaction original {};
+  ASSERT_EQ(sigaction(SIGTERM, &ignore, &original), 0);
+  {
+    server::JobServer jobServer({.socketPath = socketPath(), .queueDepth = 1, .workers = 1},
+                                [](progargs::ParsedOperationArgs const &) { return true; });
+    jobServer.handleSignals();
+    struct sigaction installed {};
+    sigaction(SIGTERM, nullptr, &installed);
+    EXPECT_NE(installed.sa_handler, SIG_IGN);
+  }
+  struct sigaction restored {};
+  sigaction(SIGTERM, &original, &restored);
+  EXPECT_EQ(restored.sa_handler, SIG_IGN);
+}
+
+// T5-El cliente envía absolutas la entrada y la salida aunque el trabajo empiece por opciones
+TEST(ServerTest, MakesJobPathsAbsolute) {
+  std::string const cwd = std::filesystem::current_path().string() + "/";
+  std::string const job = server::withAbsolutePaths("--memory-limit 8M a.ppm out.ppm maxlevel 100");
+  EXPECT_EQ(job, "--memory-limit 8M " + cwd + "a.ppm " + cwd + "out.ppm maxlevel 100");
+  image::BatchJob const parsed = image::parseJobLine(1, job);
+  EXPECT_TRUE(parsed.error.empty());
+  EXPECT_EQ(parsed.args.inputFilePath, cwd + "a.ppm");
+  EXPECT_EQ(parsed.args.options.memoryLimit, std::size_t{8} << 20);
+
+  EXPECT_EQ(server::withAbsolutePaths("/in/a.ppm --labels out.cppm compress"),
+            "/in/a.ppm --labels " + cwd + "out.cppm compress");
+  EXPECT_EQ(server::withAbsolutePaths("shutdown"), "shutdown");
+}
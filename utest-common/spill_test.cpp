@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <common/spill.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <map>
+#include <vector>
+
+namespace {
+  // Bandas de registros ordenados con colores repetidos entre bandas
+  std::vector<std::vector<image::ColorRecord>> makeBands() {
+    std::vector<std::vector<image::ColorRecord>> bands(9);
+    for (std::size_t band = 0; band < bands.size(); ++band) {
+      for (std::uint64_t color = band % 3; color < 200; color += 1 + (band % 4)) {
+        bands[band].push_back({.color = color * 977, .value = (band * 31) + color + 1});
+      }
+    }
+    return bands;
+  }
+
+  std::vector<image::ColorRecord> mergeAll(std::size_t const memoryBudget,
+                                           image::RecordCombine const combine,
+                                           std::size_t & runCount) {
+    image::SpilledColorRuns runs(memoryBudget, combine);
+    for (auto const & band : makeBands()) { EXPECT_TRUE(runs.add(band)); }
+    std::vector<image::ColorRecord> merged;
+    EXPECT_TRUE(runs.merge([&merged](image::ColorRecord const & record) {
+      merged.push_back(record);
+    }));
+    runCount = runs.runCount();
+    return merged;
+  }
+
+  std::vector<image::ColorRecord> expectedRecords(image::RecordCombine const combine) {
+    std::map<std::uint64_t, std::uint64_t> values;
+    for (auto const & band : makeBands()) {
+      for (auto const & [color, value] : band) {
+        auto const [entry, inserted] = values.try_emplace(color, value);
+        if (inserted) { continue; }
+        entry->second = combine == image::RecordCombine::Sum ? entry->second + value
+                                                             : std::min(entry->second, value);
+      }
+    }
+    std::vector<image::ColorRecord> records;
+    for (auto const & [color, value] : values) {
+      records.push_back({.color = color, .value = value});
+    }
+    return records;
+  }
+}  // namespace
+
+// T1-Con un presupuesto holgado no se escribe ningún run y el resultado es el de un std::map
+TEST(SpillTest, MergesInMemory) {
+  std::size_t runCount = 0;
+  auto const merged    = mergeAll(std::size_t{1} << 20, image::RecordCombine::Sum, runCount);
+  EXPECT_EQ(runCount, 0U);
+  EXPECT_EQ(merged, expectedRecords(image::RecordCombine::Sum));
+}
+
+// T2-Con un presupuesto de pocos registros se vuelcan varios runs y la fusión externa combina los
+// colores repetidos igual, sumando o quedándose con el mínimo
+TEST(SpillTest, MergesSpilledRuns) {
+  for (auto const combine : {image::RecordCombine::Sum, image::RecordCombine::Min}) {
+    std::size_t runCount = 0;
+    auto const merged    = mergeAll(sizeof(image::ColorRecord) * 64, combine, runCount);
+    EXPECT_GT(runCount, 1U);
+    EXPECT_EQ(merged, expectedRecords(combine));
+  }
+}
+
+// T3-La fusión se puede repetir sobre los mismos runs
+TEST(SpillTest, MergeCanBeRepeated) {
+  image::SpilledColorRuns runs(sizeof(image::ColorRecord) * 64, image::RecordCombine::Sum);
+  for (auto const & band : makeBands()) { ASSERT_TRUE(runs.add(band)); }
+  std::size_t first  = 0;
+  std::size_t second = 0;
+  ASSERT_TRUE(runs.merge([&first](image::ColorRecord const &) { ++first; }));
+  ASSERT_TRUE(runs.merge([&second](image::ColorRecord const &) { ++second; }));
+  EXPECT_EQ(first, expectedRecords(image::RecordCombine::Sum).size());
+  EXPECT_EQ(second, first);
+}
+
+// T4-Con más runs de los que se abren a la vez, la fusión pasa por runs intermedios y el
+// resultado no cambia
+TEST(SpillTest, MergesMoreRunsThanFanIn) {
+  constexpr std::size_t budget      = std::size_t{256} << 10;
+  constexpr std::size_t bandRecords = (budget / (2 * sizeof(image::ColorRecord))) + 1;
+  constexpr std::size_t bandCount   = image::MAX_MERGE_RUNS + 6;
+  image::SpilledColorRuns runs(budget, image::RecordCombine::Min);
+  ASSERT_EQ(runs.mergeFanIn(), image::MAX_MERGE_RUNS);
+
+  std::map<std::uint64_t, std::uint64_t> expected;
+  for (std::size_t band = 0; band < bandCount; ++band) {
+    std::vector<image::ColorRecord> records;
+    for (std::uint64_t index = 0; index < bandRecords; ++index) {
+      std::uint64_t const color = (index * 3) + (band % 3);
+      std::uint64_t const value = bandCount - band;
+      records.push_back({.color = color, .value = value});
+      auto const [entry, inserted] = expected.try_emplace(color, value);
+      if (!inserted) { entry->second = std::min(entry->second, value); }
+    }
+    ASSERT_TRUE(runs.add(records));
+  }
+  ASSERT_GT(runs.runCount(), runs.mergeFanIn());
+
+  auto next = expected.begin();
+  bool same = true;
+  ASSERT_TRUE(runs.merge([&](image::ColorRecord const & record) {
+    same = same && next != expected.end() && record.color == next->first &&
+           record.value == next->second;
+    if (next != expected.end()) { ++next; }
+  }));
+  EXPECT_TRUE(same);
+  EXPECT_EQ(next, expected.end());
+  EXPECT_LE(runs.runCount(), runs.mergeFanIn());
+}
@@ -0,0 +1,67 @@
+#include <atomic>
+#include <common/threadpool.hpp>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+  constexpr unsigned POOL_THREADS = 4;
+  constexpr std::size_t RANGE     = 10007;
+}  // namespace
+
+// T1-Cada índice del rango se procesa exactamente una vez
+TEST(ThreadPoolTest, CoversRangeExactlyOnce) {
+  threadpool::ThreadPool pool(POOL_THREADS);
+  std::vector<std::atomic<int>> visits(RANGE);
+
+  pool.parallelFor(0, RANGE, [&visits](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) { ++visits[i]; }
+  });
+
+  for (auto const & count : visits) { EXPECT_EQ(count.load(), 1); }
+}
+
+// T2-Las llamadas anidadas desde una tarea terminan aunque todos los hilos estén ocupados
+TEST(ThreadPoolTest, NestedCallsDoNotDeadlock) {
+  threadpool::ThreadPool pool(2);
+  std::atomic<std::size_t> total{0};
+
+  pool.parallelFor(0, POOL_THREADS * 2, [&](std::size_t first, std::size_t last) {
+    for (std::size_t i = first; i < last; ++i) {
+      pool.parallelFor(0, RANGE, [&total](std::size_t innerFirst, std::size_t innerLast) {
+        total += innerLast - innerFirst;
+      });
+    }
+  });
+
+  EXPECT_EQ(total.load(), POOL_THREADS * 2 * RANGE);
+}
+
+// T3-Una excepción en una tarea se relanza en el hilo llamante
+TEST(ThreadPoolTest, PropagatesExceptions) {
+  threadpool::ThreadPool pool(POOL_THREADS);
+
+  EXPECT_THROW(pool.parallelFor(0, RANGE,
+                                [](std::size_t first, std::size_t last) {
+                                  if (first <= RANGE / 2 && RANGE / 2 < last) {
+                                    throw std::runtime_error("fallo");
+                                  }
+                                }),
+               std::runtime_error);
+}
+
+// T4-parallelForEach procesa cada índice una vez aunque el coste de cada uno sea muy desigual
+TEST(ThreadPoolTest, ForEachCoversEachIndexOnce) {
+  threadpool::ThreadPool pool(POOL_THREADS);
+  std::vector<std::atomic<int>> visits(POOL_THREADS * 8);
+
+  pool.parallelForEach(0, visits.size(), [&](std::size_t index) {
+    ++visits[index];
+    if (index % POOL_THREADS == 0) {
+      pool.parallelFor(0, RANGE, [](std::size_t, std::size_t) { });
+    }
+  });
+
+  for (auto const & count : visits) { EXPECT_EQ(count.load(), 1); }
+}
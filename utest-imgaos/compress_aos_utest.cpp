@@ -0,0 +1,217 @@
+#include <common/colorstream.hpp>
+#include <common/paletteimage.hpp>
+#include <common/threadpool.hpp>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <imgaos/imageaos.hpp>
+#include <iterator>
+#include <string>
+#include <utility>
+
+namespace imageaos {
+  namespace {
+    // Dimensiones impares para que el último bloque no complete un grupo de índices
+    constexpr Dimensions ROUND_TRIP_DIMENSIONS = {.width = 401, .height = 233};
+
+    Image makeImage(unsigned short const maxColorValue, unsigned const levels) {
+      Image image(ROUND_TRIP_DIMENSIONS, maxColorValue);
+      for (unsigned long y_pos = 0; y_pos < ROUND_TRIP_DIMENSIONS.height; ++y_pos) {
+        for (unsigned long x_pos = 0; x_pos < ROUND_TRIP_DIMENSIONS.width; ++x_pos) {
+          std::size_t const seed = (x_pos * 7919) + (y_pos * y_pos * 104729);
+          Pixel pixel;
+          pixel.setRed(static_cast<unsigned short>(seed % levels));
+          pixel.setGreen(static_cast<unsigned short>((seed / levels) % levels));
+          pixel.setBlue(static_cast<unsigned short>((x_pos * y_pos) % levels));
+          image.setPixel(x_pos, y_pos, pixel);
+        }
+      }
+      return image;
+    }
+
+    void expectRoundTrip(Image const & image, image::CompressFormat const format) {
+      auto const path = std::filesystem::temp_directory_path() / "imtool-aos-roundtrip.cppm";
+      ASSERT_TRUE(image.saveToFileCompress(path.string(), format));
+
+      Image loaded;
+      ASSERT_TRUE(loaded.loadFromFileCompress(path.string()));
+      EXPECT_EQ(loaded.getWidth(), image.getWidth());
+      EXPECT_EQ(loaded.getHeight(), image.getHeight());
+      EXPECT_EQ(loaded.getMaxColorValue(), image.getMaxColorValue());
+      EXPECT_EQ(loaded.pixels_, image.pixels_);
+      std::filesystem::remove(path);
+    }
+
+    void expectSameImage(Image const & actual, Image const & expected) {
+      EXPECT_EQ(actual.getMaxColorValue(), expected.getMaxColorValue());
+      EXPECT_EQ(actual.pixels_, expected.pixels_);
+    }
+
+    // Comprime la imagen, aplica `operation` a la tabla de colores del fichero y lo expande
+    template <typename Operation>
+    Image expandPaletteResult(Image const & image, image::CompressFormat const format,
+                              Operation const & operation) {
+      auto const path = std::filesystem::temp_directory_path() / "imtool-aos-palette.cppm";
+      EXPECT_TRUE(image.saveToFileCompress(path.string(), format));
+      image::PaletteImage palette;
+      EXPECT_TRUE(palette.loadFromFile(path.string()));
+      operation(palette);
+      EXPECT_TRUE(palette.saveToFile(path.string()));
+
+      Image result;
+      EXPECT_TRUE(result.loadFromFileCompress(path.string()));
+      std::filesystem::remove(path);
+      return result;
+    }
+    std::string readFile(std::filesystem::path const & path) {
+      std::ifstream in(path, std::ios::binary);
+      return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    // Límites de las pruebas por bandas: con el pequeño las bandas son de pocas filas, los
+    // histogramas se vuelcan a disco y la tabla de índices se escribe por partes
+    constexpr std::size_t SMALL_MEMORY_LIMIT = std::size_t{512} << 10;
+    constexpr std::size_t LARGE_MEMORY_LIMIT = std::size_t{64} << 20;
+
+    // Valor máximo y niveles por canal de makeImage
+    using ColorLevels = std::pair<unsigned short, unsigned>;
+  }  // namespace
+
+  // T1-compress seguido de decompress devuelve la misma imagen con los dos formatos
+  TEST(CompressAOSTest, RoundTripBothFormats) {
+    for (auto const format :
+         {image::CompressFormat::ByteAligned, image::CompressFormat::BitPacked}) {
+      expectRoundTrip(makeImage(255, 7), format);      // índices de 1 byte
+      expectRoundTrip(makeImage(255, 40), format);     // índices de 2 bytes
+      expectRoundTrip(makeImage(65535, 997), format);  // índices de 4 bytes y muestras de 16 bits
+      expectRoundTrip(makeImage(255, 1), format);      // un solo color: 0 bits por índice
+    }
+  }
+
+  // T2-La expansión no depende del número de hilos
+  TEST(CompressAOSTest, RoundTripIndependentOfThreadCount) {
+    threadpool::setThreadCount(3);
+    expectRoundTrip(makeImage(255, 40), image::CompressFormat::BitPacked);
+    threadpool::setThreadCount(0);
+  }
+
+  // T3-Un índice fuera de la tabla de colores se rechaza
+  TEST(CompressAOSTest, RejectsIndexOutOfRange) {
+    auto const path = std::filesystem::temp_directory_path() / "imtool-aos-bad-index.cppm";
+    {
+      std::ofstream out(path, std::ios::binary);
+      // Tres colores (2 bits por índice) y dos píxeles con los índices 0 y 3
+      out << "C6v2 2 1 255 3\n" << std::string(9, '\0') << '\x0C';
+    }
+    Image loaded;
+    EXPECT_FALSE(loaded.loadFromFileCompress(path.string()));
+    std::filesystem::remove(path);
+  }
+
+  // T4-maxlevel sobre la tabla de colores se expande a la misma imagen que maxlevel sobre los
+  // píxeles
+  TEST(CompressAOSTest, PaletteMaxLevelMatchesPixels) {
+    for (auto const format :
+         {image::CompressFormat::ByteAligned, image::CompressFormat::BitPacked}) {
+      for (auto const newMaxColorValue : {100, 1000, 1}) {
+        Image expected = makeImage(65535, 997);
+        auto const level = static_cast<unsigned short>(newMaxColorValue);
+        Image const result =
+            expandPaletteResult(expected, format, [level](image::PaletteImage & palette) {
+              palette.modifyMaxLevel(level);
+            });
+        expected.modifyMaxLevel(level);
+        expectSameImage(result, expected);
+      }
+    }
+  }
+
+  // T5-cutfreq sobre la tabla de colores se expande a la misma imagen que cutfreq sobre los
+  // píxeles, también cuando maxlevel ha dejado colores repetidos en la tabla
+  TEST(CompressAOSTest, PaletteCutfreqMatchesPixels) {
+    for (auto const format :
+         {image::CompressFormat::ByteAligned, image::CompressFormat::BitPacked}) {
+      for (std::uint32_t const n : {0U, 150U, 1200U}) {
+        Image expected = makeImage(255, 40);
+        Image const result =
+            expandPaletteResult(expected, format, [n](image::PaletteImage & palette) {
+              EXPECT_TRUE(palette.cutfreq(n));
+            });
+        expected.cutfreq(n);
+        expectSameImage(result, expected);
+      }
+
+      Image expected = makeImage(255, 40);
+      Image const result =
+          expandPaletteResult(expected, format, [](image::PaletteImage & palette) {
+            palette.modifyMaxLevel(20);
+            EXPECT_TRUE(palette.cutfreq(100));
+          });
+      expected.modifyMaxLevel(20);
+      expected.cutfreq(100);
+      expectSameImage(result, expected);
+    }
+  }
+
+  // T6-compress por bandas escribe el mismo fichero que compress en memoria, con los dos formatos
+  TEST(CompressAOSTest, StreamCompressMatchesInMemory) {
+    auto const input    = std::filesystem::temp_directory_path() / "imtool-aos-stream-in.ppm";
+    auto const expected = std::filesystem::temp_directory_path() / "imtool-aos-stream.cppm";
+    auto const streamed = std::filesystem::temp_directory_path() / "imtool-aos-streamed.cppm";
+    for (auto const format :
+         {image::CompressFormat::ByteAligned, image::CompressFormat::BitPacked}) {
+      for (auto const & [maxColorValue, levels] : {ColorLevels{255, 7}, ColorLevels{255, 40},
+                                                   ColorLevels{65535, 997}, ColorLevels{255, 1}}) {
+        Image const image = makeImage(maxColorValue, levels);
+        ASSERT_TRUE(image.saveToFile(input.string()));
+        ASSERT_TRUE(image.saveToFileCompress(expected.string(), format));
+        for (std::size_t const memoryLimit : {SMALL_MEMORY_LIMIT, LARGE_MEMORY_LIMIT}) {
+          ASSERT_TRUE(image::streamCompress(input.string(), streamed.string(), format,
+                                            memoryLimit));
+          EXPECT_EQ(readFile(streamed), readFile(expected));
+        }
+      }
+    }
+    std::filesystem::remove(input);
+    std::filesystem::remove(expected);
+    std::filesystem::remove(streamed);
+  }
+
+  // T7-cutfreq por bandas escribe el mismo fichero que cutfreq en memoria, también cuando los
+  // colores conservados se recorren por bloques
+  TEST(CompressAOSTest, StreamCutfreqMatchesInMemory) {
+    auto const input    = std::filesystem::temp_directory_path() / "imtool-aos-cut-in.ppm";
+    auto const expected = std::filesystem::temp_directory_path() / "imtool-aos-cut.ppm";
+    auto const streamed = std::filesystem::temp_directory_path() / "imtool-aos-cut-out.ppm";
+    for (auto const & [maxColorValue, levels] : {ColorLevels{255, 40}, ColorLevels{65535, 997}}) {
+      for (std::uint32_t const n : {0U, 150U, 1200U}) {
+        Image image = makeImage(maxColorValue, levels);
+        ASSERT_TRUE(image.saveToFile(input.string()));
+        image.cutfreq(n);
+        ASSERT_TRUE(image.saveToFile(expected.string()));
+        for (std::size_t const memoryLimit : {SMALL_MEMORY_LIMIT, LARGE_MEMORY_LIMIT}) {
+          ASSERT_TRUE(image::streamCutFreq(input.string(), streamed.string(), n, memoryLimit));
+          EXPECT_EQ(readFile(streamed), readFile(expected));
+        }
+      }
+    }
+    EXPECT_FALSE(image::streamCutFreq(input.string(), streamed.string(), 1200, 1000));
+    std::filesystem::remove(input);
+    std::filesystem::remove(expected);
+    std::filesystem::remove(streamed);
+  }
+
+  // T8-Unas dimensiones cuyo número de píxeles no cabe en 64 bits se rechazan aunque, al dar la
+  // vuelta el producto, el fichero parezca tener el tamaño justo
+  TEST(CompressAOSTest, RejectsOverflowingDimensions) {
+    auto const path = std::filesystem::temp_directory_path() / "imtool-aos-overflow.cppm";
+    {
+      std::ofstream out(path, std::ios::binary);
+      // (2^62 + 1) x 4 píxeles son 4 tras dar la vuelta: 300 colores y 4 índices de 2 bytes
+      out << "C6 4611686018427387905 4 255 300\n" << std::string((300 * 3) + (4 * 2), '\0');
+    }
+    Image loaded;
+    EXPECT_FALSE(loaded.loadFromFileCompress(path.string()));
+    std::filesystem::remove(path);
+  }
+}  // namespace imageaos
@@ -1,6 +1,9 @@
+#include <cmath>
+#include <common/leveltable.hpp>
+#include <common/threadpool.hpp>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <imgaos/imageaos.hpp>
-#include <cmath>
 
 namespace imageaos {
 
@@ -105,4 +108,65 @@ namespace imageaos {
     ImageTest::checkPixelValues(getImage(), ImageDimensions{.width = INITIAL_SIZE, .height = TARGET_HEIGHT});
   }
 
+  // El resultado del redimensionado paralelo es idéntico al secuencial
+  TEST_F(ImageTest, ResizeIsIndependentOfThreadCount) {
+    constexpr unsigned parallelThreads = 4;
+    Image serial                       = getImage();
+
+    threadpool::setThreadCount(1);
+    serial.resize(MEDIUM_DIMENSIONS.width, TARGET_HEIGHT);
+    threadpool::setThreadCount(parallelThreads);
+    getImage().resize(MEDIUM_DIMENSIONS.width, TARGET_HEIGHT);
+    threadpool::setThreadCount(0);
+
+    EXPECT_EQ(getImage().pixels_, serial.pixels_);
+  }
+
+  // resize por bandas de filas escribe los mismos píxeles que resize en memoria, tanto con bandas
+  // de una fila de destino como con la imagen en una sola banda
+  TEST_F(ImageTest, StreamResizeMatchesInMemoryResize) {
+    constexpr std::size_t oneRowLimit = std::size_t{16} << 10;
+    constexpr std::size_t largeLimit  = std::size_t{1} << 20;
+    getImage().setMaxColorValue(Image::DEFAULT_MAX_COLOR_VALUE);
+    auto const input  = std::filesystem::temp_directory_path() / "imtool-aos-stream-in.ppm";
+    auto const output = std::filesystem::temp_directory_path() / "imtool-aos-stream-out.ppm";
+    ASSERT_TRUE(getImage().saveToFile(input.string()));
+
+    constexpr ImageDimensions specific{.width = INITIAL_SIZE, .height = TARGET_HEIGHT};
+    for (ImageDimensions const target : {SMALL_DIMENSIONS, LARGE_DIMENSIONS, specific}) {
+      for (std::size_t const memoryLimit : {oneRowLimit, largeLimit}) {
+        ASSERT_TRUE(resizeStream(input.string(), output.string(), target.width, target.height,
+                                 memoryLimit));
+        Image expected = getImage();
+        expected.resize(target.width, target.height);
+        Image streamed;
+        ASSERT_TRUE(streamed.loadFromFile(output.string()));
+        EXPECT_EQ(streamed.pixels_, expected.pixels_);
+      }
+    }
+    EXPECT_FALSE(resizeStream(input.string(), output.string(), LARGE_DIMENSIONS.width,
+                              LARGE_DIMENSIONS.height, 1000));
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+  }
+
+  // resize con maxlevel fundido en su bucle de salida da los mismos píxeles que resize seguido de
+  // dos maxlevel
+  TEST_F(ImageTest, FusedResizeMatchesResizeThenMaxLevel) {
+    constexpr unsigned short firstLevel  = 1000;
+    constexpr unsigned short secondLevel = 100;
+    getImage().setMaxColorValue(Image::DEFAULT_MAX_COLOR_VALUE);
+    Image expected = getImage();
+    expected.resize(MEDIUM_DIMENSIONS.width, TARGET_HEIGHT);
+    expected.modifyMaxLevel(firstLevel);
+    expected.modifyMaxLevel(secondLevel);
+
+    image::LevelTable const levels(
+        image::LevelTable(Image::DEFAULT_MAX_COLOR_VALUE, firstLevel),
+        image::LevelTable(firstLevel, secondLevel));
+    getImage().resize(MEDIUM_DIMENSIONS.width, TARGET_HEIGHT, levels, secondLevel);
+
+    EXPECT_EQ(getImage().getMaxColorValue(), secondLevel);
+    EXPECT_EQ(getImage().pixels_, expected.pixels_);
+  }
 }  // namespace imageaos
@@ -1,6 +1,9 @@
+#include <cmath>
+#include <common/leveltable.hpp>
+#include <common/threadpool.hpp>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <imgsoa/imagesoa.hpp>
-#include <cmath>
 
 namespace imagesoa {
 
@@ -91,4 +94,108 @@ namespace imagesoa {
     VerifyAllPixels(SPECIFIC_DIMENSIONS);
   }
 
-}  // namespace imagesoa
\ No newline at end of file
+  // El resultado del redimensionado paralelo es idéntico al secuencial
+  TEST_F(ImageSOATest, ResizeIsIndependentOfThreadCount) {
+    constexpr unsigned parallelThreads = 4;
+    image.setMaxColorValue(image::MAX_COLOR_VALUE_8BIT);
+    TestableImage serial = image;
+
+    threadpool::setThreadCount(1);
+    serial.resize(LARGE_DIMENSIONS.width, SPECIFIC_DIMENSIONS.height);
+    threadpool::setThreadCount(parallelThreads);
+    image.resize(LARGE_DIMENSIONS.width, SPECIFIC_DIMENSIONS.height);
+    threadpool::setThreadCount(0);
+
+    EXPECT_EQ(image.red_, serial.red_);
+    EXPECT_EQ(image.green_, serial.green_);
+    EXPECT_EQ(image.blue_, serial.blue_);
+  }
+
+  // El kernel vectorial (bloques de 16 píxeles y cola escalar) coincide con el cálculo píxel a
+  // píxel, incluida la última fila y columna de origen
+  TEST_F(ImageSOATest, VectorizedResizeMatchesPerPixelColor) {
+    constexpr Dimensions source{.width = 37, .height = 23};
+    constexpr Dimensions target{.width = 101, .height = 19};
+    TestableImage original(source);
+    original.setMaxColorValue(image::MAX_COLOR_VALUE_16BIT);
+    for (unsigned long y_pos = 0; y_pos < source.height; ++y_pos) {
+      for (unsigned long x_pos = 0; x_pos < source.width; ++x_pos) {
+        auto const seed = static_cast<unsigned>((y_pos * source.width) + x_pos);
+        original.setRed(x_pos, y_pos, static_cast<uint16_t>(seed * 7919U));
+        original.setGreen(x_pos, y_pos, static_cast<uint16_t>(seed * 104729U));
+        original.setBlue(x_pos, y_pos, static_cast<uint16_t>(seed * 1299709U));
+      }
+    }
+
+    TestableImage resized = original;
+    resized.resize(target.width, target.height);
+
+    double const x_ratio = static_cast<double>(source.width - 1) / (target.width - 1);
+    double const y_ratio = static_cast<double>(source.height - 1) / (target.height - 1);
+    for (std::uint32_t y_prime = 0; y_prime < target.height; ++y_prime) {
+      for (std::uint32_t x_prime = 0; x_prime < target.width; ++x_prime) {
+        double const x_real = x_prime * x_ratio;
+        double const y_real = y_prime * y_ratio;
+        InterpolationCoords const coords{.x_l      = static_cast<std::uint32_t>(std::floor(x_real)),
+                                         .y_l      = static_cast<std::uint32_t>(std::floor(y_real)),
+                                         .x_h      = static_cast<std::uint32_t>(std::ceil(x_real)),
+                                         .y_h      = static_cast<std::uint32_t>(std::ceil(y_real)),
+                                         .x_weight = x_real - std::floor(x_real),
+                                         .y_weight = y_real - std::floor(y_real)};
+        ASSERT_EQ(resized.getRed(x_prime, y_prime), original.calculatePixelColor(coords, 'r'));
+        ASSERT_EQ(resized.getGreen(x_prime, y_prime), original.calculatePixelColor(coords, 'g'));
+        ASSERT_EQ(resized.getBlue(x_prime, y_prime), original.calculatePixelColor(coords, 'b'));
+      }
+    }
+  }
+
+  // resize por bandas de filas escribe los mismos píxeles que resize en memoria, tanto con bandas
+  // de una fila de destino como con la imagen en una sola banda
+  TEST_F(ImageSOATest, StreamResizeMatchesInMemoryResize) {
+    constexpr std::size_t oneRowLimit = std::size_t{16} << 10;
+    constexpr std::size_t largeLimit  = std::size_t{1} << 20;
+    image.setMaxColorValue(image::MAX_COLOR_VALUE_8BIT);
+    auto const input  = std::filesystem::temp_directory_path() / "imtool-soa-stream-in.ppm";
+    auto const output = std::filesystem::temp_directory_path() / "imtool-soa-stream-out.ppm";
+    ASSERT_TRUE(image.saveToFile(input.string()));
+
+    for (Dimensions const target : {SMALL_DIMENSIONS, LARGE_DIMENSIONS, SPECIFIC_DIMENSIONS}) {
+      for (std::size_t const memoryLimit : {oneRowLimit, largeLimit}) {
+        ASSERT_TRUE(resizeStream(input.string(), output.string(), target.width, target.height,
+                                 memoryLimit));
+        TestableImage expected = image;
+        expected.resize(target.width, target.height);
+        Image streamed;
+        ASSERT_TRUE(streamed.loadFromFile(output.string()));
+        EXPECT_EQ(streamed.red_, expected.red_);
+        EXPECT_EQ(streamed.green_, expected.green_);
+        EXPECT_EQ(streamed.blue_, expected.blue_);
+      }
+    }
+    EXPECT_FALSE(resizeStream(input.string(), output.string(), LARGE_DIMENSIONS.width,
+                              LARGE_DIMENSIONS.height, 1000));
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+  }
+
+  // resize con maxlevel fundido en su bucle de salida da los mismos planos que resize seguido de
+  // dos maxlevel
+  TEST_F(ImageSOATest, FusedResizeMatchesResizeThenMaxLevel) {
+    constexpr unsigned short firstLevel  = 1000;
+    constexpr unsigned short secondLevel = 100;
+    image.setMaxColorValue(image::MAX_COLOR_VALUE_8BIT);
+    TestableImage expected = image;
+    expected.resize(LARGE_DIMENSIONS.width, SPECIFIC_DIMENSIONS.height);
+    expected.modifyMaxLevel(firstLevel);
+    expected.modifyMaxLevel(secondLevel);
+
+    image::LevelTable const levels(image::LevelTable(image::MAX_COLOR_VALUE_8BIT, firstLevel),
+                                   image::LevelTable(firstLevel, secondLevel));
+    image.resize(LARGE_DIMENSIONS.width, SPECIFIC_DIMENSIONS.height, levels, secondLevel);
+
+    EXPECT_EQ(image.getMaxColorValue(), secondLevel);
+    EXPECT_EQ(image.red_, expected.red_);
+    EXPECT_EQ(image.green_, expected.green_);
+    EXPECT_EQ(image.blue_, expected.blue_);
+  }
+}  // namespace imagesoa